@@ -0,0 +1,41 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HEADER_BENCHMARKS
+#define HEADER_BENCHMARKS
+
+namespace Benchmarks{
+	void run_benchmarks(int N);
+
+	void benchmark_solver_policies(int N);
+	void benchmark_regime_dispatch(int N);
+	void benchmark_state_catalog(int N);
+	void benchmark_eclipse(int N);
+	void benchmark_conversion_service(int N);
+	void benchmark_snapshot_codec(int N);
+	void benchmark_incremental_catalog(int N);
+	void benchmark_arc_bounds(int N);
+	void benchmark_masked_conversions(int N);
+
+}
+
+#endif
\ No newline at end of file
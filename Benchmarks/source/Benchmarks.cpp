@@ -0,0 +1,645 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Benchmarks.hpp"
+#include <RigidBodyKinematics.hpp>
+#include <OrbitConversions.hpp>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace Benchmarks{
+
+	void run_benchmarks(int N){
+
+		Benchmarks::benchmark_solver_policies(N);
+		Benchmarks::benchmark_regime_dispatch(N);
+		Benchmarks::benchmark_state_catalog(10 * N);
+		Benchmarks::benchmark_eclipse(N / 100);
+		Benchmarks::benchmark_conversion_service(N / 20);
+		Benchmarks::benchmark_snapshot_codec(N / 10);
+		Benchmarks::benchmark_incremental_catalog(N);
+		Benchmarks::benchmark_arc_bounds(N / 100);
+		Benchmarks::benchmark_masked_conversions(N);
+
+	}
+
+	/**
+	Returns the wall-clock time elapsed since start
+	@param start time point
+	@return elapsed time (s)
+	*/
+	double elapsed(const std::chrono::high_resolution_clock::time_point & start){
+		return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	}
+
+	void benchmark_solver_policies(int N){
+
+		std::cout << "\n- Running benchmark_solver_policies... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		// Eccentricities stratified over [0,0.99] and (1,6], anomalies drawn uniformly.
+		// The mean anomalies are generated from known anomalies, which serve as the reference
+		arma::vec ecc_samples = - arma::datum::pi + 2 * arma::datum::pi * arma::randu<arma::vec>(N);
+		arma::vec H_samples = - 5 + 10 * arma::randu<arma::vec>(N);
+		arma::vec e_elliptic(N),e_hyperbolic(N),M_elliptic(N),M_hyperbolic(N);
+
+		for (int i = 0; i < N; ++i){
+			e_elliptic(i) = 0.99 * (i % 100 + 0.5) / 100.;
+			e_hyperbolic(i) = 1.01 + 5 * (i % 100 + 0.5) / 100.;
+			M_elliptic(i) = OC::State::M_from_ecc(ecc_samples(i),e_elliptic(i));
+			M_hyperbolic(i) = OC::State::M_from_H(H_samples(i),e_hyperbolic(i));
+		}
+
+		arma::mat kep_states(6,N);
+		kep_states.row(0) = 1 + arma::randu<arma::mat>(1,N);
+		kep_states.row(1) = e_elliptic.t();
+		kep_states.rows(2,5) = 2 * arma::datum::pi * arma::randu<arma::mat>(4,N);
+
+		std::vector<std::string> names = {"fast","default","precise"};
+		std::vector<OC::SolverPolicy> policies = {OC::SolverPolicy::fast_policy(),
+			OC::SolverPolicy::default_policy(),
+			OC::SolverPolicy::precise_policy()};
+
+		for (unsigned int p = 0; p < policies.size(); ++p){
+
+			double max_error_ecc = 0;
+			double max_error_H = 0;
+			double checksum = 0;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < N; ++i){
+				double ecc = OC::State::ecc_from_M(M_elliptic(i),e_elliptic(i),policies[p]);
+				max_error_ecc = std::max(max_error_ecc,std::abs(ecc - ecc_samples(i)));
+				checksum += ecc;
+			}
+			double time_ecc = elapsed(start);
+
+			start = std::chrono::high_resolution_clock::now();
+			for (int i = 0; i < N; ++i){
+				double H = OC::State::H_from_M(M_hyperbolic(i),e_hyperbolic(i),policies[p]);
+				max_error_H = std::max(max_error_H,std::abs(H - H_samples(i)) / (1 + std::abs(H_samples(i))));
+				checksum += H;
+			}
+			double time_H = elapsed(start);
+
+			arma::mat cart_states;
+			start = std::chrono::high_resolution_clock::now();
+			OC::BatchConversions::kep_to_cart(kep_states,1,0.5,cart_states,policies[p]);
+			double time_batch = elapsed(start);
+
+			std::cout << " " << names[p] << " policy:\n";
+			std::cout << "\tecc_from_M: " << 1e9 * time_ecc / N << " ns/solve, max error: " << max_error_ecc << " rad\n";
+			std::cout << "\tH_from_M: " << 1e9 * time_H / N << " ns/solve, max relative error: " << max_error_H << "\n";
+			std::cout << "\tBatchConversions::kep_to_cart: " << N / time_batch << " states/s\n";
+			std::cout << "\t(checksum " << checksum + arma::accu(cart_states) << ")\n";
+
+		}
+
+		std::cout << "- benchmark_solver_policies() done\n";
+
+	}
+
+	void benchmark_regime_dispatch(int N){
+
+		std::cout << "\n- Running benchmark_regime_dispatch... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		// Shuffled mixture of elliptic (80%), near-parabolic (10%) and hyperbolic (10%) orbits
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(7);
+			double e;
+			if (rands(1) < 0.8){
+				e = 0.95 * rands(0);
+			}
+			else if (rands(1) < 0.9){
+				e = 1 + 0.018 * (rands(0) - 0.5);
+			}
+			else{
+				e = 1.02 + 2 * rands(0);
+			}
+			kep_states(0,i) = (1 + rands(2)) / (1 - e);
+			kep_states(1,i) = e;
+			kep_states.submat(2,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,6);
+		}
+
+		arma::mat cart_states,kep_states_back;
+
+		// Unpartitioned reference: one prepared state per column, branching on the regime
+		auto start = std::chrono::high_resolution_clock::now();
+		cart_states.set_size(6,N);
+		#pragma omp parallel for
+		for (int i = 0; i < N; ++i){
+			OC::PreparedKepState prepared_kep(kep_states.colptr(i),1);
+			prepared_kep.get_position_velocity(0.5,cart_states.colptr(i),cart_states.colptr(i) + 3);
+		}
+		double time_reference = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		std::vector<std::vector<unsigned int> > partitions;
+		OC::BatchConversions::partition_by_regime(kep_states,1,partitions);
+		double time_partition = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		OC::BatchConversions::kep_to_cart(kep_states,1,0.5,cart_states);
+		double time_kep_to_cart = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		OC::BatchConversions::cart_to_kep(cart_states,1,0.5,kep_states_back);
+		double time_cart_to_kep = elapsed(start);
+
+		std::cout << " " << partitions[OC::ELLIPTIC].size() << " elliptic, " 
+		<< partitions[OC::NEAR_PARABOLIC].size() << " near-parabolic, " 
+		<< partitions[OC::HYPERBOLIC].size() << " hyperbolic\n";
+		std::cout << "\tunpartitioned kep_to_cart: " << N / time_reference << " states/s\n";
+		std::cout << "\tBatchConversions::kep_to_cart: " << N / time_kep_to_cart << " states/s\n";
+		std::cout << "\tBatchConversions::cart_to_kep: " << N / time_cart_to_kep << " states/s\n";
+		std::cout << "\tpartitioning: " << 1e9 * time_partition / N << " ns/state (" 
+		<< 100 * time_partition / time_kep_to_cart << "% of kep_to_cart, " 
+		<< 100 * time_partition / time_cart_to_kep << "% of cart_to_kep)\n";
+		std::cout << "\t(checksum " << arma::accu(kep_states_back) << ")\n";
+
+		std::cout << "- benchmark_regime_dispatch() done\n";
+
+	}
+
+	void benchmark_state_catalog(int N){
+
+		std::cout << "\n- Running benchmark_state_catalog... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		arma::mat kep_states = arma::randu<arma::mat>(6,N);
+		kep_states.row(0) += 1;
+		double bytes = 6 * sizeof(double) * double(N);
+
+		// Reference: the per-object states a catalog replaces, on a subset (each owns a heap-allocated vector)
+		int N_reference = std::min(N,1000000);
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<OC::KepState> kep_vector(N_reference);
+		for (int i = 0; i < N_reference; ++i){
+			kep_vector[i] = OC::KepState(kep_states.col(i),1);
+		}
+		double time_vector_load = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		double energy_vector = 0;
+		for (int i = 0; i < N_reference; ++i){
+			energy_vector += kep_vector[i].get_energy();
+		}
+		double time_vector_iterate = elapsed(start);
+
+		std::cout << " " << N << " objects (" << bytes / 1e9 << " GB)\n";
+		std::cout << "\tstd::vector<KepState>: load " << N_reference / time_vector_load << " states/s, iterate " 
+		<< N_reference / time_vector_iterate << " states/s\n";
+
+		OC::CatalogLayout layouts[2] = {OC::AOS,OC::SOA};
+		std::string names[2] = {"AOS","SOA"};
+
+		for (unsigned int l = 0; l < 2; ++l){
+
+			start = std::chrono::high_resolution_clock::now();
+			OC::KepCatalog catalog(kep_states,1,layouts[l]);
+			double time_load = elapsed(start);
+
+			// Derived quantity through the handles: reads a only
+			start = std::chrono::high_resolution_clock::now();
+			double energy = 0;
+			#pragma omp parallel for reduction(+:energy)
+			for (int i = 0; i < N; ++i){
+				energy += catalog[i].get_energy();
+			}
+			double time_energy = elapsed(start);
+
+			// Full sweep: reads every component
+			start = std::chrono::high_resolution_clock::now();
+			double sum = 0;
+			#pragma omp parallel for reduction(+:sum)
+			for (int i = 0; i < N; ++i){
+				OC::KepStateHandle handle = catalog[i];
+				sum += handle.get_a() + handle.get_eccentricity() + handle.get_inclination() 
+				+ handle.get_Omega() + handle.get_omega() + handle.get_M0();
+			}
+			double time_sweep = elapsed(start);
+
+			std::cout << "\t" << names[l] << " catalog: load " << N / time_load << " states/s (" 
+			<< 2 * bytes / time_load / 1e9 << " GB/s), energy " << N / time_energy << " states/s, sweep " 
+			<< N / time_sweep << " states/s (" << bytes / time_sweep / 1e9 << " GB/s)\n";
+			std::cout << "\t(checksum " << energy + sum + energy_vector << ")\n";
+
+		}
+
+		std::cout << "- benchmark_state_catalog() done\n";
+
+	}
+
+	void benchmark_eclipse(int N){
+
+		std::cout << "\n- Running benchmark_eclipse... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		// Low orbits around a unit-radius body over a 15-revolution window
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			kep_states(0,i) = 1.05 + 0.3 * rands(0);
+			kep_states(1,i) = 0.02 * rands(1);
+			kep_states(2,i) = arma::datum::pi * rands(2);
+			kep_states.submat(3,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,5);
+		}
+		OC::KepCatalog catalog(kep_states,1);
+
+		double t1 = 15 * 2 * arma::datum::pi * std::pow(1.2,1.5);
+
+		OC::ShadowGeometry geometry;
+		geometry.model = OC::CONICAL;
+		geometry.sun_direction = {0.6,0.8,0};
+		geometry.body_radius = 1;
+		geometry.sun_radius = 109;
+		geometry.sun_distance = 23500;
+
+		// Reference: dense sampling of the positions, 360 samples per revolution
+		auto start = std::chrono::high_resolution_clock::now();
+		unsigned long long transitions = 0;
+		#pragma omp parallel for reduction(+:transitions)
+		for (int i = 0; i < N; ++i){
+			OC::PreparedKepState prepared_kep(kep_states.colptr(i),1);
+			double step = prepared_kep.get_time_scale() / 360;
+			OC::ShadowType previous = OC::SUNLIT;
+			for (double t = 0; t <= t1; t += step){
+				double pos[3];
+				prepared_kep.get_position(t,pos);
+				OC::ShadowType shadow = OC::Eclipse::get_shadow(pos,geometry);
+				transitions += (shadow != previous);
+				previous = shadow;
+			}
+		}
+		double time_sampling = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		std::vector<OC::EclipseInterval> eclipses = OC::Eclipse::find_eclipses(catalog,geometry,0,t1);
+		double time_eclipse = elapsed(start);
+
+		std::cout << " " << N << " objects, " << eclipses.size() << " shadow intervals (" 
+		<< transitions << " transitions seen by sampling)\n";
+		std::cout << "\tdense sampling (1 deg): " << N / time_sampling << " objects/s\n";
+		std::cout << "\tEclipse::find_eclipses: " << N / time_eclipse << " objects/s (" 
+		<< time_sampling / time_eclipse << "x)\n";
+
+		std::cout << "- benchmark_eclipse() done\n";
+
+	}
+
+	void benchmark_conversion_service(int N){
+
+		std::cout << "\n- Running benchmark_conversion_service... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		// Stream of N cart_to_kep requests of 1 to 4 states
+		std::vector<arma::mat> inputs(N);
+		unsigned int n_states = 0;
+		for (int i = 0; i < N; ++i){
+			inputs[i] = arma::randn<arma::mat>(6,1 + i % 4);
+			n_states += inputs[i].n_cols;
+		}
+
+		// Reference: one request at a time through CartState
+		auto start = std::chrono::high_resolution_clock::now();
+		double checksum = 0;
+		for (int i = 0; i < N; ++i){
+			for (unsigned int k = 0; k < inputs[i].n_cols; ++k){
+				checksum += OC::CartState(inputs[i].col(k),1).convert_to_kep(0).get_a();
+			}
+		}
+		double time_reference = elapsed(start);
+		std::cout << " " << N << " requests, " << n_states << " states\n";
+		std::cout << "\tCartState::convert_to_kep one request at a time: " << n_states / time_reference << " states/s\n";
+
+		// Open-loop load generator: the producers submit at a fixed aggregate rate
+		// and the latency of each request is recorded by its callback. Latencies are measured 
+		// from the scheduled submission time, so that producers falling behind the offered 
+		// rate are accounted for (no coordinated omission)
+		unsigned int n_producers = 4;
+		std::vector<double> budgets = {0,50e-6,500e-6};
+		std::vector<double> rates = {1e4,1e5,1e6};
+
+		for (double budget : budgets){
+			for (double rate : rates){
+
+				OC::ServiceSettings settings;
+				settings.latency_budget = budget;
+
+				std::vector<double> latencies(N);
+				std::vector<std::chrono::steady_clock::time_point> scheduled(N);
+
+				OC::ConversionService service(settings);
+				auto t_start = std::chrono::steady_clock::now() + std::chrono::milliseconds(1);
+
+				std::vector<std::thread> producers;
+				for (unsigned int p = 0; p < n_producers; ++p){
+					producers.push_back(std::thread([&,p](){
+						for (int i = p; i < N; i += n_producers){
+							scheduled[i] = t_start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(i / rate));
+							std::this_thread::sleep_until(scheduled[i]);
+							service.submit(OC::ConversionService::CART_TO_KEP,inputs[i],1,0,[&latencies,&scheduled,i](const arma::mat &){
+								latencies[i] = std::chrono::duration<double>(std::chrono::steady_clock::now() - scheduled[i]).count();
+							});
+						}
+					}));
+				}
+				for (auto & producer : producers){
+					producer.join();
+				}
+				service.stop();
+				double duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+
+				std::sort(latencies.begin(),latencies.end());
+				std::cout << "\tbudget " << 1e6 * budget << " us, offered " << rate << " req/s: achieved " 
+				<< N / duration << " req/s (" << n_states / duration << " states/s), " 
+				<< double(service.get_requests()) / service.get_batches() << " req/batch, p50 " 
+				<< 1e6 * latencies[N / 2] << " us, p99 " << 1e6 * latencies[(99 * N) / 100] << " us\n";
+
+			}
+		}
+
+		std::cout << "\t(checksum " << checksum << ")\n";
+
+		std::cout << "- benchmark_conversion_service() done\n";
+
+	}
+
+	void benchmark_snapshot_codec(int N){
+
+		std::cout << "\n- Running benchmark_snapshot_codec... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		unsigned int snapshots = 16;
+		double dt = 0.05;
+
+		// Low orbits slowly decaying, so that Kepler predictions leave a small residual
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			kep_states(0,i) = 1.05 + rands(0);
+			kep_states(1,i) = 0.1 * rands(1);
+			kep_states(2,i) = arma::datum::pi * rands(2);
+			kep_states.submat(3,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,5);
+		}
+
+		std::vector<arma::mat> cart_snapshots(snapshots);
+		for (unsigned int s = 0; s < snapshots; ++s){
+			arma::mat decayed = kep_states;
+			decayed.row(0) -= 1e-5 * s * dt;
+			OC::BatchConversions::kep_to_cart(decayed,1,s * dt,cart_snapshots[s]);
+		}
+
+		double raw_bytes = 6 * sizeof(double) * double(N) * snapshots;
+		std::cout << " " << N << " objects, " << snapshots << " snapshots (" << raw_bytes / 1e9 << " GB raw), quantum 1e-6\n";
+
+		OC::SnapshotPrediction predictions[3] = {OC::INTRA_PREDICTION,OC::PREVIOUS_PREDICTION,OC::KEPLER_PREDICTION};
+		std::string names[3] = {"intra","previous","Kepler"};
+		double checksum = 0;
+
+		for (unsigned int p = 0; p < 3; ++p){
+
+			OC::SnapshotSettings settings;
+			settings.prediction = predictions[p];
+
+			OC::SnapshotEncoder encoder(1,settings);
+			std::vector<unsigned char> bytes;
+
+			auto start = std::chrono::high_resolution_clock::now();
+			for (unsigned int s = 0; s < snapshots; ++s){
+				encoder.encode(cart_snapshots[s],s * dt,bytes);
+			}
+			double time_encode = elapsed(start);
+
+			OC::SnapshotDecoder decoder;
+			start = std::chrono::high_resolution_clock::now();
+			size_t offset = 0;
+			for (unsigned int s = 0; s < snapshots; ++s){
+				offset += decoder.decode(bytes.data() + offset,bytes.size() - offset);
+				checksum += decoder.get_states()(0,0);
+			}
+			double time_decode = elapsed(start);
+
+			std::cout << "\t" << names[p] << ": " << double(bytes.size()) / (double(N) * snapshots) << " bytes/state (ratio " 
+			<< raw_bytes / bytes.size() << "), encode " << N * snapshots / time_encode << " states/s, decode " 
+			<< N * snapshots / time_decode << " states/s (" << raw_bytes / time_decode / 1e9 << " GB/s)\n";
+
+		}
+
+		// Reference: streaming the raw snapshots through memory
+		arma::mat copy;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (unsigned int s = 0; s < snapshots; ++s){
+			copy = cart_snapshots[s];
+			checksum += copy(0,0);
+		}
+		double time_copy = elapsed(start);
+		std::cout << "\traw copy: " << raw_bytes / time_copy / 1e9 << " GB/s\n";
+
+		std::cout << "\t(checksum " << checksum << ")\n";
+
+		std::cout << "- benchmark_snapshot_codec() done\n";
+
+	}
+
+	void benchmark_incremental_catalog(int N){
+
+		std::cout << "\n- Running benchmark_incremental_catalog... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		arma::mat kep_states = arma::randu<arma::mat>(6,N);
+		kep_states.row(0) += 1;
+		arma::mat cart_states;
+		OC::BatchConversions::kep_to_cart(kep_states,1,0,cart_states);
+
+		std::vector<double> shell_radii = {1.2,1.4,1.6,1.8,2,2.5,3};
+
+		auto start = std::chrono::high_resolution_clock::now();
+		OC::IncrementalCatalog catalog(cart_states,1,shell_radii);
+		double time_full = elapsed(start);
+
+		std::cout << " " << N << " objects: full conversion and indexing " << time_full << " s\n";
+
+		double fractions[3] = {1e-3,1e-2,1e-1};
+		for (unsigned int f = 0; f < 3; ++f){
+
+			unsigned int updates = static_cast<unsigned int>(fractions[f] * N);
+			arma::mat new_states = cart_states.cols(0,updates - 1) * 1.01;
+
+			// Spread the updates over the catalog
+			start = std::chrono::high_resolution_clock::now();
+			for (unsigned int u = 0; u < updates; ++u){
+				catalog.update((u * 7919u) % N,new_states.colptr(u));
+			}
+			unsigned int refreshed = catalog.refresh();
+			double time_incremental = elapsed(start);
+
+			std::cout << "\t" << 100 * fractions[f] << " % updated (" << refreshed << " objects): " 
+			<< time_incremental << " s, " << time_full / time_incremental << "x faster than a full pass\n";
+
+		}
+
+		std::cout << "- benchmark_incremental_catalog() done\n";
+
+	}
+
+	void benchmark_arc_bounds(int N){
+
+		std::cout << "\n- Running benchmark_arc_bounds... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		// Low orbits screened over a tenth of a revolution
+		arma::mat kep_states = arma::randu<arma::mat>(6,N);
+		kep_states.row(0) = 1.05 + 0.5 * kep_states.row(0);
+		kep_states.row(1) *= 0.05;
+		kep_states.row(2) *= arma::datum::pi;
+		kep_states.rows(3,5) *= 2 * arma::datum::pi;
+		OC::KepCatalog catalog(kep_states,1);
+		double t0 = 0;
+		double t1 = 0.6;
+		double distance = 1e-3;
+
+		// Reference: boxes from 32 sampled positions, which are not guaranteed to contain the arc
+		auto start = std::chrono::high_resolution_clock::now();
+		std::vector<OC::ArcBox> sampled_boxes(N);
+		#pragma omp parallel for
+		for (int i = 0; i < N; ++i){
+			OC::PreparedKepState orbit(kep_states.colptr(i),1);
+			for (unsigned int s = 0; s <= 32; ++s){
+				double pos[3];
+				orbit.get_position(t0 + (t1 - t0) * s / 32,pos);
+				for (unsigned int k = 0; k < 3; ++k){
+					sampled_boxes[i].min[k] = s == 0 ? pos[k] : std::min(sampled_boxes[i].min[k],pos[k]);
+					sampled_boxes[i].max[k] = s == 0 ? pos[k] : std::max(sampled_boxes[i].max[k],pos[k]);
+				}
+			}
+		}
+		double time_sampled = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		OC::ArcBVH bvh(catalog,t0,t1);
+		double time_build = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		std::vector<std::pair<unsigned int,unsigned int> > pairs = bvh.find_overlapping_pairs(distance);
+		double time_pairs = elapsed(start);
+
+		// Reference: all-pairs box and shell tests
+		start = std::chrono::high_resolution_clock::now();
+		unsigned long long brute_force_pairs = 0;
+		#pragma omp parallel for reduction(+:brute_force_pairs) schedule(dynamic,64)
+		for (int i = 0; i < N; ++i){
+			for (int j = i + 1; j < N; ++j){
+				if (bvh.get_box(i).overlaps(bvh.get_box(j),distance) && bvh.get_shell(i).overlaps(bvh.get_shell(j),distance)){
+					++brute_force_pairs;
+				}
+			}
+		}
+		double time_brute_force = elapsed(start);
+
+		double all_pairs = 0.5 * double(N) * (N - 1);
+		std::cout << " " << N << " arcs, " << all_pairs << " pairs\n";
+		std::cout << "\tsampled boxes (33 points): " << N / time_sampled << " arcs/s\n";
+		std::cout << "\tanalytic bounds + BVH build: " << N / time_build << " arcs/s\n";
+		std::cout << "\tBVH pair search: " << time_pairs << " s, all-pairs search: " << time_brute_force << " s (" 
+		<< time_brute_force / time_pairs << "x)\n";
+		std::cout << "\t" << pairs.size() << " candidate pairs (" << 100 * pairs.size() / all_pairs << " % of all pairs, " 
+		<< brute_force_pairs << " all-pairs)\n";
+
+		std::cout << "- benchmark_arc_bounds() done\n";
+
+	}
+
+	void benchmark_masked_conversions(int N){
+
+		std::cout << "\n- Running benchmark_masked_conversions... \n" ;
+
+		arma::arma_rng::set_seed(0);
+
+		arma::mat kep_states = arma::randu<arma::mat>(6,N);
+		kep_states.row(0) += 1;
+		kep_states.row(1) *= 0.9;
+
+		arma::mat cart_states,kep_states_back,packed;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		OC::BatchConversions::kep_to_cart(kep_states,1,0,cart_states);
+		double time_full = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		OC::MaskedConversions::kep_to_cart<OC::CART_ALL>(kep_states,1,0,packed);
+		double time_all = elapsed(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		OC::MaskedConversions::kep_to_cart<OC::CART_POSITION>(kep_states,1,0,packed);
+		double time_position = elapsed(start);
+
+		std::cout << " " << N << " states\n";
+		std::cout << "\tkep_to_cart: full " << N / time_full << " states/s, CART_ALL " << N / time_all 
+		<< " states/s, CART_POSITION " << N / time_position << " states/s (" << time_full / time_position << "x)\n";
+
+		start = std::chrono::high_resolution_clock::now();
+		OC::BatchConversions::cart_to_kep(cart_states,1,0,kep_states_back);
+		time_full = elapsed(start);
+
+		std::cout << "\tcart_to_kep: full " << N / time_full << " states/s\n";
+
+		unsigned int masks[4] = {OC::KEP_ALL,OC::KEP_M0,OC::KEP_SHAPE,OC::KEP_A};
+		std::string names[4] = {"KEP_ALL","KEP_M0","KEP_SHAPE","KEP_A"};
+		for (unsigned int m = 0; m < 4; ++m){
+
+			start = std::chrono::high_resolution_clock::now();
+			switch (masks[m]){
+				case OC::KEP_ALL:
+				OC::MaskedConversions::cart_to_kep<OC::KEP_ALL>(cart_states,1,0,packed);
+				break;
+				case OC::KEP_M0:
+				OC::MaskedConversions::cart_to_kep<OC::KEP_M0>(cart_states,1,0,packed);
+				break;
+				case OC::KEP_SHAPE:
+				OC::MaskedConversions::cart_to_kep<OC::KEP_SHAPE>(cart_states,1,0,packed);
+				break;
+				default:
+				OC::MaskedConversions::cart_to_kep<OC::KEP_A>(cart_states,1,0,packed);
+			}
+			double time_masked = elapsed(start);
+
+			std::cout << "\t\t" << names[m] << " " << N / time_masked << " states/s (" << time_full / time_masked << "x)\n";
+
+		}
+
+		std::cout << "- benchmark_masked_conversions() done\n";
+
+	}
+
+}
\ No newline at end of file
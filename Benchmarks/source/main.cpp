@@ -0,0 +1,13 @@
+#include <Benchmarks.hpp>
+#include <armadillo>
+#include <OrbitConversions.hpp>
+
+
+
+int main(){
+
+	Benchmarks::run_benchmarks(1000000);
+
+	return 0;
+
+}
\ No newline at end of file
@@ -0,0 +1,149 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef HEADER_PROPERTY_HARNESS
+#define HEADER_PROPERTY_HARNESS
+
+#include <string>
+#include <vector>
+
+namespace Tests{
+
+	/**
+	Outcome of a property run
+	*/
+	struct PropertyResult{
+
+		// Property name, used as baseline key
+		std::string name;
+
+		// Number of evaluated samples
+		unsigned long long samples;
+
+		// Largest error over all samples and the input producing it
+		double worst_error;
+		std::vector<double> worst_input;
+		std::vector<std::string> input_names;
+
+		// Absolute error bound the property must satisfy regardless of the baseline
+		double tolerance;
+
+		// Evaluated samples per second, all threads combined
+		double throughput;
+
+	};
+
+	/**
+	Parallel property-based accuracy and performance harness.
+	Each property is a round trip through the conversion routines evaluated on 
+	inputs stratified over eccentricity, inclination and anomaly: sample j falls 
+	in cell j % n_cells of a regular grid over these three coordinates and is 
+	jittered uniformly within it, so that every region of the domain is covered 
+	at any sample count. Samples are drawn from a counter-based generator keyed 
+	on the sample index, which makes the results independent of the number of threads.
+	Unlike assert, the checks are performed in release builds and reported 
+	through the return values
+	*/
+	class PropertyHarness{
+
+	public:
+
+		/**
+		Constructor
+		@param samples number of samples per property
+		@param seed generator seed
+		*/
+		PropertyHarness(unsigned long long samples,unsigned long long seed = 0);
+
+		/**
+		Evaluates all the properties
+		*/
+		void run();
+
+		/**
+		Prints the worst-case errors, their inputs and the throughputs
+		*/
+		void print() const;
+
+		const std::vector<PropertyResult> & get_results() const;
+
+		/**
+		Writes the results as a baseline, one property per line 
+		(name, samples, worst error, throughput)
+		@param path baseline file
+		@return true if the file could be written
+		*/
+		bool save_baseline(const std::string & path) const;
+
+		/**
+		Compares the results against a stored baseline. The check fails if the baseline 
+		is missing, if it does not list every property with a positive throughput or if it 
+		was recorded with a different number of samples. Throughputs are machine-specific, 
+		so baselines recorded on another machine should be checked with a loose throughput_margin
+		@param path baseline file
+		@param error_margin a property regresses if its worst error exceeds error_margin times the baseline one
+		@param throughput_margin a property regresses if its throughput falls below throughput_margin times the baseline one
+		@return true if no property exceeds its tolerance or regresses
+		*/
+		bool check_against_baseline(const std::string & path,double error_margin = 10,double throughput_margin = 0.5) const;
+
+		/**
+		Counter-based uniform deviate
+		@param seed generator seed
+		@param sample sample index
+		@param k coordinate index
+		@return deviate in [0,1)
+		*/
+		static double uniform(unsigned long long seed,unsigned long long sample,unsigned int k);
+
+		// Number of strata along eccentricity, inclination and anomaly
+		static const unsigned int strata = 8;
+
+	protected:
+
+		/**
+		Evaluates a property over all samples, in parallel
+		@param name property name
+		@param input_names names of the inputs recorded for the worst case
+		@param tolerance absolute error bound
+		@param property callable (u,input) -> error, where u holds 3 stratified 
+		deviates (eccentricity, inclination, anomaly) followed by plain ones and 
+		input receives the physical inputs
+		*/
+		struct BaselineEntry{
+			unsigned long long samples;
+			double worst_error;
+			double throughput;
+		};
+
+		template <typename Property>
+		void run_property(const std::string & name,const std::vector<std::string> & input_names,double tolerance,Property property);
+
+		unsigned long long samples;
+		unsigned long long seed;
+		std::vector<PropertyResult> results;
+
+	};
+
+}
+
+#endif
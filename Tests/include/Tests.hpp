@@ -34,6 +34,33 @@ namespace Tests{
 
 	void test_f_from_H(int N);
 	void test_f_from_ecc(int N);
+	void test_solver_policy(int N);
+
+	void test_cart_to_equinoctial_to_cart(int N);
+	void test_equinoctial_singular_orbits(int N);
+	void test_batch_conversions(int N);
+	void test_regime_dispatch(int N);
+
+	void test_prepared_kep_state(int N);
+	void test_close_approach(int N);
+	void test_snapshot_grid(int N);
+	void test_event_finder(int N);
+	void test_lambert(int N);
+	void test_porkchop(int N);
+	void test_relative_motion(int N);
+	void test_ground_track(int N);
+	void test_measurements(int N);
+	void test_covariance_mapping(int N);
+	void test_dispersion(int N);
+	void test_conversion_cache(int N);
+	void test_state_catalog(int N);
+	void test_eclipse(int N);
+	void test_conversion_service(int N);
+	void test_mean_elements(int N);
+	void test_snapshot_codec(int N);
+	void test_incremental_catalog(int N);
+	void test_arc_bounds(int N);
+	void test_masked_conversions(int N);
 
 
 
@@ -0,0 +1,316 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PropertyHarness.hpp"
+#include <RigidBodyKinematics.hpp>
+#include <OrbitConversions.hpp>
+#include <chrono>
+#include <fstream>
+#include <map>
+
+namespace Tests{
+
+	PropertyHarness::PropertyHarness(unsigned long long samples,unsigned long long seed){
+		this -> samples = samples;
+		this -> seed = seed;
+	}
+
+	double PropertyHarness::uniform(unsigned long long seed,unsigned long long sample,unsigned int k){
+
+		// splitmix64 finalizer applied to the (seed,sample,coordinate) counter
+		unsigned long long x = seed * 0x9e3779b97f4a7c15ULL + sample * 16 + k + 1;
+		x ^= x >> 30;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+		x *= 0x94d049bb133111ebULL;
+		x ^= x >> 31;
+		x *= 0xbf58476d1ce4e5b9ULL;
+		x ^= x >> 27;
+
+		return (x >> 11) * (1. / 9007199254740992.);
+
+	}
+
+	template <typename Property>
+	void PropertyHarness::run_property(const std::string & name,const std::vector<std::string> & input_names,double tolerance,Property property){
+
+		std::cout << " " << name << "... " << std::flush;
+
+		const unsigned long long n_cells = strata * strata * strata;
+		const long long N = this -> samples;
+		const unsigned long long seed = this -> seed;
+
+		PropertyResult result;
+		result.name = name;
+		result.samples = this -> samples;
+		result.input_names = input_names;
+		result.tolerance = tolerance;
+		result.worst_error = 0;
+		result.worst_input.resize(input_names.size());
+		unsigned long long worst_sample = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+
+		#pragma omp parallel
+		{
+			double worst_error = 0;
+			unsigned long long worst_sample_local = 0;
+			std::vector<double> worst_input(input_names.size());
+			double u[8];
+			double input[8];
+
+			#pragma omp for schedule(static)
+			for (long long j = 0; j < N; ++j){
+
+				unsigned long long cell = j % n_cells;
+				u[0] = (cell % strata + uniform(seed,j,0)) / strata;
+				u[1] = ((cell / strata) % strata + uniform(seed,j,1)) / strata;
+				u[2] = (cell / (strata * strata) + uniform(seed,j,2)) / strata;
+				for (unsigned int k = 3; k < 8; ++k){
+					u[k] = uniform(seed,j,k);
+				}
+
+				double error = property(u,input);
+
+				// NaN errors are always the worst
+				if (error > worst_error || (error != error && worst_error == worst_error)){
+					worst_error = error;
+					worst_sample_local = j;
+					std::copy(input,input + input_names.size(),worst_input.begin());
+				}
+
+			}
+
+			// Ties are broken on the sample index so that the reported input does not depend on the schedule
+			#pragma omp critical
+			{
+				bool worse = (worst_error > result.worst_error) 
+				|| (worst_error != worst_error && result.worst_error == result.worst_error)
+				|| (worst_error == result.worst_error && worst_sample_local < worst_sample);
+				if (worse){
+					result.worst_error = worst_error;
+					result.worst_input = worst_input;
+					worst_sample = worst_sample_local;
+				}
+			}
+		}
+
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		result.throughput = N / elapsed.count();
+
+		std::cout << "done\n";
+
+		this -> results.push_back(result);
+
+	}
+
+	void PropertyHarness::run(){
+
+		std::cout << "\n- Running PropertyHarness on " << this -> samples << " samples per property... \n";
+
+		this -> results.clear();
+
+		const double pi = arma::datum::pi;
+
+		this -> run_property("ecc_from_M",{"e","M"},1e-10,
+			[pi](const double * u,double * input){
+				double e = 0.999 * u[0];
+				double M = pi * (2 * u[2] - 1);
+				input[0] = e;
+				input[1] = M;
+				return std::abs(OC::State::M_from_ecc(OC::State::ecc_from_M(M,e),e) - M);
+			});
+
+		this -> run_property("H_from_M",{"e","M"},1e-10,
+			[](const double * u,double * input){
+				double e = 1.001 + 4 * u[0];
+				double M = 10 * (2 * u[2] - 1);
+				input[0] = e;
+				input[1] = M;
+				return std::abs(OC::State::M_from_H(OC::State::H_from_M(M,e),e) - M);
+			});
+
+		this -> run_property("f_from_ecc",{"e","f"},1e-10,
+			[pi](const double * u,double * input){
+				double e = 0.999 * u[0];
+				double f = pi * (2 * u[2] - 1);
+				input[0] = e;
+				input[1] = f;
+				return std::abs(OC::State::f_from_ecc(OC::State::ecc_from_f(f,e),e) - f);
+			});
+
+		this -> run_property("f_from_H",{"e","f"},1e-8,
+			[](const double * u,double * input){
+				double e = 1.001 + 4 * u[0];
+
+				// True anomaly within 99% of the asymptote
+				double f = 0.99 * std::acos(- 1 / e) * (2 * u[2] - 1);
+				input[0] = e;
+				input[1] = f;
+				return std::abs(OC::State::f_from_H(OC::State::H_from_f(f,e),e) - f);
+			});
+
+		// convert_to_cart -> convert_to_kep -> convert_to_cart, compared in cartesian space 
+		// where the round trip is well defined for circular and equatorial orbits
+		auto kep_round_trip = [](const arma::vec & kep_state,double * input){
+			for (unsigned int k = 0; k < 6; ++k){
+				input[k] = kep_state(k);
+			}
+			OC::CartState cart = OC::KepState(kep_state,1).convert_to_cart(0);
+			OC::CartState cart_back = cart.convert_to_kep(0).convert_to_cart(0);
+			return arma::norm(cart_back.get_state() - cart.get_state()) / arma::norm(cart.get_state());
+		};
+
+		this -> run_property("kep_to_cart_to_kep_elliptic",{"a","e","i","Omega","omega","M0"},1e-8,
+			[pi,kep_round_trip](const double * u,double * input){
+				arma::vec kep_state(6);
+				kep_state(0) = 1 + u[3];
+				kep_state(1) = 0.95 * u[0];
+				kep_state(2) = pi * u[1];
+				kep_state(3) = 2 * pi * u[4];
+				kep_state(4) = 2 * pi * u[5];
+				kep_state(5) = pi * (2 * u[2] - 1);
+				return kep_round_trip(kep_state,input);
+			});
+
+		this -> run_property("kep_to_cart_to_kep_hyperbolic",{"a","e","i","Omega","omega","M0"},1e-8,
+			[pi,kep_round_trip](const double * u,double * input){
+				arma::vec kep_state(6);
+				kep_state(0) = - (1 + u[3]);
+				kep_state(1) = 1.05 + 3 * u[0];
+				kep_state(2) = pi * u[1];
+				kep_state(3) = 2 * pi * u[4];
+				kep_state(4) = 2 * pi * u[5];
+				kep_state(5) = 5 * (2 * u[2] - 1);
+				return kep_round_trip(kep_state,input);
+			});
+
+	}
+
+	const std::vector<PropertyResult> & PropertyHarness::get_results() const{
+		return this -> results;
+	}
+
+	void PropertyHarness::print() const{
+
+		for (auto result : this -> results){
+			std::cout << "\t" << result.name << ": worst error " << result.worst_error 
+			<< " (tolerance " << result.tolerance << "), " << result.throughput << " samples/s\n\t\tat";
+			for (unsigned int k = 0; k < result.input_names.size(); ++k){
+				std::cout << " " << result.input_names[k] << " = " << result.worst_input[k];
+			}
+			std::cout << "\n";
+		}
+
+	}
+
+	bool PropertyHarness::save_baseline(const std::string & path) const{
+
+		std::ofstream file(path);
+		if (!file.is_open()){
+			std::cout << " Could not write baseline " << path << "\n";
+			return false;
+		}
+
+		file.precision(17);
+		for (auto result : this -> results){
+			file << result.name << " " << result.samples << " " << result.worst_error << " " << result.throughput << "\n";
+		}
+
+		return true;
+
+	}
+
+	bool PropertyHarness::check_against_baseline(const std::string & path,double error_margin,double throughput_margin) const{
+
+		bool passed = true;
+
+		for (auto result : this -> results){
+			if (!(result.worst_error <= result.tolerance)){
+				std::cout << " " << result.name << " exceeds its tolerance: " << result.worst_error << " > " << result.tolerance << "\n";
+				passed = false;
+			}
+		}
+
+		std::map<std::string,BaselineEntry> baseline;
+		std::ifstream file(path);
+		if (!file.is_open()){
+			std::cout << " No baseline found at " << path << ". Run with 'update' to create it\n";
+			std::cout << "- PropertyHarness failed\n";
+			return false;
+		}
+
+		BaselineEntry entry_read;
+		std::string name;
+		while (file >> name >> entry_read.samples >> entry_read.worst_error >> entry_read.throughput){
+			baseline[name] = entry_read;
+		}
+
+		for (auto result : this -> results){
+
+			auto entry = baseline.find(result.name);
+			if (entry == baseline.end()){
+				std::cout << " " << result.name << " is not in the baseline\n";
+				passed = false;
+				continue;
+			}
+
+			// The worst error grows with the number of samples, so only runs of the same size are comparable
+			if (result.samples != entry -> second.samples){
+				std::cout << " " << result.name << " was run on " << result.samples << " samples but the baseline has " 
+				<< entry -> second.samples << ". Run with the baseline sample count or 'update'\n";
+				passed = false;
+				continue;
+			}
+
+			// Errors at the round-off level are not compared against each other
+			double error_bound = error_margin * std::max(entry -> second.worst_error,1e-15);
+			if (result.worst_error > error_bound){
+				std::cout << " " << result.name << " accuracy regressed: " << result.worst_error 
+				<< " vs " << entry -> second.worst_error << " in baseline\n";
+				passed = false;
+			}
+
+			if (!(entry -> second.throughput > 0)){
+				std::cout << " " << result.name << " has no baseline throughput. Run with 'update'\n";
+				passed = false;
+			}
+			else if (result.throughput < throughput_margin * entry -> second.throughput){
+				std::cout << " " << result.name << " throughput regressed: " << result.throughput 
+				<< " vs " << entry -> second.throughput << " samples/s in baseline\n";
+				passed = false;
+			}
+
+		}
+
+		if (passed){
+			std::cout << "- PropertyHarness passed\n";
+		}
+		else{
+			std::cout << "- PropertyHarness failed\n";
+		}
+
+		return passed;
+
+	}
+
+}
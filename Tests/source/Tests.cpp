@@ -23,7 +23,10 @@
 #include "Tests.hpp"
 #include <RigidBodyKinematics.hpp>
 #include <OrbitConversions.hpp>
+#include <algorithm>
+#include <stdexcept>
 #include <cassert>
+#include <thread>
 
 namespace Tests{
 	void run_tests(int N){
@@ -35,10 +38,38 @@ namespace Tests{
 		Tests::test_ecc_from_M(N);
 		Tests::test_f_from_ecc(N);
 
+		Tests::test_solver_policy(N);
+
 		Tests::test_cart_to_kep(N);
 		Tests::test_kep_to_cart(N);
 		Tests::test_cart_to_kep_to_cart(N);
 
+		Tests::test_cart_to_equinoctial_to_cart(N);
+		Tests::test_equinoctial_singular_orbits(N);
+		Tests::test_batch_conversions(N);
+		Tests::test_regime_dispatch(N);
+
+		Tests::test_prepared_kep_state(N);
+		Tests::test_close_approach(N / 1000);
+		Tests::test_snapshot_grid(N / 10);
+		Tests::test_event_finder(N / 10);
+		Tests::test_lambert(N / 10);
+		Tests::test_porkchop(N / 1000);
+		Tests::test_relative_motion(N);
+		Tests::test_ground_track(N / 1000);
+		Tests::test_measurements(N / 10);
+		Tests::test_covariance_mapping(N / 10);
+		Tests::test_dispersion(N / 10);
+		Tests::test_conversion_cache(N / 10);
+		Tests::test_state_catalog(N);
+		Tests::test_eclipse(N / 100);
+		Tests::test_conversion_service(N / 10);
+		Tests::test_mean_elements(N / 10);
+		Tests::test_snapshot_codec(N / 10);
+		Tests::test_incremental_catalog(N);
+		Tests::test_arc_bounds(N / 10);
+		Tests::test_masked_conversions(N / 10);
+
 	}
 
 
@@ -144,7 +175,7 @@ namespace Tests{
 
 			assert(error < 1e-8);
 		}
-		std::cout << "- test_ecc_from_M() passed\n";
+		std::cout << "- test_ecc_from_f() passed\n";
 
 	}
 
@@ -263,5 +294,1913 @@ namespace Tests{
 
 
 
-}
+	void test_prepared_kep_state(int N){
+
+		std::cout << "\n- Running test_prepared_kep_state \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		for (int i = 0; i < N; ++i){
+
+			arma::vec kep_state_vec = arma::zeros<arma::vec>(6);
+			arma::vec rands = arma::randu<arma::vec>(8);
+
+			kep_state_vec(1) = 2 * rands(1);
+
+			if (kep_state_vec(1) > 1){
+				kep_state_vec(0) = - (rands(0) + 0.1);
+			}
+			else{
+				kep_state_vec(0) = (rands(0) + 0.1);
+			}
+
+			kep_state_vec(2) = arma::datum::pi * rands(2);
+			kep_state_vec(3) = 2 * arma::datum::pi * rands(3);
+			kep_state_vec(4) = 2 * arma::datum::pi * rands(4);
+			kep_state_vec(5) = 3 * (0.5 - rands(5));
+
+			double dt = rands(6);
+			double mu = 1 + rands(7);
+
+			OC::KepState kep(kep_state_vec,mu);
+			OC::PreparedKepState prepared_kep(kep);
+
+			arma::vec cart_state = kep.convert_to_cart(dt).get_state();
+			arma::vec prepared_cart_state(6);
+			prepared_kep.get_position_velocity(dt,prepared_cart_state.memptr(),prepared_cart_state.memptr() + 3);
+
+			double error = arma::norm(prepared_cart_state - cart_state) / arma::norm(cart_state);
+			assert(error < 1e-8);
+		}
+
+		std::cout <<  "- test_prepared_kep_state() passed\n";
+
+	}
+
+	void test_close_approach(int N){
+
+		std::cout << "\n- Running test_close_approach \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		std::vector<OC::KepState> catalog;
+		std::vector<std::pair<unsigned int,unsigned int> > candidates;
+
+		for (int i = 0; i < N; ++i){
+
+			arma::vec rands = arma::randu<arma::vec>(6);
+
+			// Two orbits with close shapes and orientations, so that they come close to each other
+			arma::vec kep_state_vec_1 = {1 + rands(0),0.3 * rands(1),arma::datum::pi * rands(2),2 * arma::datum::pi * rands(3),2 * arma::datum::pi * rands(4),2 * arma::datum::pi * rands(5)};
+			arma::vec kep_state_vec_2 = kep_state_vec_1 + 0.05 * (arma::randu<arma::vec>(6) - 0.5);
+			kep_state_vec_2(5) = kep_state_vec_1(5) + arma::datum::pi * rands(0);
+
+			catalog.push_back(OC::KepState(kep_state_vec_1,1));
+			catalog.push_back(OC::KepState(kep_state_vec_2,1));
+			candidates.push_back(std::make_pair(2 * i,2 * i + 1));
+		}
+
+		double t0 = 0;
+		double t1 = 50;
+
+		std::vector<std::vector<OC::CloseApproachEvent> > events = OC::CloseApproach::find_close_approaches(catalog,
+			candidates,t0,t1,arma::datum::inf);
+
+		for (int i = 0; i < N; ++i){
+
+			const OC::KepState & kep_1 = catalog[candidates[i].first];
+			const OC::KepState & kep_2 = catalog[candidates[i].second];
+
+			// Every event must be a stationary point of the distance
+			double min_event_distance = arma::datum::inf;
+			for (unsigned int k = 0; k < events[i].size(); ++k){
+				OC::CartState cart_1 = kep_1.convert_to_cart(events[i][k].t);
+				OC::CartState cart_2 = kep_2.convert_to_cart(events[i][k].t);
+
+				arma::vec dr = cart_2.get_position_vector() - cart_1.get_position_vector();
+				arma::vec dv = cart_2.get_velocity_vector() - cart_1.get_velocity_vector();
+
+				assert(std::abs(arma::dot(dr,dv)) / (arma::norm(dr) * arma::norm(dv)) < 1e-6);
+				assert(std::abs(arma::norm(dr) - events[i][k].distance) < 1e-8);
+
+				min_event_distance = std::min(min_event_distance,events[i][k].distance);
+			}
+
+			// Brute-force sampling must not find any interior minimum closer than the closest event
+			arma::vec sampled_distances(5001);
+			for (int k = 0; k < 5001; ++k){
+				double t = t0 + (t1 - t0) * k / 5000.;
+				arma::vec dr = kep_2.convert_to_cart(t).get_position_vector() - kep_1.convert_to_cart(t).get_position_vector();
+				sampled_distances(k) = arma::norm(dr);
+			}
+
+			for (int k = 1; k < 5000; ++k){
+				if (sampled_distances(k) < sampled_distances(k - 1) && sampled_distances(k) < sampled_distances(k + 1)){
+					assert(min_event_distance <= sampled_distances(k) + 1e-10);
+				}
+			}
+
+		}
+
+		std::cout <<  "- test_close_approach() passed\n";
+
+	}
+
+
+	void test_snapshot_grid(int N){
+
+		std::cout << "\n- Running test_snapshot_grid \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		std::vector<OC::KepState> constellation;
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			arma::vec kep_state_vec = {1 + 0.1 * rands(0),0.01 * rands(1),arma::datum::pi * rands(2),2 * arma::datum::pi * rands(3),2 * arma::datum::pi * rands(4),2 * arma::datum::pi * rands(5)};
+			constellation.push_back(OC::KepState(kep_state_vec,1));
+		}
+
+		double distance = 0.05;
+		OC::SnapshotGrid grid(constellation,distance);
+
+		for (int k = 0; k < 3; ++k){
+
+			double t = 1e-2 * k;
+			grid.propagate(t);
+
+			arma::mat positions(3,N);
+			for (int i = 0; i < N; ++i){
+				positions.col(i) = constellation[i].convert_to_cart(t).get_position_vector();
+			}
+
+			double error = arma::norm(positions - grid.get_positions()) / arma::norm(positions);
+			assert(error < 1e-8);
+
+			// Brute-force pairs
+			std::vector<std::pair<unsigned int,unsigned int> > pairs;
+			for (int i = 0; i < N; ++i){
+				for (int j = i + 1; j < N; ++j){
+					if (arma::norm(grid.get_positions().col(i) - grid.get_positions().col(j)) <= distance){
+						pairs.push_back(std::make_pair(i,j));
+					}
+				}
+			}
+			assert(pairs == grid.query_pairs(distance));
+			assert(pairs.size() > 0);
+
+			// Brute-force radius query, with a radius larger than the cell size
+			arma::vec::fixed<3> point = grid.get_positions().col(0);
+			std::vector<unsigned int> neighbors;
+			for (int i = 0; i < N; ++i){
+				if (arma::norm(grid.get_positions().col(i) - point) <= 2.5 * distance){
+					neighbors.push_back(i);
+				}
+			}
+			assert(neighbors == grid.query_radius(point,2.5 * distance));
+		}
+
+		// Small steps only move the objects crossing a cell, and must bin them as a fresh snapshot would
+		unsigned int incremental_steps = 0;
+		for (int k = 1; k <= 20; ++k){
+
+			double t = 2e-2 + 1e-3 * k;
+			unsigned int rebuilds = grid.get_number_of_rebuilds();
+			unsigned int moved = grid.propagate(t);
+
+			if (moved > 0 && grid.get_number_of_rebuilds() == rebuilds){
+				++incremental_steps;
+			}
+
+			OC::SnapshotGrid fresh_grid(constellation,distance,t);
+			assert(fresh_grid.get_number_of_rebuilds() == 1);
+			assert(arma::norm(fresh_grid.get_positions() - grid.get_positions()) == 0);
+			assert(fresh_grid.query_pairs(distance) == grid.query_pairs(distance));
+
+			for (int i = 0; i < std::min(N,10); ++i){
+				arma::vec::fixed<3> point = grid.get_positions().col(i);
+				assert(fresh_grid.query_radius(point,2.5 * distance) == grid.query_radius(point,2.5 * distance));
+			}
+
+		}
+		assert(incremental_steps > 0);
+
+		std::cout <<  "- test_snapshot_grid() passed\n";
+
+	}
+
+
+	void test_event_finder(int N){
+
+		std::cout << "\n- Running test_event_finder \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		std::vector<OC::KepState> catalog;
+
+		for (int i = 0; i < N; ++i){
+
+			arma::vec kep_state_vec = arma::zeros<arma::vec>(6);
+			arma::vec rands = arma::randu<arma::vec>(6);
+
+			kep_state_vec(1) = 2 * rands(1);
+
+			if (kep_state_vec(1) > 1){
+				kep_state_vec(0) = - (rands(0) + 0.1);
+			}
+			else{
+				kep_state_vec(0) = (rands(0) + 0.1);
+			}
+
+			kep_state_vec(2) = arma::datum::pi * rands(2);
+			kep_state_vec(3) = 2 * arma::datum::pi * rands(3);
+			kep_state_vec(4) = 2 * arma::datum::pi * rands(4);
+			kep_state_vec(5) = 3 * (0.5 - rands(5));
+
+			catalog.push_back(OC::KepState(kep_state_vec,1));
+		}
+
+		// Equatorial orbit with omega = 0, whose periapsis would coincide with its ascending node
+		arma::vec equatorial_state_vec = {1,0.1,0,0,0,0};
+		catalog.push_back(OC::KepState(equatorial_state_vec,1));
+
+		std::vector<double> targets = {1.};
+		std::vector<OC::OrbitEvent> events = OC::EventFinder::find_events(catalog,-5,5,targets);
+
+		assert(events.size() > 0);
+
+		for (unsigned int k = 0; k < events.size(); ++k){
+
+			assert(events[k].t >= -5 && events[k].t <= 5);
+			if (k > 0){
+				assert(events[k].t >= events[k - 1].t);
+				if (events[k].t == events[k - 1].t && events[k].object == events[k - 1].object){
+					assert(events[k].type >= events[k - 1].type);
+				}
+			}
+
+			if (events[k].object == catalog.size() - 1){
+				assert(events[k].type != OC::ASCENDING_NODE && events[k].type != OC::DESCENDING_NODE);
+				continue;
+			}
+
+			const OC::KepState & kep = catalog[events[k].object];
+			OC::CartState cart = kep.convert_to_cart(events[k].t);
+
+			arma::vec::fixed<3> r = cart.get_position_vector();
+			arma::vec::fixed<3> v = cart.get_velocity_vector();
+			double f = OC::State::f_from_M(kep.get_M0() + kep.get_n() * events[k].t,kep.get_eccentricity());
+
+			if (events[k].type == OC::PERIAPSIS){
+				assert(std::abs(arma::dot(r,v)) / (arma::norm(r) * arma::norm(v)) < 1e-6);
+				assert(std::cos(f) > 0);
+			}
+			else if (events[k].type == OC::APOAPSIS){
+				assert(std::abs(arma::dot(r,v)) / (arma::norm(r) * arma::norm(v)) < 1e-6);
+				assert(std::cos(f) < 0);
+			}
+			else if (events[k].type == OC::ASCENDING_NODE){
+				assert(std::abs(r(2)) / arma::norm(r) < 1e-6);
+				assert(v(2) >= 0);
+			}
+			else if (events[k].type == OC::DESCENDING_NODE){
+				assert(std::abs(r(2)) / arma::norm(r) < 1e-6);
+				assert(v(2) <= 0);
+			}
+			else{
+				assert(std::abs(std::remainder(f - targets[events[k].target],2 * arma::datum::pi)) < 1e-6);
+			}
+		}
+
+		std::cout <<  "- test_event_finder() passed\n";
+
+	}
+
+
+	void test_lambert(int N){
+
+		std::cout << "\n- Running test_lambert \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		for (int i = 0; i < N; ++i){
+
+			arma::vec::fixed<3> r1 = arma::randn<arma::vec>(3);
+			arma::vec::fixed<3> r2 = arma::randn<arma::vec>(3);
+			arma::vec rands = arma::randu<arma::vec>(2);
+			double tof = 30 * rands(0) + 0.05;
+			double mu = 1 + rands(1);
+			bool prograde = (i % 2 == 0);
+
+			std::vector<OC::LambertSolution> solutions = OC::Lambert::solve(r1,r2,tof,mu,prograde,5);
+			unsigned int max_revolutions = OC::Lambert::get_max_revolutions(r1,r2,tof,mu,prograde);
+
+			assert(solutions.size() == 1 + 2 * std::min(max_revolutions,5u));
+
+			for (unsigned int k = 0; k < solutions.size(); ++k){
+
+				// Propagating the departure state over the time of flight must yield the arrival state
+				OC::KepState kep = solutions[k].departure.convert_to_kep(0);
+				OC::CartState cart = kep.convert_to_cart(tof);
+
+				double error = arma::norm(cart.get_state() - solutions[k].arrival.get_state()) / arma::norm(solutions[k].arrival.get_state());
+				assert(error < 1e-7);
+
+				double h_z = arma::cross(r1,solutions[k].departure.get_velocity_vector())(2);
+				assert(prograde == (h_z > 0));
+
+				if (solutions[k].revolutions > 0){
+					double period = 2 * arma::datum::pi / kep.get_n();
+					assert(tof > solutions[k].revolutions * period && tof < (solutions[k].revolutions + 1) * period);
+				}
+			}
+		}
+
+		std::cout <<  "- test_lambert() passed\n";
+
+	}
+
+	void test_porkchop(int N){
+
+		std::cout << "\n- Running test_porkchop \n" ;
+
+		arma::vec departure_body_state = {1,0.02,0.01,0.1,0.2,0.3};
+		arma::vec arrival_body_state = {1.5,0.09,0.03,0.8,4.5,2.0};
+
+		OC::KepState departure_body(departure_body_state,1);
+		OC::KepState arrival_body(arrival_body_state,1);
+
+		arma::vec departure_times = arma::linspace<arma::vec>(0,10,N + 3);
+		arma::vec arrival_times = arma::linspace<arma::vec>(5,15,N + 5);
+
+		arma::mat departure_dv,arrival_dv;
+		OC::Porkchop::compute(departure_body,arrival_body,departure_times,arrival_times,departure_dv,arrival_dv,0,true,true,4);
+
+		for (unsigned int i = 0; i < departure_times.n_rows; ++i){
+			for (unsigned int j = 0; j < arrival_times.n_rows; ++j){
+
+				arma::vec::fixed<3> r1 = departure_body.convert_to_cart(departure_times(i)).get_position_vector();
+				arma::vec::fixed<3> r2 = arrival_body.convert_to_cart(arrival_times(j)).get_position_vector();
+				double tof = arrival_times(j) - departure_times(i);
+
+				OC::CartState departure,arrival;
+				if (OC::Lambert::solve(r1,r2,tof,1,0,true,true,departure,arrival)){
+					double dv = arma::norm(departure.get_velocity_vector() - departure_body.convert_to_cart(departure_times(i)).get_velocity_vector());
+					assert(std::abs(dv - departure_dv(i,j)) < 1e-8 * (1 + dv));
+				}
+				else{
+					assert(std::isnan(departure_dv(i,j)) && std::isnan(arrival_dv(i,j)));
+				}
+			}
+		}
+
+		// Single-revolution transfers on both branches. The grid straddles T_min, where the 
+		// two branches merge and a warm start could otherwise switch branch
+		for (int branch = 0; branch < 2; ++branch){
+
+			bool low_path = (branch == 0);
+			OC::Porkchop::compute(departure_body,arrival_body,departure_times,arrival_times,departure_dv,arrival_dv,1,low_path,true,4);
+
+			for (unsigned int i = 0; i < departure_times.n_rows; ++i){
+				for (unsigned int j = 0; j < arrival_times.n_rows; ++j){
+
+					OC::CartState departure_body_cart = departure_body.convert_to_cart(departure_times(i));
+					arma::vec::fixed<3> r1 = departure_body_cart.get_position_vector();
+					arma::vec::fixed<3> r2 = arrival_body.convert_to_cart(arrival_times(j)).get_position_vector();
+					double tof = arrival_times(j) - departure_times(i);
+
+					double v1[3],v2[3];
+					double x = arma::datum::nan;
+					if (!OC::Lambert::solve(r1.memptr(),r2.memptr(),tof,1,1,low_path,true,v1,v2,x)){
+						continue;
+					}
+
+					// A warm start from the converged x stays on the branch, 
+					// while one that lands on the other branch is rejected
+					double x_warm = x;
+					assert(OC::Lambert::solve(r1.memptr(),r2.memptr(),tof,1,1,low_path,true,v1,v2,x_warm));
+					x_warm = x;
+					double v1_other[3],v2_other[3];
+					assert(!OC::Lambert::solve(r1.memptr(),r2.memptr(),tof,1,1,!low_path,true,v1_other,v2_other,x_warm));
+
+					arma::vec::fixed<3> v1_vec = {v1[0],v1[1],v1[2]};
+					double dv = arma::norm(v1_vec - departure_body_cart.get_velocity_vector());
+					assert(std::abs(dv - departure_dv(i,j)) < 1e-8 * (1 + dv));
+				}
+			}
+		}
+
+		std::cout <<  "- test_porkchop() passed\n";
+
+	}
+
+
+	void test_relative_motion(int N){
+
+		std::cout << "\n- Running test_relative_motion \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		arma::mat chief_states = arma::randn<arma::mat>(6,N);
+		arma::mat deputy_states = chief_states + 1e-2 * arma::randn<arma::mat>(6,N);
+		arma::mat ric_states,deputy_states_from_ric;
+
+		OC::RelativeMotion::inertial_to_ric(chief_states,deputy_states,ric_states);
+		OC::RelativeMotion::ric_to_inertial(chief_states,ric_states,deputy_states_from_ric);
+
+		double error = arma::norm(deputy_states_from_ric - deputy_states) / arma::norm(deputy_states);
+		assert(error < 1e-12);
+
+		for (int i = 0; i < std::min(N,1000); ++i){
+
+			OC::CartState chief(chief_states.col(i),1);
+			OC::CartState deputy(deputy_states.col(i),1);
+
+			arma::vec::fixed<3> R = chief.get_position_vector() / chief.get_radius();
+			arma::vec::fixed<3> C = chief.get_momentum_vector() / chief.get_momentum();
+			arma::vec::fixed<3> I = arma::cross(C,R);
+			arma::mat::fixed<3,3> RIC;
+			RIC.row(0) = R.t();
+			RIC.row(1) = I.t();
+			RIC.row(2) = C.t();
+
+			arma::vec::fixed<3> omega = {0,0,chief.get_momentum() / std::pow(chief.get_radius(),2)};
+			arma::vec::fixed<3> rho = RIC * (deputy.get_position_vector() - chief.get_position_vector());
+			arma::vec::fixed<3> rho_dot = RIC * (deputy.get_velocity_vector() - chief.get_velocity_vector()) - arma::cross(omega,rho);
+
+			arma::vec ric_state = OC::RelativeMotion::inertial_to_ric(chief,deputy);
+
+			assert(arma::norm(ric_state.subvec(0,2) - rho) < 1e-12 * (1 + arma::norm(rho)));
+			assert(arma::norm(ric_state.subvec(3,5) - rho_dot) < 1e-12 * (1 + arma::norm(rho_dot)));
+			assert(arma::norm(ric_state - ric_states.col(i)) < 1e-14 * (1 + arma::norm(ric_state)));
+
+			OC::CartState deputy_from_ric = OC::RelativeMotion::ric_to_inertial(chief,ric_state);
+			assert(arma::norm(deputy_from_ric.get_state() - deputy.get_state()) < 1e-12 * arma::norm(deputy.get_state()));
+		}
+
+		// A single chief shared by all deputies
+		OC::RelativeMotion::inertial_to_ric(chief_states.col(0),deputy_states,ric_states);
+		OC::RelativeMotion::ric_to_inertial(chief_states.col(0),ric_states,deputy_states_from_ric);
+		error = arma::norm(deputy_states_from_ric - deputy_states) / arma::norm(deputy_states);
+		assert(error < 1e-12);
+
+		// Mismatched batches are rejected
+		bool rejected = false;
+		try{
+			OC::RelativeMotion::inertial_to_ric(chief_states.cols(0,1),deputy_states,ric_states);
+		}
+		catch (const std::invalid_argument &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		rejected = false;
+		try{
+			OC::RelativeMotion::ric_to_inertial(chief_states,ric_states.rows(0,2),deputy_states_from_ric);
+		}
+		catch (const std::invalid_argument &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		std::cout <<  "- test_relative_motion() passed\n";
+
+	}
+
+
+	void test_ground_track(int N){
+
+		std::cout << "\n- Running test_ground_track \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double mu = 398600.4418;
+		OC::EarthModel earth_model;
+
+		std::vector<OC::GroundStation> stations;
+		stations.push_back(OC::GroundStation(0.7,-1.8,1.5,0.1));
+		stations.push_back(OC::GroundStation(-0.3,2.5,0.,0.));
+
+		arma::vec times = arma::linspace<arma::vec>(0,86400,1441);
+		std::vector<OC::KepState> catalog;
+		std::vector<arma::mat> trajectories;
+
+		for (int i = 0; i < N; ++i){
+
+			arma::vec rands = arma::randu<arma::vec>(6);
+			arma::vec kep_state_vec = {6800 + 1000 * rands(0),0.02 * rands(1),arma::datum::pi * rands(2),2 * arma::datum::pi * rands(3),2 * arma::datum::pi * rands(4),2 * arma::datum::pi * rands(5)};
+			catalog.push_back(OC::KepState(kep_state_vec,mu));
+
+			arma::mat trajectory(6,times.n_rows);
+			for (unsigned int k = 0; k < times.n_rows; ++k){
+				trajectory.col(k) = catalog[i].convert_to_cart(times(k)).get_state();
+			}
+			trajectories.push_back(trajectory);
+		}
+
+		// Geodetic coordinates must map back to the Earth-fixed positions
+		arma::mat ecef_positions,lla;
+		OC::GroundTrack::compute_ground_track(trajectories[0],times,earth_model,ecef_positions,lla);
+		for (unsigned int k = 0; k < times.n_rows; ++k){
+			arma::vec::fixed<3> r_ecef = OC::GroundTrack::get_ecef_position(lla(0,k),lla(1,k),lla(2,k),earth_model);
+			assert(arma::norm(r_ecef - ecef_positions.col(k)) < 1e-8);
+			assert(std::abs(arma::norm(ecef_positions.col(k)) - arma::norm(trajectories[0].submat(0,k,2,k))) < 1e-8);
+		}
+
+		std::vector<OC::VisibilityWindow> windows = OC::GroundTrack::compute_visibility(trajectories,times,stations,earth_model);
+		assert(windows.size() > 0);
+
+		for (unsigned int w = 0; w < windows.size(); ++w){
+
+			const OC::VisibilityWindow & window = windows[w];
+			const OC::GroundStation & station = stations[window.station];
+			assert(window.set > window.rise);
+
+			arma::vec window_times = {window.rise,window.set,0.5 * (window.rise + window.set)};
+			arma::mat window_trajectory(6,3);
+			for (int k = 0; k < 3; ++k){
+				window_trajectory.col(k) = catalog[window.object].convert_to_cart(window_times(k)).get_state();
+			}
+
+			arma::mat azimuth_elevation;
+			OC::GroundTrack::compute_azimuth_elevation(window_trajectory,window_times,station,earth_model,azimuth_elevation);
+
+			// The rise and set times are accurate to the interpolation error
+			if (window.rise > times(0)){
+				assert(std::abs(azimuth_elevation(1,0) - station.min_elevation) < 1e-4);
+			}
+			if (window.set < times(times.n_rows - 1)){
+				assert(std::abs(azimuth_elevation(1,1) - station.min_elevation) < 1e-4);
+			}
+			assert(azimuth_elevation(1,2) > station.min_elevation);
+		}
+
+		std::cout <<  "- test_ground_track() passed\n";
+
+	}
+
+
+	void test_measurements(int N){
+
+		std::cout << "\n- Running test_measurements \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		arma::mat states = arma::randn<arma::mat>(6,N);
+		arma::mat station_states = 0.1 * arma::randn<arma::mat>(6,N);
+		arma::mat measurements,partials;
+
+		OC::Measurements::compute(states,station_states,measurements,partials);
+
+		for (int i = 0; i < N; ++i){
+
+			OC::CartState state(states.col(i),1);
+			arma::mat H;
+			arma::vec measurement = OC::Measurements::compute(state,station_states.col(i),H);
+
+			assert(arma::norm(measurement - measurements.col(i)) < 1e-14 * arma::norm(measurement));
+			assert(arma::norm(H.t() - partials.cols(4 * i,4 * i + 3)) < 1e-14 * arma::norm(H));
+
+			// Central finite differences
+			for (int k = 0; k < 6; ++k){
+				arma::vec dx = arma::zeros<arma::vec>(6);
+				dx(k) = 1e-6;
+
+				arma::mat H_dummy;
+				arma::vec plus = OC::Measurements::compute(OC::CartState(states.col(i) + dx,1),station_states.col(i),H_dummy);
+				arma::vec minus = OC::Measurements::compute(OC::CartState(states.col(i) - dx,1),station_states.col(i),H_dummy);
+				arma::vec H_col = (plus - minus) / 2e-6;
+
+				assert(arma::norm(H_col - H.col(k)) < 1e-5 * (1 + arma::norm(H.col(k))));
+			}
+		}
 
+		// A single station shared by all states
+		arma::mat measurements_single_station,partials_single_station;
+		OC::Measurements::compute(states,arma::repmat(station_states.col(0),1,N),measurements,partials);
+		OC::Measurements::compute(states,station_states.col(0),measurements_single_station,partials_single_station);
+		assert(arma::norm(measurements_single_station - measurements) == 0);
+		assert(arma::norm(partials_single_station - partials) == 0);
+
+		// Mismatched shapes are rejected
+		bool rejected = false;
+		try{
+			OC::Measurements::compute(states.rows(0,2),station_states,measurements,partials);
+		}
+		catch (const std::invalid_argument &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		rejected = false;
+		try{
+			OC::Measurements::compute(states,arma::zeros<arma::mat>(6,N + 1),measurements,partials);
+		}
+		catch (const std::invalid_argument &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		rejected = false;
+		try{
+			arma::mat H;
+			OC::Measurements::compute(OC::CartState(states.col(0),1),station_states.submat(0,0,2,0),H);
+		}
+		catch (const std::invalid_argument &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		std::cout <<  "- test_measurements() passed\n";
+
+	}
+
+
+	void test_cart_to_equinoctial_to_cart(int N){
+
+		std::cout <<  "\n- Running test_cart_to_equinoctial_to_cart... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(2);
+			double dt = rands(0);
+			double mu = rands(1) + 1;
+
+			OC::CartState cart(arma::randn<arma::vec>(6),mu); 
+
+			OC::EquinoctialState equinoctial = cart.convert_to_equinoctial(dt);
+			OC::KepState kep = cart.convert_to_kep(dt);
+
+			assert(std::abs(equinoctial.get_a() - kep.get_a()) < 1e-8 * std::abs(kep.get_a()));
+			assert(std::abs(equinoctial.get_eccentricity() - kep.get_eccentricity()) < 1e-8 * (1 + kep.get_eccentricity()));
+
+			// The equinoctial state must propagate like the keplerian state
+			for (int k = 0; k < 3; ++k){
+				double t = 3 * k * dt;
+				double error = arma::norm(equinoctial.convert_to_cart(t).get_state() - kep.convert_to_cart(t).get_state())/arma::norm(cart.get_state());
+				assert(error < 1e-7);
+			}
+
+			OC::CartState cart_from_equinoctial = equinoctial.convert_to_cart(dt);
+			double error = arma::norm(cart_from_equinoctial.get_state() - cart.get_state())/arma::norm(cart.get_state());
+			assert(error < 1e-7);
+		}
+
+		std::cout << "- test_cart_to_equinoctial_to_cart() passed\n";
+
+	}
+
+	void test_equinoctial_singular_orbits(int N){
+
+		std::cout <<  "\n- Running test_equinoctial_singular_orbits... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		for (int i = 0; i < N; ++i){
+
+			// Exactly circular, exactly equatorial or both
+			arma::vec rands = arma::randu<arma::vec>(4);
+			double r = 1 + rands(0);
+			double v = std::sqrt(1. / r);
+			double theta = 2 * arma::datum::pi * rands(1);
+			double inclination = (i % 3 == 0) ? 0 : arma::datum::pi / 3 * rands(2);
+			double speed_factor = (i % 2 == 1) ? 1 : 1 + 0.2 * (rands(3) - 0.5);
+
+			arma::vec cart_state = {r * std::cos(theta),r * std::sin(theta),0,
+				- speed_factor * v * std::sin(theta) * std::cos(inclination),
+				speed_factor * v * std::cos(theta) * std::cos(inclination),
+				speed_factor * v * std::sin(inclination)};
+
+			OC::CartState cart(cart_state,1);
+			OC::EquinoctialState equinoctial = cart.convert_to_equinoctial(0.5);
+
+			assert(equinoctial.get_state().is_finite());
+
+			OC::CartState cart_from_equinoctial = equinoctial.convert_to_cart(0.5);
+			double error = arma::norm(cart_from_equinoctial.get_state() - cart.get_state())/arma::norm(cart.get_state());
+			assert(error < 1e-10);
+		}
+
+		std::cout << "- test_equinoctial_singular_orbits() passed\n";
+
+	}
+
+	void test_batch_conversions(int N){
+
+		std::cout <<  "\n- Running test_batch_conversions... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double mu = 1.5;
+		double dt = 0.3;
+		arma::mat cart_states = arma::randn<arma::mat>(6,N);
+		arma::mat kep_states,equinoctial_states,cart_states_from_kep,cart_states_from_equinoctial;
+
+		// Near-circular LEO-like states close to their apsides, where acos(cos(f)) loses half of the digits of f
+		for (int i = 0; i < N / 4; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			arma::vec kep_state_vec = {1 + 0.1 * rands(0),1e-4 + 1e-3 * rands(1),arma::datum::pi * rands(2),
+				2 * arma::datum::pi * rands(3),2 * arma::datum::pi * rands(4),arma::datum::pi * (i % 2) + 1e-5 * (rands(5) - 0.5)};
+			cart_states.col(i) = OC::KepState(kep_state_vec,mu).convert_to_cart(0).get_state();
+		}
+
+		OC::BatchConversions::cart_to_kep(cart_states,mu,dt,kep_states);
+		OC::BatchConversions::kep_to_cart(kep_states,mu,dt,cart_states_from_kep);
+		OC::BatchConversions::cart_to_equinoctial(cart_states,mu,dt,equinoctial_states);
+		OC::BatchConversions::equinoctial_to_cart(equinoctial_states,mu,dt,cart_states_from_equinoctial);
+
+		for (int i = 0; i < N; ++i){
+
+			OC::CartState cart(cart_states.col(i),mu);
+			OC::KepState kep = cart.convert_to_kep(dt);
+			OC::EquinoctialState equinoctial = cart.convert_to_equinoctial(dt);
+
+			assert(arma::norm(equinoctial.get_state() - equinoctial_states.col(i)) < 1e-14 * arma::norm(equinoctial.get_state()));
+
+			// The mean anomaly is ill-conditioned close to the parabola, where 
+			// the batch conversions use their own path (see test_regime_dispatch)
+			if (OC::BatchConversions::get_regime(kep.get_eccentricity()) == OC::NEAR_PARABOLIC){
+				continue;
+			}
+
+			assert(arma::norm(kep.get_state() - kep_states.col(i)) < 1e-10 * arma::norm(kep.get_state()));
+
+			double error_kep = arma::norm(cart_states_from_kep.col(i) - cart.get_state()) / arma::norm(cart.get_state());
+			double error_equinoctial = arma::norm(cart_states_from_equinoctial.col(i) - cart.get_state()) / arma::norm(cart.get_state());
+			assert(error_kep < 1e-9);
+			assert(error_equinoctial < 1e-9);
+		}
+
+		std::cout << "- test_batch_conversions() passed\n";
+
+	}
+
+	void test_covariance_mapping(int N){
+
+		std::cout <<  "\n- Running test_covariance_mapping... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double mu = 1;
+		double dt = 2.5;
+
+		arma::mat kep_states(6,N);
+		OC::PackedCovariances kep_covariances(N);
+
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			kep_states(0,i) = 1 + 2 * rands(0);
+			kep_states(1,i) = 0.05 + 0.75 * rands(1);
+			kep_states(2,i) = 0.1 + 2.9 * rands(2);
+			kep_states(3,i) = 2 * arma::datum::pi * rands(3);
+			kep_states(4,i) = 2 * arma::datum::pi * rands(4);
+			kep_states(5,i) = 2 * arma::datum::pi * rands(5);
+
+			arma::mat A = arma::randn<arma::mat>(6,6);
+			kep_covariances.set(i,1e-12 * A * A.t() + 1e-14 * arma::eye<arma::mat>(6,6));
+			assert(arma::norm(kep_covariances.get(i) - (1e-12 * A * A.t() + 1e-14 * arma::eye<arma::mat>(6,6))) < 1e-26);
+		}
+
+		arma::mat cart_states,cart_states_unscented,kep_states_back,propagated_states,propagated_states_unscented,cart_states_reference;
+		OC::PackedCovariances cart_covariances,cart_covariances_unscented,kep_covariances_back,propagated_covariances,propagated_covariances_unscented;
+
+		OC::CovarianceMapping::kep_to_cart(kep_states,kep_covariances,mu,dt,cart_states,cart_covariances);
+		OC::CovarianceMapping::kep_to_cart(kep_states,kep_covariances,mu,dt,cart_states_unscented,cart_covariances_unscented,OC::UNSCENTED);
+		OC::CovarianceMapping::cart_to_kep(cart_states,cart_covariances,mu,dt,kep_states_back,kep_covariances_back);
+		OC::CovarianceMapping::propagate(cart_states,cart_covariances,mu,dt,propagated_states,propagated_covariances);
+		OC::CovarianceMapping::propagate(cart_states,cart_covariances,mu,dt,propagated_states_unscented,propagated_covariances_unscented,OC::UNSCENTED);
+		OC::BatchConversions::kep_to_cart(kep_states,mu,dt,cart_states_reference);
+
+		for (int i = 0; i < N; ++i){
+
+			assert(arma::norm(cart_states.col(i) - cart_states_reference.col(i)) < 1e-12 * arma::norm(cart_states_reference.col(i)));
+
+			// Jacobians against central finite differences
+			arma::mat J_cart(6,6),J_kep(6,6),Phi(6,6);
+			arma::vec cart(6),kep(6),propagated(6);
+			OC::CovarianceMapping::kep_to_cart_jacobian(kep_states.colptr(i),mu,dt,cart.memptr(),J_cart.memptr());
+			OC::CovarianceMapping::cart_to_kep_jacobian(cart.memptr(),mu,dt,kep.memptr(),J_kep.memptr());
+			OC::CovarianceMapping::propagation_jacobian(cart.memptr(),mu,dt,propagated.memptr(),Phi.memptr());
+
+			for (int k = 0; k < 6; ++k){
+				arma::vec dx = arma::zeros<arma::vec>(6);
+				dx(k) = 1e-6;
+
+				arma::vec plus(6),minus(6);
+				arma::vec kep_plus = kep_states.col(i) + dx;
+				arma::vec kep_minus = kep_states.col(i) - dx;
+				OC::CovarianceMapping::kep_to_cart_kernel(kep_plus.memptr(),mu,dt,plus.memptr());
+				OC::CovarianceMapping::kep_to_cart_kernel(kep_minus.memptr(),mu,dt,minus.memptr());
+				assert(arma::norm((plus - minus) / 2e-6 - J_cart.col(k)) < 1e-5 * (1 + arma::norm(J_cart.col(k))));
+
+				arma::vec cart_plus = cart + dx;
+				arma::vec cart_minus = cart - dx;
+				OC::CovarianceMapping::cart_to_kep_kernel(cart_plus.memptr(),mu,dt,plus.memptr());
+				OC::CovarianceMapping::cart_to_kep_kernel(cart_minus.memptr(),mu,dt,minus.memptr());
+				arma::vec diff = plus - minus;
+				for (int j = 3; j < 6; ++j){
+					diff(j) = std::remainder(diff(j),2 * arma::datum::pi);
+				}
+				assert(arma::norm(diff / 2e-6 - J_kep.col(k)) < 1e-5 * (1 + arma::norm(J_kep.col(k))));
+			}
+
+			assert(arma::norm(J_kep * J_cart - arma::eye<arma::mat>(6,6)) < 1e-8);
+			assert(std::abs(arma::det(Phi) - 1) < 1e-8);
+
+			// Linearized mappings
+			arma::mat P_kep = kep_covariances.get(i);
+			arma::mat P_cart = J_cart * P_kep * J_cart.t();
+			assert(arma::norm(cart_covariances.get(i) - P_cart) < 1e-12 * arma::norm(P_cart));
+			assert(arma::norm(kep_covariances_back.get(i) - P_kep) < 1e-7 * arma::norm(P_kep));
+			assert(arma::norm(propagated_covariances.get(i) - Phi * P_cart * Phi.t()) < 1e-12 * arma::norm(Phi * P_cart * Phi.t()));
+
+			// The unscented transform must agree with the linearization for small covariances
+			assert(arma::norm(cart_covariances_unscented.get(i) - P_cart) < 1e-3 * arma::norm(P_cart));
+			assert(arma::norm(propagated_covariances_unscented.get(i) - propagated_covariances.get(i)) < 1e-3 * arma::norm(propagated_covariances.get(i)));
+			// Its mean only departs from the mapped state by the second-order bias
+			assert(arma::norm(cart_states_unscented.col(i) - cart_states.col(i)) < 1e-5 * arma::norm(cart_states.col(i)));
+		}
+
+		std::cout << "- test_covariance_mapping() passed\n";
+
+	}
+
+	void test_dispersion(int N){
+
+		std::cout <<  "\n- Running test_dispersion... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double mu = 398600.4418;
+		OC::KepState nominal_kep(arma::vec({7000,0.1,0.9,0.3,1.2,2.}),mu);
+		OC::CartState nominal_cart = nominal_kep.convert_to_cart(0);
+		arma::vec times = arma::linspace<arma::vec>(0,3e4,7);
+
+		arma::mat kep_perturbations = arma::randn<arma::mat>(6,N);
+		kep_perturbations.row(0) *= 1;
+		kep_perturbations.rows(1,5) *= 1e-4;
+		arma::mat cart_perturbations = arma::randn<arma::mat>(6,N);
+		cart_perturbations.rows(0,2) *= 1e-1;
+		cart_perturbations.rows(3,5) *= 1e-4;
+
+		std::vector<OC::DispersionStatistics> kep_statistics = OC::Dispersion::propagate(nominal_kep,kep_perturbations,times,100);
+		std::vector<OC::DispersionStatistics> cart_statistics = OC::Dispersion::propagate(nominal_cart,cart_perturbations,times,100);
+
+		assert(kep_statistics.size() == times.n_rows);
+
+		for (unsigned int j = 0; j < times.n_rows; ++j){
+
+			// Statistics of the explicit sample clouds
+			arma::mat kep_cloud(6,N);
+			arma::mat cart_cloud(6,N);
+			for (int s = 0; s < N; ++s){
+				OC::KepState kep(nominal_kep.get_state() + kep_perturbations.col(s),mu);
+				OC::CartState cart(nominal_cart.get_state() + cart_perturbations.col(s),mu);
+				kep_cloud.col(s) = kep.convert_to_cart(times(j)).get_state();
+				cart_cloud.col(s) = cart.convert_to_kep(0).convert_to_cart(times(j)).get_state();
+			}
+
+			arma::vec kep_mean = arma::sum(kep_cloud,1) / N;
+			arma::vec cart_mean = arma::sum(cart_cloud,1) / N;
+			kep_cloud.each_col() -= kep_mean;
+			cart_cloud.each_col() -= cart_mean;
+			arma::mat kep_covariance = kep_cloud * kep_cloud.t() / (N - 1);
+			arma::mat cart_covariance = cart_cloud * cart_cloud.t() / (N - 1);
+
+			assert(kep_statistics[j].samples == (unsigned int)(N));
+			assert(kep_statistics[j].t == times(j));
+			assert(arma::norm(kep_statistics[j].mean - kep_mean) < 1e-10 * arma::norm(kep_mean));
+			assert(arma::norm(cart_statistics[j].mean - cart_mean) < 1e-10 * arma::norm(cart_mean));
+			assert(arma::norm(kep_statistics[j].covariance - kep_covariance) < 1e-6 * arma::norm(kep_covariance));
+			assert(arma::norm(cart_statistics[j].covariance - cart_covariance) < 1e-6 * arma::norm(cart_covariance));
+		}
+
+		std::cout << "- test_dispersion() passed\n";
+
+	}
+
+	void test_conversion_cache(int N){
+
+		std::cout <<  "\n- Running test_conversion_cache... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double mu = 1.5;
+		double dt = 0.3;
+		arma::mat cart_states = arma::randn<arma::mat>(6,N);
+
+		// Shards fill unevenly, hence the slack on the capacity
+		OC::ConversionCache cache(4 * N,8);
+
+		// Two concurrent passes: every query of the second pass must be a hit returning the exact conversion
+		for (int pass = 0; pass < 2; ++pass){
+
+			#pragma omp parallel for
+			for (int i = 0; i < N; ++i){
+				OC::CartState cart(cart_states.col(i),mu);
+				OC::KepState kep = cache.convert_to_kep(cart,dt);
+				OC::CartState cart_back = cache.convert_to_cart(kep,dt);
+
+				assert(arma::norm(kep.get_state() - cart.convert_to_kep(dt).get_state()) == 0);
+				assert(arma::norm(cart_back.get_state() - kep.convert_to_cart(dt).get_state()) == 0);
+			}
+
+		}
+
+		assert(cache.get_misses() == (unsigned long long)(2 * N));
+		assert(cache.get_hits() == (unsigned long long)(2 * N));
+		assert(cache.get_size() <= cache.get_capacity());
+
+		// Least-recently-used eviction
+		OC::ConversionCache small_cache(2,1);
+		OC::CartState A(cart_states.col(0),mu);
+		OC::CartState B(cart_states.col(1),mu);
+		OC::CartState C(cart_states.col(2),mu);
+
+		small_cache.convert_to_kep(A,dt);
+		small_cache.convert_to_kep(B,dt);
+		small_cache.convert_to_kep(A,dt);
+		small_cache.convert_to_kep(C,dt);
+		assert(small_cache.get_size() == 2);
+		assert(small_cache.get_hits() == 1);
+
+		small_cache.convert_to_kep(A,dt);
+		assert(small_cache.get_hits() == 2);
+		small_cache.convert_to_kep(B,dt);
+		assert(small_cache.get_hits() == 2);
+
+		// Queries differing by delta_T only are distinct
+		small_cache.clear();
+		small_cache.convert_to_kep(A,dt);
+		small_cache.convert_to_kep(A,std::nextafter(dt,1.));
+		assert(small_cache.get_misses() == 2);
+
+		std::cout << "- test_conversion_cache() passed\n";
+
+	}
+
+	void test_state_catalog(int N){
+
+		std::cout <<  "\n- Running test_state_catalog... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double mu = 1.5;
+		double dt = 0.3;
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			kep_states(0,i) = 1 + rands(0);
+			kep_states(1,i) = 0.9 * rands(1);
+			kep_states.submat(2,i,5,i) = arma::datum::pi * rands.subvec(2,5);
+		}
+
+		// Both layouts hold the same states, whichever layout they were loaded from
+		OC::KepCatalog soa_catalog(kep_states,mu,OC::SOA);
+		OC::KepCatalog aos_catalog(soa_catalog.get_data(),N,mu,OC::SOA,OC::AOS);
+		assert(arma::norm(soa_catalog.get_states() - kep_states) == 0);
+		assert(arma::norm(aos_catalog.get_states() - kep_states) == 0);
+		assert(aos_catalog.get_data()[6] == kep_states(0,1));
+		assert(soa_catalog.get_data()[1] == kep_states(0,1));
+
+		aos_catalog.set_layout(OC::SOA);
+		assert(aos_catalog.get_component_stride() == (unsigned int)(N));
+		assert(arma::norm(aos_catalog.get_states() - kep_states) == 0);
+
+		// Handles behave like the states they refer to
+		for (int i = 0; i < N; ++i){
+			OC::KepState kep(kep_states.col(i),mu);
+			OC::KepStateHandle handle = soa_catalog[i];
+
+			assert(handle.get_a() == kep.get_a());
+			assert(handle.get_eccentricity() == kep.get_eccentricity());
+			assert(handle.get_M0() == kep.get_M0());
+			assert(std::abs(handle.get_n() - kep.get_n()) < 1e-14);
+			assert(std::abs(handle.get_momentum() - kep.get_momentum()) < 1e-14);
+			assert(arma::norm(handle.get_state() - kep.get_state()) == 0);
+		}
+
+		// Catalog-wide conversions agree with the scalar ones
+		OC::CartCatalog cart_catalog = soa_catalog.convert_to_cart(dt);
+		OC::KepCatalog kep_catalog_back = cart_catalog.convert_to_kep(dt);
+		for (int i = 0; i < N; ++i){
+			OC::CartState cart = OC::KepState(kep_states.col(i),mu).convert_to_cart(dt);
+			OC::CartStateHandle handle = cart_catalog[i];
+
+			assert(arma::norm(handle.get_state() - cart.get_state()) / arma::norm(cart.get_state()) < 1e-10);
+			assert(std::abs(handle.get_energy() - cart.get_energy()) < 1e-10);
+			assert(std::abs(handle.get_eccentricity() - cart.get_eccentricity()) < 1e-10);
+			assert(std::abs(kep_catalog_back[i].get_a() - kep_states(0,i)) < 1e-8);
+		}
+
+		// Bulk construction from individual states
+		std::vector<OC::KepState> kep_vector;
+		for (int i = 0; i < N; ++i){
+			kep_vector.push_back(OC::KepState(kep_states.col(i),mu));
+		}
+		OC::KepCatalog vector_catalog(kep_vector,OC::AOS);
+		assert(vector_catalog.get_mu() == mu);
+		assert(arma::norm(vector_catalog.get_states() - kep_states) == 0);
+
+		std::cout << "- test_state_catalog() passed\n";
+
+	}
+
+	void test_eclipse(int N){
+
+		std::cout <<  "\n- Running test_eclipse... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		// Elliptic and hyperbolic orbits whose periapsis lies above the central body
+		std::vector<OC::KepState> catalog;
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			arma::vec kep_state_vec(6);
+			if (i % 4 == 3){
+				kep_state_vec(0) = - (2 + rands(0));
+				kep_state_vec(1) = 1.6 + 1.4 * rands(1);
+			}
+			else{
+				kep_state_vec(0) = 1.4 + 2.6 * rands(0);
+				kep_state_vec(1) = 0.25 * rands(1);
+			}
+			kep_state_vec(2) = arma::datum::pi * rands(2);
+			kep_state_vec.subvec(3,5) = 2 * arma::datum::pi * rands.subvec(3,5);
+			catalog.push_back(OC::KepState(kep_state_vec,1));
+		}
+
+		double t0 = -5;
+		double t1 = 40;
+
+		OC::ShadowGeometry geometry;
+		geometry.sun_direction = arma::normalise(arma::randn<arma::vec>(3));
+		geometry.body_radius = 1;
+		geometry.sun_radius = 109;
+		geometry.sun_distance = 23500;
+
+		// Dense sampling of the orbits must agree with the intervals away from their boundaries
+		auto check = [&](const std::vector<OC::EclipseInterval> & eclipses){
+
+			std::vector<std::vector<OC::EclipseInterval> > eclipses_per_object(N);
+			for (auto eclipse : eclipses){
+				assert(eclipse.t_entry <= eclipse.t_exit);
+				assert(eclipse.t_entry >= t0 && eclipse.t_exit <= t1);
+				eclipses_per_object[eclipse.object].push_back(eclipse);
+			}
+
+			for (int i = 0; i < N; ++i){
+				for (double t = t0; t <= t1; t += 0.01){
+
+					OC::ShadowType expected = OC::SUNLIT;
+					bool near_boundary = false;
+					for (auto eclipse : eclipses_per_object[i]){
+						near_boundary = near_boundary || std::abs(t - eclipse.t_entry) < 1e-6 || std::abs(t - eclipse.t_exit) < 1e-6;
+						if (t >= eclipse.t_entry && t <= eclipse.t_exit){
+							expected = std::max(expected,eclipse.type);
+						}
+					}
+
+					arma::vec cart_state = catalog[i].convert_to_cart(t).get_state();
+					assert(near_boundary || OC::Eclipse::get_shadow(cart_state.memptr(),geometry) == expected);
+				}
+			}
+
+		};
+
+		geometry.model = OC::CONICAL;
+		std::vector<OC::EclipseInterval> eclipses = OC::Eclipse::find_eclipses(catalog,geometry,t0,t1);
+		check(eclipses);
+
+		// Umbra intervals are nested in penumbra intervals, and the boundaries are resolved to well below the sampling step
+		unsigned int umbra_count = 0;
+		for (auto eclipse : eclipses){
+			if (eclipse.type == OC::PENUMBRA){
+				continue;
+			}
+			++umbra_count;
+			bool nested = false;
+			for (auto other : eclipses){
+				nested = nested || (other.object == eclipse.object && other.type == OC::PENUMBRA 
+					&& other.t_entry <= eclipse.t_entry && other.t_exit >= eclipse.t_exit);
+			}
+			assert(nested);
+
+			if (eclipse.t_entry > t0){
+				arma::vec before = catalog[eclipse.object].convert_to_cart(eclipse.t_entry - 1e-7).get_state();
+				arma::vec after = catalog[eclipse.object].convert_to_cart(eclipse.t_entry + 1e-7).get_state();
+				assert(OC::Eclipse::get_shadow(before.memptr(),geometry) == OC::PENUMBRA);
+				assert(OC::Eclipse::get_shadow(after.memptr(),geometry) == OC::UMBRA);
+			}
+		}
+		assert(umbra_count > 0);
+
+		// Cylindrical model, through a state catalog
+		geometry.model = OC::CYLINDRICAL;
+		std::vector<OC::EclipseInterval> cylindrical_eclipses = OC::Eclipse::find_eclipses(OC::KepCatalog(catalog),geometry,t0,t1);
+		for (auto eclipse : cylindrical_eclipses){
+			assert(eclipse.type == OC::UMBRA);
+		}
+		check(cylindrical_eclipses);
+
+		std::cout << "- test_eclipse() passed\n";
+
+	}
+
+	void test_conversion_service(int N){
+
+		std::cout <<  "\n- Running test_conversion_service... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		// Requests of 1 to 4 states, alternating conversions and gravitational parameters
+		std::vector<arma::mat> inputs(N);
+		std::vector<arma::mat> expected(N);
+		for (int i = 0; i < N; ++i){
+			double mu = 1 + i % 2;
+			inputs[i] = arma::randn<arma::mat>(6,1 + i % 4);
+			if (i % 3 == 0){
+				arma::mat kep_states;
+				OC::BatchConversions::cart_to_kep(inputs[i],mu,0.1,kep_states);
+				inputs[i] = kep_states;
+				OC::BatchConversions::kep_to_cart(inputs[i],mu,0.1,expected[i]);
+			}
+			else{
+				OC::BatchConversions::cart_to_kep(inputs[i],mu,0.1,expected[i]);
+			}
+		}
+
+		// Concurrent producers, half of the requests completing futures and the other half callbacks
+		std::vector<arma::mat> results(N);
+		{
+			OC::ConversionService service;
+			std::vector<std::thread> producers;
+			unsigned int n_producers = 4;
+
+			for (unsigned int p = 0; p < n_producers; ++p){
+				producers.push_back(std::thread([&,p](){
+					std::vector<std::pair<int,std::future<arma::mat> > > futures;
+					for (int i = p; i < N; i += n_producers){
+						OC::ConversionService::RequestType type = i % 3 == 0 ? OC::ConversionService::KEP_TO_CART : OC::ConversionService::CART_TO_KEP;
+						if (i % 2 == 0){
+							futures.push_back(std::make_pair(i,service.submit(type,inputs[i],1 + i % 2,0.1)));
+						}
+						else{
+							service.submit(type,inputs[i],1 + i % 2,0.1,[&results,i](const arma::mat & result){
+								results[i] = result;
+							});
+						}
+					}
+					for (auto & future : futures){
+						results[future.first] = future.second.get();
+					}
+				}));
+			}
+
+			for (auto & producer : producers){
+				producer.join();
+			}
+			service.stop();
+
+			assert(service.get_requests() == (unsigned long long)(N));
+			assert(service.get_batches() <= (unsigned long long)(N));
+		}
+
+		// The kernels are applied column-wise, so coalescing does not change the results
+		for (int i = 0; i < N; ++i){
+			assert(results[i].n_cols == expected[i].n_cols);
+			assert(arma::norm(results[i] - expected[i]) == 0);
+		}
+
+		// Requests submitted within the latency budget are coalesced up to max_batch_size states
+		OC::ServiceSettings settings;
+		settings.latency_budget = 1;
+		settings.max_batch_size = 100;
+		OC::ConversionService service(settings);
+		std::vector<std::future<arma::mat> > futures;
+		for (int i = 0; i < 100; ++i){
+			futures.push_back(service.submit(OC::ConversionService::CART_TO_KEP,inputs[4 * i + 1].col(0),2,0.1));
+		}
+		for (auto & future : futures){
+			future.wait();
+		}
+		assert(service.get_batches() == 1);
+
+		// Malformed states are rejected at submission
+		bool rejected = false;
+		try{
+			service.submit(OC::ConversionService::CART_TO_KEP,inputs[1].rows(0,2),2,0.1);
+		}
+		catch (const std::invalid_argument &){
+			rejected = true;
+		}
+		assert(rejected);
+		assert(service.get_batches() == 1);
+
+		// A throwing callback is reported without stopping the worker
+		assert(service.get_callback_exception() == nullptr);
+		service.submit(OC::ConversionService::CART_TO_KEP,inputs[1],2,0.1,[](const arma::mat &){
+			throw std::runtime_error("callback failure");
+		});
+		std::future<arma::mat> future = service.submit(OC::ConversionService::CART_TO_KEP,inputs[1],2,0.1);
+		assert(arma::norm(future.get() - expected[1]) == 0);
+		assert(service.get_callback_exception() != nullptr);
+
+		rejected = false;
+		try{
+			std::rethrow_exception(service.get_callback_exception());
+		}
+		catch (const std::runtime_error & error){
+			rejected = std::string(error.what()) == "callback failure";
+		}
+		assert(rejected);
+
+		// Requests submitted once the service is stopped are rejected instead of never completing
+		service.stop();
+		rejected = false;
+		try{
+			service.submit(OC::ConversionService::CART_TO_KEP,inputs[1],2,0.1);
+		}
+		catch (const std::logic_error &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		rejected = false;
+		try{
+			service.submit(OC::ConversionService::CART_TO_KEP,inputs[1],2,0.1,[](const arma::mat &){});
+		}
+		catch (const std::logic_error &){
+			rejected = true;
+		}
+		assert(rejected);
+
+		std::cout << "- test_conversion_service() passed\n";
+
+	}
+
+	void test_mean_elements(int N){
+
+		std::cout <<  "\n- Running test_mean_elements... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double J2 = 1.0826e-3;
+		double R = 1;
+
+		// Low orbits away from the critical inclinations and from the equator
+		arma::mat mean_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			mean_states(0,i) = 1.1 + 0.5 * rands(0);
+			mean_states(1,i) = 0.01 + 0.09 * rands(1);
+			mean_states(2,i) = i % 2 == 0 ? 0.3 + 0.5 * rands(2) : 1.3 + 0.5 * rands(2);
+			mean_states.submat(3,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,5);
+		}
+
+		// The fixed-point inverse closes the round trip, and the batch and scalar forms agree
+		arma::mat osculating_states,mean_states_back;
+		OC::MeanElements::mean_to_osculating(mean_states,J2,R,osculating_states);
+		OC::MeanElements::osculating_to_mean(osculating_states,J2,R,mean_states_back);
+
+		for (int i = 0; i < N; ++i){
+			arma::vec error = mean_states_back.col(i) - mean_states.col(i);
+			for (unsigned int k = 3; k < 6; ++k){
+				error(k) = std::remainder(error(k),2 * arma::datum::pi);
+			}
+			assert(arma::abs(error).max() < 1e-10);
+
+			OC::KepState osculating = OC::MeanElements::mean_to_osculating(OC::KepState(mean_states.col(i),1),J2,R);
+			assert(arma::norm(osculating.get_state() - osculating_states.col(i)) == 0);
+		}
+
+		// Prograde and retrograde equatorial orbits (e.g GEO) are regular
+		for (double inclination : {0.,arma::datum::pi}){
+			double mean_state[6] = {6.6,1e-3,inclination,1,2,3};
+			double osculating_state[6],mean_state_back[6];
+			OC::MeanElements::mean_to_osculating_kernel(mean_state,J2,R,osculating_state);
+			assert(OC::MeanElements::osculating_to_mean_kernel(osculating_state,J2,R,mean_state_back));
+			for (unsigned int k = 0; k < 6; ++k){
+				assert(std::isfinite(osculating_state[k]) && std::isfinite(mean_state_back[k]));
+			}
+			assert(std::abs(osculating_state[2] - inclination) < 1e-6);
+
+			// The nonsingular variables only keep sqrt(eps) of the inclination at i = pi
+			assert(std::abs(mean_state_back[2] - inclination) < (inclination == 0 ? 1e-12 : 1e-6));
+			double longitude_error = std::remainder(mean_state_back[3] + mean_state_back[4] + mean_state_back[5] - 6,2 * arma::datum::pi);
+			assert(std::abs(longitude_error) < 1e-10);
+		}
+
+		// States at the critical inclination are refused rather than mapped to spurious mean elements
+		double critical_state[6] = {1.2,0.05,std::acos(1 / std::sqrt(5)) + 1e-7,1,2,3};
+		double critical_mean[6];
+		assert(!OC::MeanElements::osculating_to_mean_kernel(critical_state,J2,R,critical_mean));
+		assert(std::isnan(critical_mean[1]));
+
+		// Secularly propagated mean elements follow a numerically integrated J2 trajectory 
+		// much more closely than the osculating Keplerian orbit
+		auto derivative = [J2,R](const arma::vec & x){
+			double r2 = x(0) * x(0) + x(1) * x(1) + x(2) * x(2);
+			double r = std::sqrt(r2);
+			double z2 = x(2) * x(2) / r2;
+			double k = - 1.5 * J2 * R * R / (r2 * r2 * r);
+			arma::vec x_dot(6);
+			x_dot.subvec(0,2) = x.subvec(3,5);
+			x_dot(3) = - x(0) / (r2 * r) + k * x(0) * (1 - 5 * z2);
+			x_dot(4) = - x(1) / (r2 * r) + k * x(1) * (1 - 5 * z2);
+			x_dot(5) = - x(2) / (r2 * r) + k * x(2) * (3 - 5 * z2);
+			return x_dot;
+		};
+
+		for (int i = 0; i < 4; ++i){
+
+			OC::KepState mean(mean_states.col(i),1);
+			OC::KepState osculating(osculating_states.col(i),1);
+
+			double duration = 3 * 2 * arma::datum::pi / mean.get_n();
+			unsigned int steps = 4000;
+			double h = duration / steps;
+
+			arma::vec x = osculating.convert_to_cart(0).get_state();
+			for (unsigned int s = 0; s < steps; ++s){
+				arma::vec k1 = derivative(x);
+				arma::vec k2 = derivative(x + h / 2 * k1);
+				arma::vec k3 = derivative(x + h / 2 * k2);
+				arma::vec k4 = derivative(x + h * k3);
+				x += h / 6 * (k1 + 2 * k2 + 2 * k3 + k4);
+			}
+
+			OC::KepState mean_propagated = OC::MeanElements::propagate_mean(mean,J2,R,duration);
+			arma::vec x_mean = OC::MeanElements::mean_to_osculating(mean_propagated,J2,R).convert_to_cart(0).get_state();
+			arma::vec x_kepler = osculating.convert_to_cart(duration).get_state();
+
+			double error_mean = arma::norm(x.subvec(0,2) - x_mean.subvec(0,2));
+			double error_kepler = arma::norm(x.subvec(0,2) - x_kepler.subvec(0,2));
+
+			assert(error_mean < 1e-3);
+			assert(error_mean < 0.05 * error_kepler);
+		}
+
+		std::cout << "- test_mean_elements() passed\n";
+
+	}
+
+	void test_snapshot_codec(int N){
+
+		std::cout <<  "\n- Running test_snapshot_codec... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		double J2 = 1.0826e-3;
+		double R = 1;
+		unsigned int snapshots = 12;
+		double dt = 0.1;
+
+		// J2-perturbed trajectories, so that Kepler predictions are good but not exact
+		arma::mat mean_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			mean_states(0,i) = 1.1 + 0.9 * rands(0);
+			mean_states(1,i) = 0.01 + 0.19 * rands(1);
+			mean_states(2,i) = 0.3 + 1.2 * rands(2);
+			mean_states.submat(3,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,5);
+		}
+
+		std::vector<arma::mat> kep_snapshots(snapshots);
+		std::vector<arma::mat> cart_snapshots(snapshots);
+		for (unsigned int s = 0; s < snapshots; ++s){
+			arma::mat mean_propagated(6,N);
+			for (int i = 0; i < N; ++i){
+				mean_propagated.col(i) = OC::MeanElements::propagate_mean(OC::KepState(mean_states.col(i),1),J2,R,s * dt).get_state();
+			}
+			OC::MeanElements::mean_to_osculating(mean_propagated,J2,R,kep_snapshots[s]);
+			OC::BatchConversions::kep_to_cart(kep_snapshots[s],1,0,cart_snapshots[s]);
+			for (int i = 0; i < N; ++i){
+				for (unsigned int k = 3; k < 6; ++k){
+					kep_snapshots[s](k,i) = std::remainder(kep_snapshots[s](k,i),2 * arma::datum::pi);
+				}
+			}
+		}
+
+		OC::SnapshotPrediction predictions[3] = {OC::INTRA_PREDICTION,OC::PREVIOUS_PREDICTION,OC::KEPLER_PREDICTION};
+		OC::SnapshotType types[2] = {OC::CARTESIAN_SNAPSHOT,OC::KEPLERIAN_SNAPSHOT};
+		size_t sizes[2][3];
+
+		for (unsigned int t = 0; t < 2; ++t){
+			for (unsigned int p = 0; p < 3; ++p){
+
+				OC::SnapshotSettings settings;
+				settings.type = types[t];
+				settings.prediction = predictions[p];
+				settings.keyframe_interval = 5;
+				if (types[t] == OC::KEPLERIAN_SNAPSHOT){
+					std::fill(settings.quantum + 2,settings.quantum + 6,1e-8);
+				}
+
+				const std::vector<arma::mat> & truth = types[t] == OC::CARTESIAN_SNAPSHOT ? cart_snapshots : kep_snapshots;
+
+				OC::SnapshotEncoder encoder(1,settings);
+				std::vector<unsigned char> bytes;
+				std::vector<size_t> offsets;
+				std::vector<arma::mat> reconstructed;
+				for (unsigned int s = 0; s < snapshots; ++s){
+					offsets.push_back(bytes.size());
+					encoder.encode(truth[s],s * dt,bytes);
+					reconstructed.push_back(encoder.get_states());
+				}
+				sizes[t][p] = bytes.size();
+
+				// The stream is received in small chunks
+				OC::SnapshotDecoder decoder;
+				std::vector<unsigned char> received;
+				size_t sent = 0;
+				unsigned int decoded = 0;
+				while (decoded < snapshots){
+
+					size_t consumed = decoder.decode(received.data(),received.size());
+					if (consumed == 0){
+						assert(sent < bytes.size());
+						size_t chunk = std::min<size_t>(997,bytes.size() - sent);
+						received.insert(received.end(),bytes.begin() + sent,bytes.begin() + sent + chunk);
+						sent += chunk;
+						continue;
+					}
+					received.erase(received.begin(),received.begin() + consumed);
+
+					// The decoder reconstructs exactly what the encoder predicts from, within half a step of the truth
+					assert(decoder.get_time() == decoded * dt);
+					assert(arma::abs(decoder.get_states() - reconstructed[decoded]).max() == 0);
+					for (int i = 0; i < N; ++i){
+						for (unsigned int k = 0; k < 6; ++k){
+							double error = decoder.get_states()(k,i) - truth[decoded](k,i);
+							if (types[t] == OC::KEPLERIAN_SNAPSHOT && k > 2){
+								error = std::remainder(error,2 * arma::datum::pi);
+							}
+							assert(std::abs(error) <= 0.5 * settings.quantum[k] * (1 + 1e-6));
+						}
+					}
+					++decoded;
+				}
+
+				// A decoder joining mid-stream skips predicted snapshots until the next keyframe
+				if (predictions[p] != OC::INTRA_PREDICTION){
+					OC::SnapshotDecoder late_decoder;
+					size_t offset = offsets[2];
+					for (unsigned int s = 2; s < 5; ++s){
+						offset += late_decoder.decode(bytes.data() + offset,bytes.size() - offset);
+						assert(late_decoder.get_states().n_cols == 0);
+					}
+					offset += late_decoder.decode(bytes.data() + offset,bytes.size() - offset);
+					assert(arma::abs(late_decoder.get_states() - reconstructed[5]).max() == 0);
+				}
+
+			}
+
+			std::cout << "\t" << (types[t] == OC::CARTESIAN_SNAPSHOT ? "Cartesian" : "Keplerian") 
+			<< " snapshots: " << double(sizes[t][0]) / (N * snapshots) << " (intra), " 
+			<< double(sizes[t][1]) / (N * snapshots) << " (previous), " 
+			<< double(sizes[t][2]) / (N * snapshots) << " (Kepler) bytes/state\n";
+
+			assert(sizes[t][2] < sizes[t][1]);
+			assert(sizes[t][1] < sizes[t][0]);
+			assert(sizes[t][0] < 6 * sizeof(double) * N * snapshots);
+		}
+
+		// Without periodic keyframes, a decoder joining mid-stream waits for the number of objects to change
+		OC::SnapshotSettings settings;
+		settings.prediction = OC::PREVIOUS_PREDICTION;
+		settings.keyframe_interval = 0;
+
+		OC::SnapshotEncoder encoder(1,settings);
+		std::vector<unsigned char> bytes;
+		size_t offset = 0;
+		for (unsigned int s = 0; s < snapshots; ++s){
+			if (s == 2){
+				offset = bytes.size();
+			}
+			encoder.encode(s + 1 < snapshots ? cart_snapshots[s] : arma::mat(cart_snapshots[s].cols(0,N - 2)),s * dt,bytes);
+		}
+
+		OC::SnapshotDecoder late_decoder;
+		for (unsigned int s = 2; s + 1 < snapshots; ++s){
+			offset += late_decoder.decode(bytes.data() + offset,bytes.size() - offset);
+			assert(late_decoder.get_states().n_cols == 0);
+		}
+		offset += late_decoder.decode(bytes.data() + offset,bytes.size() - offset);
+		assert(offset == bytes.size());
+		assert(arma::abs(late_decoder.get_states() - encoder.get_states()).max() == 0);
+
+		std::cout << "- test_snapshot_codec() passed\n";
+
+	}
+
+	void test_incremental_catalog(int N){
+
+		std::cout <<  "\n- Running test_incremental_catalog... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		// Elliptic orbits with a few hyperbolic ones
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			if (i % 10 == 0){
+				kep_states(0,i) = - 1 - rands(0);
+				kep_states(1,i) = 1.1 + rands(1);
+			}
+			else{
+				kep_states(0,i) = 1.1 + 3 * rands(0);
+				kep_states(1,i) = 0.5 * rands(1);
+			}
+			kep_states(2,i) = arma::datum::pi * rands(2);
+			kep_states.submat(3,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,5);
+		}
+
+		arma::mat cart_states;
+		OC::BatchConversions::kep_to_cart(kep_states,1,0,cart_states);
+
+		std::vector<double> shell_radii = {1.2,1.5,2,3,5};
+		OC::IncrementalCatalog catalog(cart_states,1,shell_radii);
+		assert(catalog.get_dirty_count() == 0);
+
+		for (unsigned int cycle = 0; cycle < 3; ++cycle){
+
+			// A few objects receive new states, some of them several times
+			unsigned int updates = 0;
+			for (int u = 0; u < N / 20; ++u){
+				unsigned int i = std::min(N - 1,int(N * arma::randu<arma::vec>(1)(0)));
+				arma::vec rands = arma::randu<arma::vec>(6);
+				cart_states.col(i) = cart_states.col(i) % (0.8 + 0.4 * rands);
+				catalog.update(i,cart_states.colptr(i));
+				++updates;
+			}
+			unsigned int dirty = catalog.get_dirty_count();
+			assert(dirty > 0 && dirty <= updates);
+			assert(catalog.refresh() == dirty);
+			assert(catalog.get_dirty_count() == 0);
+			assert(catalog.refresh() == 0);
+
+			// The incremental state matches a full reconversion exactly
+			arma::mat kep_reference;
+			OC::BatchConversions::cart_to_kep(cart_states,1,0,kep_reference);
+			assert(arma::abs(catalog.get_kep_catalog().get_states() - kep_reference).max() == 0);
+			assert(arma::abs(catalog.get_cart_catalog().get_states() - cart_states).max() == 0);
+
+			unsigned int perigee_members = 0;
+			unsigned int apogee_members = 0;
+			for (unsigned int s = 0; s <= shell_radii.size(); ++s){
+				perigee_members += catalog.get_perigee_shells().get_members(s).size();
+				apogee_members += catalog.get_apogee_shells().get_members(s).size();
+				for (unsigned int i : catalog.get_perigee_shells().get_members(s)){
+					assert(catalog.get_perigee_shells().get_part(i) == s);
+				}
+			}
+			assert(perigee_members == (unsigned int)(N));
+			assert(apogee_members == (unsigned int)(N));
+
+			for (int i = 0; i < N; ++i){
+
+				OC::KepStateHandle kep = catalog.get_kep_catalog()[i];
+				double e = kep.get_eccentricity();
+				double r_p = kep.get_a() * (1 - e);
+				double r_a = e < 1 ? kep.get_a() * (1 + e) : arma::datum::inf;
+
+				assert(catalog.get_a(i) == kep.get_a());
+				assert(catalog.get_n(i) == kep.get_n());
+				assert(catalog.get_parameter(i) == kep.get_parameter());
+				assert(catalog.get_energy(i) == kep.get_energy());
+				assert(catalog.get_perigee_radius(i) == r_p);
+				assert(catalog.get_apogee_radius(i) == r_a);
+
+				unsigned int perigee_shell = std::upper_bound(shell_radii.begin(),shell_radii.end(),r_p) - shell_radii.begin();
+				unsigned int apogee_shell = std::upper_bound(shell_radii.begin(),shell_radii.end(),r_a) - shell_radii.begin();
+				assert(catalog.get_perigee_shells().get_part(i) == perigee_shell);
+				assert(catalog.get_apogee_shells().get_part(i) == apogee_shell);
+				assert(catalog.get_regimes().get_part(i) == OC::BatchConversions::get_regime(e));
+
+			}
+
+		}
+
+		std::cout << "- test_incremental_catalog() passed\n";
+
+	}
+
+	void test_arc_bounds(int N){
+
+		std::cout <<  "\n- Running test_arc_bounds... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		std::vector<OC::KepState> catalog;
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			arma::vec kep_state(6);
+			if (i % 5 == 0){
+				kep_state(0) = - 1 - rands(0);
+				kep_state(1) = 1.1 + rands(1);
+			}
+			else{
+				kep_state(0) = 1.1 + rands(0);
+				kep_state(1) = 0.3 * rands(1);
+			}
+			kep_state(2) = arma::datum::pi * rands(2);
+			kep_state.subvec(3,5) = 2 * arma::datum::pi * rands.subvec(3,5);
+			catalog.push_back(OC::KepState(kep_state,1));
+		}
+
+		// Short arcs, arcs of a few revolutions, and arcs ending before they start
+		double windows[3][2] = {{0.5,1.5},{-3,20},{4,2}};
+
+		for (unsigned int w = 0; w < 3; ++w){
+
+			double t0 = windows[w][0];
+			double t1 = windows[w][1];
+
+			for (int i = 0; i < std::min(N,200); ++i){
+
+				OC::ArcBox box = OC::ArcBounds::get_box(catalog[i],t0,t1);
+				OC::ArcShell shell = OC::ArcBounds::get_shell(catalog[i],t0,t1);
+
+				// Every sampled position is inside the bounds, and the bounds are reached to within the sampling error
+				unsigned int samples = 2000;
+				arma::vec::fixed<3> sampled_min,sampled_max;
+				double sampled_r_min = arma::datum::inf;
+				double sampled_r_max = 0;
+				double max_step = 0;
+				arma::vec::fixed<3> previous;
+
+				for (unsigned int s = 0; s <= samples; ++s){
+					double t = t0 + (t1 - t0) * s / samples;
+					arma::vec::fixed<3> pos = catalog[i].convert_to_cart(t).get_position_vector();
+					double r = arma::norm(pos);
+					for (unsigned int k = 0; k < 3; ++k){
+						assert(pos(k) >= box.min[k] - 1e-10 && pos(k) <= box.max[k] + 1e-10);
+						sampled_min(k) = s == 0 ? pos(k) : std::min(sampled_min(k),pos(k));
+						sampled_max(k) = s == 0 ? pos(k) : std::max(sampled_max(k),pos(k));
+					}
+					assert(r >= shell.r_min - 1e-10 && r <= shell.r_max + 1e-10);
+					sampled_r_min = std::min(sampled_r_min,r);
+					sampled_r_max = std::max(sampled_r_max,r);
+					if (s > 0){
+						max_step = std::max(max_step,arma::norm(pos - previous));
+					}
+					previous = pos;
+				}
+
+				for (unsigned int k = 0; k < 3; ++k){
+					assert(sampled_min(k) - box.min[k] < max_step + 1e-10);
+					assert(box.max[k] - sampled_max(k) < max_step + 1e-10);
+				}
+				assert(sampled_r_min - shell.r_min < max_step + 1e-10);
+				assert(shell.r_max - sampled_r_max < max_step + 1e-10);
+
+			}
+
+		}
+
+		// The hierarchy returns the same candidates as a brute-force pass
+		double t0 = 0;
+		double t1 = 0.3;
+		double distance = 0.05;
+		OC::ArcBVH bvh(catalog,t0,t1,3);
+		OC::ArcBVH bvh_catalog(OC::KepCatalog(catalog),t0,t1);
+
+		std::vector<std::pair<unsigned int,unsigned int> > pairs = bvh.find_overlapping_pairs(distance);
+		std::vector<std::pair<unsigned int,unsigned int> > brute_force_pairs;
+		for (int i = 0; i < N; ++i){
+			for (int j = i + 1; j < N; ++j){
+				if (bvh.get_box(i).overlaps(bvh.get_box(j),distance) && bvh.get_shell(i).overlaps(bvh.get_shell(j),distance)){
+					brute_force_pairs.push_back(std::make_pair(i,j));
+				}
+			}
+		}
+		assert(pairs == brute_force_pairs);
+		assert(bvh_catalog.find_overlapping_pairs(distance) == brute_force_pairs);
+		assert(pairs.size() > 0 && pairs.size() < (unsigned int)(N * (N - 1) / 2));
+
+		for (int i = 0; i < N; i += 10){
+			std::vector<unsigned int> overlapping = bvh.query(bvh.get_box(i),distance);
+			std::vector<unsigned int> brute_force;
+			for (int j = 0; j < N; ++j){
+				if (bvh.get_box(j).overlaps(bvh.get_box(i),distance)){
+					brute_force.push_back(j);
+				}
+			}
+			assert(overlapping == brute_force);
+		}
+
+		// Discarded pairs never come within the distance
+		unsigned int checked = 0;
+		for (int i = 0; i < N && checked < 200; ++i){
+			for (int j = i + 1; j < N && checked < 200; ++j){
+				if (std::binary_search(pairs.begin(),pairs.end(),std::make_pair((unsigned int)(i),(unsigned int)(j)))){
+					continue;
+				}
+				for (unsigned int s = 0; s <= 100; ++s){
+					double t = t0 + (t1 - t0) * s / 100;
+					double separation = arma::norm(catalog[i].convert_to_cart(t).get_position_vector() - catalog[j].convert_to_cart(t).get_position_vector());
+					assert(separation > distance);
+				}
+				++checked;
+			}
+		}
+
+		std::cout << "\t" << pairs.size() << " candidate pairs out of " << N * (N - 1) / 2 << "\n";
+		std::cout << "- test_arc_bounds() passed\n";
+
+	}
+
+	void test_masked_conversions(int N){
+
+		std::cout <<  "\n- Running test_masked_conversions... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		// Elliptic, near-parabolic and hyperbolic orbits
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(6);
+			double e = i % 3 == 0 ? 0.9 * rands(1) : (i % 3 == 1 ? 0.995 + 0.01 * rands(1) : 1.1 + rands(1));
+			kep_states(1,i) = e;
+			kep_states(0,i) = (1 + rands(0)) / std::abs(1 - e);
+			if (e > 1){
+				kep_states(0,i) *= -1;
+			}
+			kep_states(2,i) = arma::datum::pi * rands(2);
+			kep_states.submat(3,i,5,i) = 2 * arma::datum::pi * rands.subvec(3,5) - arma::datum::pi;
+		}
+
+		// Packed outputs are the requested rows of the full conversions
+		auto check = [](const arma::mat & packed,const arma::mat & full,unsigned int mask,unsigned int rows_per_output){
+			unsigned int row = 0;
+			for (unsigned int k = 0; k < full.n_rows; ++k){
+				if (mask & (1u << (k / rows_per_output))){
+					for (unsigned int i = 0; i < full.n_cols; ++i){
+						assert(packed(row,i) == full(k,i));
+					}
+					++row;
+				}
+			}
+			assert(row == packed.n_rows);
+		};
+
+		arma::mat cart_states,kep_states_back,packed;
+		OC::BatchConversions::kep_to_cart(kep_states,1,0.3,cart_states);
+		OC::BatchConversions::cart_to_kep(cart_states,1,0.3,kep_states_back);
+
+		OC::MaskedConversions::kep_to_cart<OC::CART_POSITION>(kep_states,1,0.3,packed);
+		check(packed,cart_states,OC::CART_POSITION,3);
+		OC::MaskedConversions::kep_to_cart<OC::CART_VELOCITY>(kep_states,1,0.3,packed);
+		check(packed,cart_states,OC::CART_VELOCITY,3);
+		OC::MaskedConversions::kep_to_cart<OC::CART_ALL>(kep_states,1,0.3,packed);
+		check(packed,cart_states,OC::CART_ALL,3);
+
+		OC::MaskedConversions::cart_to_kep<OC::KEP_A>(cart_states,1,0.3,packed);
+		check(packed,kep_states_back,OC::KEP_A,1);
+		OC::MaskedConversions::cart_to_kep<OC::KEP_SHAPE>(cart_states,1,0.3,packed);
+		check(packed,kep_states_back,OC::KEP_SHAPE,1);
+		OC::MaskedConversions::cart_to_kep<OC::KEP_M0>(cart_states,1,0.3,packed);
+		check(packed,kep_states_back,OC::KEP_M0,1);
+		OC::MaskedConversions::cart_to_kep<OC::KEP_OMEGA_NODE | OC::KEP_OMEGA_PERIAPSIS>(cart_states,1,0.3,packed);
+		check(packed,kep_states_back,OC::KEP_OMEGA_NODE | OC::KEP_OMEGA_PERIAPSIS,1);
+		OC::MaskedConversions::cart_to_kep<OC::KEP_ALL>(cart_states,1,0.3,packed);
+		check(packed,kep_states_back,OC::KEP_ALL,1);
+
+		// The scalar variants agree with the scalar conversions
+		for (int i = 0; i < N; i += 3){
+			OC::KepState kep(kep_states.col(i),1);
+			arma::vec pos = OC::MaskedConversions::convert_to_cart<OC::CART_POSITION>(kep,0.3);
+			OC::CartState cart = kep.convert_to_cart(0.3);
+			assert(pos.n_rows == 3);
+			assert(arma::norm(pos - cart.get_position_vector()) / arma::norm(pos) < 1e-8);
+
+			arma::vec shape = OC::MaskedConversions::convert_to_kep<OC::KEP_SHAPE>(cart,0.3);
+			arma::vec kep_back = cart.convert_to_kep(0.3).get_state();
+			assert(shape.n_rows == 3);
+			assert(std::abs(shape(0) - kep_back(0)) / std::abs(kep_back(0)) < 1e-8);
+			assert(arma::abs(shape.subvec(1,2) - kep_back.subvec(1,2)).max() < 1e-8);
+		}
+
+		std::cout << "- test_masked_conversions() passed\n";
+
+	}
+
+	void test_solver_policy(int N){
+
+		std::cout <<  "\n- Running test_solver_policy... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		OC::SolverPolicy default_policy = OC::SolverPolicy::default_policy();
+		OC::SolverPolicy fast_policy = OC::SolverPolicy::fast_policy();
+		OC::SolverPolicy precise_policy = OC::SolverPolicy::precise_policy();
+
+		assert(default_policy.tolerance == 1e-13);
+		assert(default_policy.step_tolerance == 1e-12);
+		assert(default_policy.zero_tolerance == 1e-10);
+		assert(default_policy.max_iterations == 1000);
+		assert(default_policy.max_step == 0.1);
+		assert(default_policy.failure_mode == OC::WARN_ON_FAILURE);
+
+		for (int i = 0; i < N; ++i){
+
+			arma::vec rands = arma::randu<arma::vec>(4);
+			double e = 0.99 * rands(0);
+			double ecc = arma::datum::pi * (2 * rands(1) - 1);
+			double M = OC::State::M_from_ecc(ecc,e);
+
+			assert(OC::State::ecc_from_M(M,e,default_policy) == OC::State::ecc_from_M(M,e));
+			assert(std::abs(OC::State::ecc_from_M(M,e,fast_policy) - ecc) < 1e-8 / (1 - e));
+			assert(std::abs(OC::State::ecc_from_M(M,e,precise_policy) - ecc) < 1e-14);
+
+			double e_hyperbolic = 1.01 + 5 * rands(2);
+			double H = 10 * rands(3) - 5;
+			double M_hyperbolic = OC::State::M_from_H(H,e_hyperbolic);
+
+			assert(OC::State::H_from_M(M_hyperbolic,e_hyperbolic,default_policy) == OC::State::H_from_M(M_hyperbolic,e_hyperbolic));
+			assert(std::abs(OC::State::H_from_M(M_hyperbolic,e_hyperbolic,fast_policy) - H) < 1e-8 * (1 + std::abs(H)) / (e_hyperbolic - 1));
+			assert(std::abs(OC::State::H_from_M(M_hyperbolic,e_hyperbolic,precise_policy) - H) < 1e-14 * (1 + std::abs(H)));
+		}
+
+		// Failure behavior
+		OC::SolverPolicy capped_policy = default_policy;
+		capped_policy.max_iterations = 1;
+		capped_policy.failure_mode = OC::NAN_ON_FAILURE;
+		assert(std::isnan(OC::State::ecc_from_M(3,0.9,capped_policy)));
+		assert(std::isnan(OC::State::H_from_M(100,1.5,capped_policy)));
+
+		std::cout << "- test_solver_policy() passed\n";
+
+	}
+
+	void test_regime_dispatch(int N){
+
+		std::cout <<  "\n- Running test_regime_dispatch... \n" ;
+
+		arma::arma_rng::set_seed(N);
+
+		// Mixed batch: a third elliptic, a third near-parabolic (1e-8 < |e - 1| < 1e-2) and a third hyperbolic,
+		// with periapsis radii in [1,2] and anomalies within a few periapsis passage times
+		arma::mat kep_states(6,N);
+		for (int i = 0; i < N; ++i){
+			arma::vec rands = arma::randu<arma::vec>(7);
+			double e;
+			if (i % 3 == 0){
+				e = 0.98 * rands(0);
+			}
+			else if (i % 3 == 1){
+				e = 1 + (rands(1) < 0.5 ? -1 : 1) * std::pow(10,-8 + 5.9 * rands(0));
+			}
+			else{
+				e = 1.02 + 3 * rands(0);
+			}
+
+			double q = 1 + rands(2);
+			kep_states(0,i) = q / (1 - e);
+			kep_states(1,i) = e;
+			kep_states(2,i) = arma::datum::pi * rands(3);
+			kep_states(3,i) = 2 * arma::datum::pi * rands(4);
+			kep_states(4,i) = 2 * arma::datum::pi * rands(5);
+			kep_states(5,i) = 20 * (rands(6) - 0.5) * std::pow(std::abs(1 - e),1.5);
+		}
+
+		std::vector<std::vector<unsigned int> > partitions;
+		OC::BatchConversions::partition_by_regime(kep_states,1,partitions);
+
+		assert(partitions.size() == 3);
+		assert(partitions[OC::ELLIPTIC].size() + partitions[OC::NEAR_PARABOLIC].size() + partitions[OC::HYPERBOLIC].size() == (unsigned int)(N));
+		for (unsigned int r = 0; r < 3; ++r){
+			for (unsigned int k = 0; k < partitions[r].size(); ++k){
+				assert(OC::BatchConversions::get_regime(kep_states(1,partitions[r][k])) == r);
+				assert(k == 0 || partitions[r][k] > partitions[r][k - 1]);
+			}
+		}
+
+		arma::mat cart_states,kep_states_back,cart_states_back;
+		OC::BatchConversions::kep_to_cart(kep_states,1,0.1,cart_states);
+		OC::BatchConversions::cart_to_kep(cart_states,1,0.1,kep_states_back);
+		OC::BatchConversions::kep_to_cart(kep_states_back,1,0.1,cart_states_back);
+
+		for (int i = 0; i < N; ++i){
+
+			double e = kep_states(1,i);
+			double scale = arma::norm(cart_states.col(i));
+			OC::KepState kep(kep_states.col(i),1);
+
+			// Away from the parabola, the dispatch must reproduce the scalar conversions
+			if (OC::BatchConversions::get_regime(e) != OC::NEAR_PARABOLIC || std::abs(e - 1) > 5e-3){
+				assert(arma::norm(cart_states.col(i) - kep.convert_to_cart(0.1).get_state()) < 1e-9 * scale);
+			}
+
+			// The near-parabolic path must remain accurate all the way to the parabola,
+			// where the scalar conversions lose accuracy as |e - 1| decreases
+			double tolerance = OC::BatchConversions::get_regime(e) == OC::NEAR_PARABOLIC ? 1e-11 : 1e-9;
+			assert(arma::norm(cart_states_back.col(i) - cart_states.col(i)) < tolerance * scale);
+		}
+
+		std::cout << "- test_regime_dispatch() passed\n";
+
+	}
+
+}
@@ -1,13 +1,40 @@
 #include <Tests.hpp>
+#include <PropertyHarness.hpp>
 #include <armadillo>
 #include <OrbitConversions.hpp>
 
 
+// Baseline committed next to the tests, set by the build
+#ifndef PROPERTY_BASELINE
+#define PROPERTY_BASELINE "property_baseline.txt"
+#endif
 
-int main(){
+// A property run against the committed baseline regresses if it is 4 times slower than on the reference machine
+#define COMMITTED_BASELINE_THROUGHPUT_MARGIN 0.25
+
+// Usage: Tests [samples per property] [baseline file] [update]
+// The committed baseline is recorded on 1e6 samples per property, on a reference machine. 
+// Its throughputs are checked with a loose margin. 'update' writes a per-machine baseline, 
+// checked at the default margin when passed as the baseline file
+int main(int argc,char ** argv){
 
 	Tests::run_tests(50000);
 
-	return 0;
+	unsigned long long samples = argc > 1 ? std::stoull(argv[1]) : 1000000;
+	std::string baseline = argc > 2 ? argv[2] : PROPERTY_BASELINE;
+
+	Tests::PropertyHarness harness(samples);
+	harness.run();
+	harness.print();
+
+	if (argc > 3 && std::string(argv[3]) == "update"){
+		return harness.save_baseline(baseline) ? 0 : 1;
+	}
+
+	if (baseline == PROPERTY_BASELINE){
+		return harness.check_against_baseline(baseline,10,COMMITTED_BASELINE_THROUGHPUT_MARGIN) ? 0 : 1;
+	}
+
+	return harness.check_against_baseline(baseline) ? 0 : 1;
 
 }
\ No newline at end of file
@@ -0,0 +1,222 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ARCBOUNDS_HEADER 
+#define ARCBOUNDS_HEADER
+
+#include "OrbitConversions/KepState.hpp"
+#include "OrbitConversions/StateCatalog.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Axis-aligned box
+	*/
+	struct ArcBox{
+
+		double min[3];
+		double max[3];
+
+		/**
+		Checks whether two boxes come within a distance of each other along every axis
+		@param other other box
+		@param distance separation below which the boxes are considered overlapping
+		@return true if the boxes overlap
+		*/
+		bool overlaps(const ArcBox & other,double distance = 0) const{
+			for (unsigned int k = 0; k < 3; ++k){
+				if (this -> min[k] > other.max[k] + distance || other.min[k] > this -> max[k] + distance){
+					return false;
+				}
+			}
+			return true;
+		}
+
+		/**
+		Grows the box so that it contains another one
+		@param other other box
+		*/
+		void merge(const ArcBox & other);
+
+	};
+
+	/**
+	Spherical shell centered on the attracting body
+	*/
+	struct ArcShell{
+
+		double r_min;
+		double r_max;
+
+		/**
+		Checks whether two shells come within a distance of each other
+		@param other other shell
+		@param distance separation below which the shells are considered overlapping
+		@return true if the shells overlap
+		*/
+		bool overlaps(const ArcShell & other,double distance = 0) const{
+			return this -> r_min <= other.r_max + distance && other.r_min <= this -> r_max + distance;
+		}
+
+	};
+
+	/**
+	Conservative bounds on the positions a keplerian orbit goes through over a time interval. 
+	Each position component and the radius are sinusoids (elliptic orbits) or combinations of 
+	hyperbolic functions (hyperbolic orbits) of the eccentric/hyperbolic anomaly x, so their extrema 
+	over [t0,t1] are found in closed form among the ends of the anomaly range and the interior 
+	stationary points. The anomaly range is widened by the Kepler solver residual, 
+	so that the bounds hold in spite of the solver tolerance
+	*/
+	class ArcBounds{
+
+	public:
+
+		/**
+		Returns the bounding box of an arc
+		@param kep keplerian state
+		@param t0 start of the time interval (time since epoch)
+		@param t1 end of the time interval (time since epoch)
+		@return box
+		*/
+		static ArcBox get_box(const KepState & kep,double t0,double t1);
+
+		/**
+		Returns the spherical shell bounding an arc
+		@param kep keplerian state
+		@param t0 start of the time interval (time since epoch)
+		@param t1 end of the time interval (time since epoch)
+		@return shell
+		*/
+		static ArcShell get_shell(const KepState & kep,double t0,double t1);
+
+		/**
+		Allocation-free kernel behind get_box and get_shell
+		@param kep pointer to the 6 orbital elements (a, e, i, Omega, omega, M0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param t0 start of the time interval (time since epoch)
+		@param t1 end of the time interval (time since epoch)
+		@param box set to the bounding box of the arc
+		@param shell set to the spherical shell bounding the arc
+		*/
+		static void get_bounds_kernel(const double * kep,double mu,double t0,double t1,ArcBox & box,ArcShell & shell);
+
+		/**
+		Computes the range of eccentric (elliptic) or hyperbolic anomaly swept over a time interval. 
+		The elliptic range is unwrapped, i.e x1 - x0 exceeds 2 pi if the interval is longer than a period, 
+		and both ends are widened by the Kepler solver residual
+		@param kep pointer to the 6 orbital elements (a, e, i, Omega, omega, M0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param t0 start of the time interval (time since epoch)
+		@param t1 end of the time interval (time since epoch)
+		@param x0 set to the start of the anomaly range
+		@param x1 set to the end of the anomaly range
+		*/
+		static void get_anomaly_range(const double * kep,double mu,double t0,double t1,double & x0,double & x1);
+
+	};
+
+	/**
+	Bounding volume hierarchy over the arcs of a catalog over a common time interval. 
+	Each arc is bounded by an ArcBox and an ArcShell. The tree is built top-down on the boxes, 
+	splitting at the median of the box centers along their widest axis
+	*/
+	class ArcBVH{
+
+	public:
+
+		/**
+		Constructor
+		@param catalog keplerian states sharing a common epoch
+		@param t0 start of the time interval (time since epoch)
+		@param t1 end of the time interval (time since epoch)
+		@param leaf_size maximum number of arcs per leaf
+		*/
+		ArcBVH(const std::vector<KepState> & catalog,double t0,double t1,unsigned int leaf_size = 4);
+
+		/**
+		Constructor
+		@param catalog keplerian catalog
+		@param t0 start of the time interval (time since epoch)
+		@param t1 end of the time interval (time since epoch)
+		@param leaf_size maximum number of arcs per leaf
+		*/
+		ArcBVH(const KepCatalog & catalog,double t0,double t1,unsigned int leaf_size = 4);
+
+		/**
+		Finds the arcs whose box comes within a distance of a box
+		@param box query box
+		@param distance separation below which boxes are considered overlapping
+		@return indices of the overlapping arcs, in increasing order
+		*/
+		std::vector<unsigned int> query(const ArcBox & box,double distance = 0) const;
+
+		/**
+		Finds the pairs of arcs whose boxes and shells both come within a distance of each other. 
+		Every other pair stays further apart than distance over the whole interval. 
+		The result can be passed as candidates to CloseApproach::find_close_approaches
+		@param distance separation below which arcs are considered overlapping
+		@return pairs (i,j) with i < j, in lexicographic order
+		*/
+		std::vector<std::pair<unsigned int,unsigned int> > find_overlapping_pairs(double distance) const;
+
+		const ArcBox & get_box(unsigned int i) const;
+		const ArcShell & get_shell(unsigned int i) const;
+		unsigned int get_size() const;
+
+	protected:
+
+		struct Node{
+
+			ArcBox box;
+
+			// Children of an inner node, or range of arcs [first,first + count) in the ordering of a leaf
+			unsigned int left;
+			unsigned int right;
+			unsigned int first;
+			unsigned int count;
+
+		};
+
+		void build(const double * states,unsigned int object_stride,unsigned int component_stride,
+			unsigned int N,double mu,double t0,double t1,unsigned int leaf_size);
+
+		unsigned int build_node(unsigned int first,unsigned int count,unsigned int leaf_size);
+
+		void query_node(unsigned int node,const ArcBox & box,double distance,std::vector<unsigned int> & result) const;
+
+		void find_pairs(unsigned int node_a,unsigned int node_b,double distance,
+			std::vector<std::pair<unsigned int,unsigned int> > & pairs) const;
+
+		std::vector<ArcBox> boxes;
+		std::vector<ArcShell> shells;
+		std::vector<Node> nodes;
+
+		// Arc indices, ordered so that the arcs of each leaf are contiguous
+		std::vector<unsigned int> order;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,457 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BATCHCONVERSIONS_HEADER 
+#define BATCHCONVERSIONS_HEADER
+
+#include "OrbitConversions/CartState.hpp"
+#include "OrbitConversions/KepState.hpp"
+#include "OrbitConversions/EquinoctialState.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Orbit regimes used to dispatch the batch conversions
+	*/
+	enum OrbitRegime{
+		ELLIPTIC = 0,
+		NEAR_PARABOLIC = 1,
+		HYPERBOLIC = 2
+	};
+
+	/**
+	Outputs of the keplerian to cartesian kernels
+	*/
+	enum CartOutput{
+		CART_POSITION = 1,
+		CART_VELOCITY = 2,
+		CART_ALL = 3
+	};
+
+	/**
+	Outputs of the cartesian to keplerian kernels
+	*/
+	enum KepOutput{
+		KEP_A = 1,
+		KEP_ECCENTRICITY = 2,
+		KEP_INCLINATION = 4,
+		KEP_OMEGA_NODE = 8,
+		KEP_OMEGA_PERIAPSIS = 16,
+		KEP_M0 = 32,
+
+		// Screening needs the size, shape and tilt of the orbits only
+		KEP_SHAPE = 7,
+
+		KEP_ALL = 63
+	};
+
+	/**
+	Conversions between state parametrizations over whole catalogs. 
+	States are stored one per column in 6xN matrices and share the same gravitational parameter. 
+	The outputs are not reallocated if they already have the right size.
+	The keplerian conversions partition their input by orbit regime (stable index partition) and run 
+	each partition through a kernel specialized for its regime. Each kernel reads and writes the columns 
+	of its own indices, so the results come out in the original order.
+	Orbits with |e - 1| < near_parabolic_band go through a universal-variable form of Kepler's equation 
+	written with Stumpff functions, which stays well conditioned close to the parabola. 
+	The keplerian kernels are templated on a CartOutput or KepOutput mask, the batch conversions 
+	using CART_ALL and KEP_ALL. MaskedConversions instantiates them on partial masks
+	*/
+	class BatchConversions{
+
+	public:
+
+		/**
+		Batch counterpart of KepState::convert_to_cart
+		@param kep_states 6xN keplerian states (a, e, i, Omega, omega, M0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart_states set to the 6xN cartesian states
+		@param policy Kepler solver policy
+		*/
+		static void kep_to_cart(const arma::mat & kep_states,double mu,double delta_T,arma::mat & cart_states,
+			const SolverPolicy & policy = SolverPolicy::default_policy());
+
+		/**
+		Batch counterpart of CartState::convert_to_kep
+		@param cart_states 6xN cartesian states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep_states set to the 6xN keplerian states (a, e, i, Omega, omega, M0)
+		*/
+		static void cart_to_kep(const arma::mat & cart_states,double mu,double delta_T,arma::mat & kep_states);
+
+		/**
+		Batch counterpart of EquinoctialState::convert_to_cart
+		@param equinoctial_states 6xN modified equinoctial states (p, f, g, h, k, L0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart_states set to the 6xN cartesian states
+		*/
+		static void equinoctial_to_cart(const arma::mat & equinoctial_states,double mu,double delta_T,arma::mat & cart_states);
+
+		/**
+		Batch counterpart of CartState::convert_to_equinoctial
+		@param cart_states 6xN cartesian states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param equinoctial_states set to the 6xN modified equinoctial states (p, f, g, h, k, L0)
+		*/
+		static void cart_to_equinoctial(const arma::mat & cart_states,double mu,double delta_T,arma::mat & equinoctial_states);
+
+		/**
+		Allocation-free kernel behind cart_to_kep, following CartState::convert_to_kep
+		@param cart pointer to the 6 components of the cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep pointer to 6 doubles receiving the keplerian state
+		*/
+		static void cart_to_kep_kernel(const double * cart,double mu,double delta_T,double * kep);
+
+		/**
+		Kernel used by kep_to_cart for near-parabolic orbits (elliptic or hyperbolic). 
+		Kepler's equation is written as M = |1 - e| x + e x^3 S(+-x^2), with x the eccentric or 
+		hyperbolic anomaly and S the Stumpff function, and solved by Newton iterations started 
+		from the root of its cubic (parabolic) approximation
+		@param kep pointer to the 6 components of the keplerian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart pointer to 6 doubles receiving the cartesian state, or to the packed 
+		components requested by mask (see store_cart)
+		@param policy Kepler solver policy (tolerances and iteration cap)
+		*/
+		template <unsigned int mask = CART_ALL> static void kep_to_cart_near_parabolic_kernel(const double * kep,double mu,double delta_T,double * cart,
+			const SolverPolicy & policy = SolverPolicy::default_policy());
+
+		/**
+		Kernel used by cart_to_kep for near-parabolic orbits. The semi-major axis is derived from the 
+		conic parameter rather than from the energy, the true anomaly from its two-argument form, and 
+		the mean anomaly from the cancellation-free form M = |1 - e| x + e x^3 S(+-x^2). 
+		The elliptic mean anomaly is returned in (-pi,pi] rather than [0,2 pi)
+		@param cart pointer to the 6 components of the cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep pointer to 6 doubles receiving the keplerian state
+		*/
+		static void cart_to_kep_near_parabolic_kernel(const double * cart,double mu,double delta_T,double * kep);
+
+		/**
+		Returns the regime of an orbit
+		@param e eccentricity
+		@return regime
+		*/
+		static OrbitRegime get_regime(double e);
+
+		/**
+		Stable partition of the columns of a set of states by orbit regime
+		@param states 6xN states
+		@param eccentricity_row row of states holding the eccentricity
+		@param partitions set to the column indices of each regime, in increasing order, indexed by OrbitRegime
+		*/
+		static void partition_by_regime(const arma::mat & states,
+			unsigned int eccentricity_row,
+			std::vector<std::vector<unsigned int> > & partitions);
+
+		/**
+		First two rows of M3(omega) * M1(i) * M3(Omega)
+		@param kep pointer to the 6 components of the keplerian state
+		@param P pointer to 3 doubles receiving the unit vector towards periapsis
+		@param Q pointer to 3 doubles receiving the in-plane unit vector 90 deg ahead of periapsis
+		*/
+		static void get_perifocal_basis(const double * kep,double * P,double * Q);
+
+		// Half-width of the near-parabolic eccentricity band
+		static const double near_parabolic_band;
+
+	protected:
+
+		friend class MaskedConversions;
+
+		template <unsigned int mask = CART_ALL> static void kep_to_cart_elliptic_kernel(const double * kep,double mu,double delta_T,double * cart,const SolverPolicy & policy);
+		template <unsigned int mask = CART_ALL> static void kep_to_cart_hyperbolic_kernel(const double * kep,double mu,double delta_T,double * cart,const SolverPolicy & policy);
+
+		/**
+		Rotates a perifocal position and velocity to the inertial frame and stores the components 
+		requested by mask. The velocity follows the position if both are requested
+		@param kep pointer to the 6 components of the keplerian state
+		@param x perifocal position along periapsis
+		@param y perifocal position 90 deg ahead of periapsis
+		@param x_dot perifocal velocity along periapsis (ignored if the velocity is not requested)
+		@param y_dot perifocal velocity 90 deg ahead of periapsis (ignored if the velocity is not requested)
+		@param cart pointer to 3 doubles per requested vector
+		*/
+		template <unsigned int mask> static void store_cart(const double * kep,double x,double y,double x_dot,double y_dot,double * cart);
+
+		/**
+		Regime-independent part of cart_to_kep_kernel. a and e are always computed, the other 
+		elements only if requested by mask (f being computed if KEP_M0 is requested)
+		@param cart pointer to the 6 components of the cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param kep pointer to 6 doubles receiving (a, e, i, Omega, omega, f), f being the true anomaly in [0,2 pi)
+		*/
+		template <unsigned int mask = KEP_ALL> static void cart_to_shape_kernel(const double * cart,double mu,double * kep);
+
+		/**
+		Replace the true anomaly in the last component of the output of cart_to_shape_kernel
+		by the mean anomaly at epoch
+		@param kep pointer to (a, e, i, Omega, omega, f)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		*/
+		static void set_mean_anomaly_elliptic(double * kep,double mu,double delta_T);
+		static void set_mean_anomaly_hyperbolic(double * kep,double mu,double delta_T);
+
+	};
+
+	// The mask-templated kernels are defined here so that MaskedConversions can instantiate them. 
+	// Every mask test is a compile-time constant, so the unrequested work is compiled out
+
+	template <unsigned int mask>
+	void BatchConversions::store_cart(const double * kep,double x,double y,double x_dot,double y_dot,double * cart){
+
+		double P[3];
+		double Q[3];
+		BatchConversions::get_perifocal_basis(kep,P,Q);
+
+		double * velocity = cart + ((mask & CART_POSITION) ? 3 : 0);
+
+		for (int k = 0; k < 3; ++k){
+			if (mask & CART_POSITION){
+				cart[k] = x * P[k] + y * Q[k];
+			}
+			if (mask & CART_VELOCITY){
+				velocity[k] = x_dot * P[k] + y_dot * Q[k];
+			}
+		}
+
+	}
+
+	template <unsigned int mask>
+	void BatchConversions::kep_to_cart_elliptic_kernel(const double * kep,double mu,double delta_T,double * cart,const SolverPolicy & policy){
+
+		double a = kep[0];
+		double e = kep[1];
+		double n = std::sqrt(mu / (a * a * a));
+		double M = std::remainder(kep[5] + n * delta_T,2 * arma::datum::pi);
+
+		double ecc = State::ecc_from_M(M,e,policy);
+		double cos_ecc = std::cos(ecc);
+		double sin_ecc = std::sin(ecc);
+		double b_factor = std::sqrt(1 - e * e);
+
+		double x = a * (cos_ecc - e);
+		double y = a * b_factor * sin_ecc;
+		double x_dot = 0;
+		double y_dot = 0;
+
+		if (mask & CART_VELOCITY){
+			double sqrt_mu_a = std::sqrt(mu * a);
+			double r = a * (1 - e * cos_ecc);
+			x_dot = - sqrt_mu_a * sin_ecc / r;
+			y_dot = sqrt_mu_a * b_factor * cos_ecc / r;
+		}
+
+		BatchConversions::store_cart<mask>(kep,x,y,x_dot,y_dot,cart);
+
+	}
+
+	template <unsigned int mask>
+	void BatchConversions::kep_to_cart_hyperbolic_kernel(const double * kep,double mu,double delta_T,double * cart,const SolverPolicy & policy){
+
+		double a = kep[0];
+		double e = kep[1];
+		double n = std::sqrt(- mu / (a * a * a));
+		double M = kep[5] + n * delta_T;
+
+		double f = State::f_from_H(State::H_from_M(M,e,policy),e);
+		double cos_f = std::cos(f);
+		double sin_f = std::sin(f);
+		double p = a * (1 - e * e);
+		double r = p / (1 + e * cos_f);
+
+		double x = r * cos_f;
+		double y = r * sin_f;
+		double x_dot = 0;
+		double y_dot = 0;
+
+		if (mask & CART_VELOCITY){
+			double sqrt_mu_p = std::sqrt(mu / p);
+			x_dot = - sqrt_mu_p * sin_f;
+			y_dot = sqrt_mu_p * (e + cos_f);
+		}
+
+		BatchConversions::store_cart<mask>(kep,x,y,x_dot,y_dot,cart);
+
+	}
+
+	template <unsigned int mask>
+	void BatchConversions::kep_to_cart_near_parabolic_kernel(const double * kep,double mu,double delta_T,double * cart,
+		const SolverPolicy & policy){
+
+		double e = kep[1];
+		double abs_a = std::abs(kep[0]);
+		double one_minus_e = std::abs(1 - e);
+
+		// Sign of the Stumpff arguments: x^2 for the eccentric anomaly, -x^2 for the hyperbolic anomaly
+		double s = e < 1 ? 1 : -1;
+
+		double n = std::sqrt(mu / (abs_a * abs_a * abs_a));
+		double M = kep[5] + n * delta_T;
+		if (s > 0){
+			M = std::remainder(M,2 * arma::datum::pi);
+		}
+
+		// Real root of the cubic |1 - e| x + e x^3 / 6 = M
+		double p_cubic = 6 * one_minus_e / e;
+		double q_cubic = - 6 * M / e;
+		double D = std::sqrt(q_cubic * q_cubic / 4 + p_cubic * p_cubic * p_cubic / 27);
+		double x = std::cbrt(- q_cubic / 2 + D) + std::cbrt(- q_cubic / 2 - D);
+
+		// The cubic overestimates the hyperbolic anomaly far from periapsis
+		if (s < 0){
+			double x_max = std::asinh(std::abs(M) / e) + 1;
+			if (std::abs(x) > x_max){
+				x = x > 0 ? x_max : - x_max;
+			}
+		}
+
+		double C,S;
+		for (unsigned int i = 0; i < policy.max_iterations; ++i){
+
+			double x2 = x * x;
+			C = State::stumpff_C(s * x2);
+			S = State::stumpff_S(s * x2);
+
+			double residual = one_minus_e * x + e * x2 * x * S - M;
+			double dx = residual / (one_minus_e + e * x2 * C);
+			x -= dx;
+
+			if (std::abs(residual) < policy.tolerance || std::abs(dx) < policy.step_tolerance){
+				break;
+			}
+
+		}
+
+		double x2 = x * x;
+		C = State::stumpff_C(s * x2);
+		S = State::stumpff_S(s * x2);
+
+		// sin/sinh and cos/cosh of the anomaly, and the orbit geometry, free of cancellations
+		double sn = x * (1 - s * x2 * S);
+		double b_factor = std::sqrt(one_minus_e * (1 + e));
+
+		double x_pf = abs_a * (one_minus_e - x2 * C);
+		double y_pf = abs_a * b_factor * sn;
+		double x_dot = 0;
+		double y_dot = 0;
+
+		if (mask & CART_VELOCITY){
+			double cn = 1 - s * x2 * C;
+			double sqrt_mu_a = std::sqrt(mu * abs_a);
+			double r = abs_a * (one_minus_e + e * x2 * C);
+			x_dot = - sqrt_mu_a * sn / r;
+			y_dot = sqrt_mu_a * b_factor * cn / r;
+		}
+
+		BatchConversions::store_cart<mask>(kep,x_pf,y_pf,x_dot,y_dot,cart);
+
+	}
+
+	template <unsigned int mask>
+	void BatchConversions::cart_to_shape_kernel(const double * cart,double mu,double * kep){
+
+		const unsigned int angles = KEP_INCLINATION | KEP_OMEGA_NODE | KEP_OMEGA_PERIAPSIS;
+
+		const double * r_vec = cart;
+		const double * v_vec = cart + 3;
+
+		double r = std::sqrt(r_vec[0] * r_vec[0] + r_vec[1] * r_vec[1] + r_vec[2] * r_vec[2]);
+		double v2 = v_vec[0] * v_vec[0] + v_vec[1] * v_vec[1] + v_vec[2] * v_vec[2];
+
+		// semi major axis
+		double a = - mu / (v2 - 2 * mu / r);
+
+		// spacecraft's angular momentum
+		double h_vec[3] = {r_vec[1] * v_vec[2] - r_vec[2] * v_vec[1],
+			r_vec[2] * v_vec[0] - r_vec[0] * v_vec[2],
+			r_vec[0] * v_vec[1] - r_vec[1] * v_vec[0]};
+
+		// eccentricity
+		double e_vec[3];
+		e_vec[0] = (v_vec[1] * h_vec[2] - v_vec[2] * h_vec[1]) / mu - r_vec[0] / r;
+		e_vec[1] = (v_vec[2] * h_vec[0] - v_vec[0] * h_vec[2]) / mu - r_vec[1] / r;
+		e_vec[2] = (v_vec[0] * h_vec[1] - v_vec[1] * h_vec[0]) / mu - r_vec[2] / r;
+		double e = std::sqrt(e_vec[0] * e_vec[0] + e_vec[1] * e_vec[1] + e_vec[2] * e_vec[2]);
+
+		kep[0] = a;
+		kep[1] = e;
+
+		if (!(mask & (angles | KEP_M0))){
+			return;
+		}
+
+		double h = std::sqrt(h_vec[0] * h_vec[0] + h_vec[1] * h_vec[1] + h_vec[2] * h_vec[2]);
+
+		if (mask & angles){
+
+			// orbit DCM elements used by the angles
+			double h_hat[3] = {h_vec[0] / h,h_vec[1] / h,h_vec[2] / h};
+
+			if (mask & KEP_INCLINATION){
+				kep[2] = std::acos(h_hat[2]);
+			}
+			if (mask & KEP_OMEGA_NODE){
+				kep[3] = std::atan2(h_hat[0],- h_hat[1]);
+			}
+			if (mask & KEP_OMEGA_PERIAPSIS){
+				double ON_02 = e_vec[2] / e;
+				double ON_12 = (h_hat[0] * e_vec[1] - h_hat[1] * e_vec[0]) / e;
+				kep[4] = std::atan2(ON_02,ON_12);
+			}
+
+		}
+
+		if (mask & KEP_M0){
+
+			// conic parameter
+			double p = a * (1 - e * e);
+
+			// true anomaly, from e cos(f) = p / r - 1 and e sin(f) = h (r.v) / (mu r).
+			// acos(cos(f)) would lose half of the digits of f near the apsides
+			double e_cos_f = p / r - 1;
+			double e_sin_f = h * (r_vec[0] * v_vec[0] + r_vec[1] * v_vec[1] + r_vec[2] * v_vec[2]) / (mu * r);
+			double f = std::atan2(e_sin_f,e_cos_f);
+
+			if (f < 0){
+				f += 2 * arma::datum::pi;
+			}
+
+			kep[5] = f;
+
+		}
+
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -25,10 +25,12 @@
 
 #include "OrbitConversions/State.hpp"
 #include "OrbitConversions/KepState.hpp"
+#include "OrbitConversions/EquinoctialState.hpp"
 
 namespace OC{
 
 	class KepState;
+	class EquinoctialState;
 
 	class CartState : public State{
 
@@ -58,6 +60,14 @@ namespace OC{
 
 		KepState convert_to_kep(double delta_T) const;
 
+		/* 
+		Returns the modified equinoctial elements state corresponding to the 
+		cartesian state
+		@param delta_T time since epoch
+		@return modified equinoctial state vector (p, f, g, h, k, L0)
+		*/
+		EquinoctialState convert_to_equinoctial(double delta_T) const;
+
 	protected:
 
 	};
@@ -0,0 +1,117 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CLOSEAPPROACH_HEADER 
+#define CLOSEAPPROACH_HEADER
+
+#include "OrbitConversions/PreparedKepState.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Local minimum of the distance between two objects
+	*/
+	struct CloseApproachEvent{
+
+		// Time since epoch of the closest approach
+		double t;
+
+		// Distance at closest approach
+		double distance;
+
+		// Relative speed at closest approach
+		double relative_speed;
+
+	};
+
+	class CloseApproach{
+
+	public:
+
+		/**
+		Finds all the local minima of the distance between two keplerian orbits 
+		over a time window. The window is scanned with a coarse step set to a fraction
+		of the shortest characteristic time of the two orbits, and each sign change of the range-rate 
+		function r_rel.v_rel from negative to positive is refined by root finding. 
+		@param kep_1 first keplerian state
+		@param kep_2 second keplerian state (must share the epoch of kep_1)
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param threshold only the minima with a distance below threshold are returned
+		@param steps_per_period number of coarse steps per characteristic time of the fastest orbit
+		@return time-ordered close approaches
+		*/
+		static std::vector<CloseApproachEvent> find_close_approaches(const KepState & kep_1,
+			const KepState & kep_2,
+			double t0,double t1,
+			double threshold,
+			unsigned int steps_per_period = 16);
+
+		/**
+		Same as above, but operating on already prepared states
+		*/
+		static std::vector<CloseApproachEvent> find_close_approaches(const PreparedKepState & orbit_1,
+			const PreparedKepState & orbit_2,
+			double t0,double t1,
+			double threshold,
+			unsigned int steps_per_period = 16);
+
+		/**
+		Multithreaded driver processing a list of candidate pairs drawn from a catalog.
+		Each catalog entry is prepared only once
+		@param catalog keplerian states sharing a common epoch
+		@param candidates pairs of indices into catalog
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param threshold only the minima with a distance below threshold are returned
+		@param steps_per_period number of coarse steps per characteristic time of the fastest orbit
+		@return close approaches of each candidate pair, ordered like candidates
+		*/
+		static std::vector<std::vector<CloseApproachEvent> > find_close_approaches(const std::vector<KepState> & catalog,
+			const std::vector<std::pair<unsigned int,unsigned int> > & candidates,
+			double t0,double t1,
+			double threshold,
+			unsigned int steps_per_period = 16);
+
+	protected:
+
+		/**
+		Evaluates the range-rate function r_rel.v_rel
+		@param orbit_1 first orbit
+		@param orbit_2 second orbit
+		@param t time since epoch
+		@param distance set to the distance between the two objects
+		@param relative_speed set to the relative speed between the two objects
+		@return r_rel.v_rel
+		*/
+		static double range_rate_function(const PreparedKepState & orbit_1,
+			const PreparedKepState & orbit_2,
+			double t,
+			double & distance,
+			double & relative_speed);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CONVERSIONCACHE_HEADER 
+#define CONVERSIONCACHE_HEADER
+
+#include "OrbitConversions/CartState.hpp"
+#include "OrbitConversions/KepState.hpp"
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace OC{
+
+	/**
+	Thread-safe, bounded least-recently-used cache placed in front of 
+	CartState::convert_to_kep and KepState::convert_to_cart. 
+	Queries are keyed on the exact bits of the input state, of mu and of delta_T, 
+	so a hit returns exactly what the conversion would have returned.
+	The cache is split into independently locked shards, each holding its own 
+	LRU list, so that concurrent queries rarely contend on the same lock
+	*/
+	class ConversionCache{
+
+	public:
+
+		/**
+		Constructor
+		@param capacity maximum number of cached results, shared evenly among the shards
+		@param shards number of independently locked shards
+		*/
+		ConversionCache(unsigned int capacity = 65536,unsigned int shards = 16);
+
+		/**
+		Cached counterpart of CartState::convert_to_kep
+		@param cart cartesian state
+		@param delta_T time since epoch
+		@return keplerian state
+		*/
+		KepState convert_to_kep(const CartState & cart,double delta_T);
+
+		/**
+		Cached counterpart of KepState::convert_to_cart
+		@param kep keplerian state
+		@param delta_T time since epoch
+		@return cartesian state
+		*/
+		CartState convert_to_cart(const KepState & kep,double delta_T);
+
+		/**
+		Removes all the cached results. The statistics are reset
+		*/
+		void clear();
+
+		/**
+		Returns the number of queries answered from the cache
+		@return number of hits
+		*/
+		unsigned long long get_hits() const;
+
+		/**
+		Returns the number of queries that required a conversion
+		@return number of misses
+		*/
+		unsigned long long get_misses() const;
+
+		/**
+		Returns the number of cached results
+		@return number of cached results
+		*/
+		unsigned int get_size() const;
+
+		/**
+		Returns the maximum number of cached results
+		@return capacity
+		*/
+		unsigned int get_capacity() const;
+
+	protected:
+
+		enum ConversionType{
+			CART_TO_KEP = 0,
+			KEP_TO_CART = 1
+		};
+
+		/**
+		Raw bits of a query
+		*/
+		struct Key{
+
+			unsigned long long bits[9];
+
+			bool operator==(const Key & other) const;
+
+		};
+
+		struct KeyHash{
+			size_t operator()(const Key & key) const;
+		};
+
+		struct Entry{
+			Key key;
+			double result[6];
+		};
+
+		struct Shard{
+			std::mutex mutex;
+			std::list<Entry> entries;
+			std::unordered_map<Key,std::list<Entry>::iterator,KeyHash> index;
+		};
+
+		static Key make_key(ConversionType type,const arma::vec & state,double mu,double delta_T);
+
+		/**
+		Looks up a query, moving it to the front of its shard's LRU list if found
+		@param key query key
+		@param result pointer to 6 doubles receiving the cached result
+		@return true if the query was found
+		*/
+		bool find(const Key & key,double * result);
+
+		/**
+		Stores the result of a query, evicting the least recently used entry of the shard if full
+		@param key query key
+		@param result pointer to the 6 components of the result
+		*/
+		void insert(const Key & key,const double * result);
+
+		Shard & get_shard(const Key & key);
+
+		std::vector<std::unique_ptr<Shard> > shards;
+		unsigned int shard_capacity;
+
+		std::atomic<unsigned long long> hits;
+		std::atomic<unsigned long long> misses;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
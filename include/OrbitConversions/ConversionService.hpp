@@ -0,0 +1,190 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CONVERSIONSERVICE_HEADER 
+#define CONVERSIONSERVICE_HEADER
+
+#include "OrbitConversions/BatchConversions.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OC{
+
+	/**
+	Batching settings of a ConversionService
+	*/
+	struct ServiceSettings{
+
+		// Longest time a request waits for other requests to be coalesced with it (s)
+		double latency_budget = 100e-6;
+
+		// A micro-batch is dispatched as soon as it holds this many states
+		unsigned int max_batch_size = 512;
+
+	};
+
+	/**
+	Embeddable asynchronous conversion service. 
+	Requests of a few states each are submitted from any number of threads through a 
+	lock-free multi-producer queue, and are coalesced by a worker thread into micro-batches 
+	run through the BatchConversions kernels. A micro-batch is dispatched once it holds 
+	max_batch_size states or once its oldest request has waited for latency_budget, 
+	whichever comes first. Requests sharing the same conversion, gravitational parameter and 
+	time since epoch are converted together. Results are delivered through futures or callbacks, 
+	the latter being invoked on the worker thread. An exception thrown by a callback is caught 
+	on the worker thread and kept for get_callback_exception, so the service keeps running.
+	The worker polls the queue, backing off to short sleeps when idle
+	*/
+	class ConversionService{
+
+	public:
+
+		enum RequestType{
+			KEP_TO_CART = 0,
+			CART_TO_KEP = 1
+		};
+
+		typedef std::function<void(const arma::mat &)> Callback;
+
+		/**
+		Constructor. Starts the worker thread
+		@param settings batching settings
+		*/
+		ConversionService(const ServiceSettings & settings = ServiceSettings());
+
+		/**
+		Destructor. Completes the pending requests and stops the worker thread
+		*/
+		~ConversionService();
+
+		/**
+		Submits a request. Throws std::invalid_argument if states does not have 6 rows, 
+		and std::logic_error if the service is stopped
+		@param type requested conversion
+		@param states 6xN input states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@return future holding the 6xN converted states
+		*/
+		std::future<arma::mat> submit(RequestType type,const arma::mat & states,double mu,double delta_T);
+
+		/**
+		Submits a request. Throws std::invalid_argument if states does not have 6 rows, 
+		and std::logic_error if the service is stopped
+		@param type requested conversion
+		@param states 6xN input states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param callback invoked on the worker thread with the 6xN converted states
+		*/
+		void submit(RequestType type,const arma::mat & states,double mu,double delta_T,Callback callback);
+
+		/**
+		Completes the pending requests and stops the worker thread. 
+		Must not be called concurrently with submit
+		*/
+		void stop();
+
+		/**
+		Returns the number of requests dispatched to the kernels
+		@return number of requests
+		*/
+		unsigned long long get_requests() const;
+
+		/**
+		Returns the number of dispatched micro-batches
+		@return number of micro-batches
+		*/
+		unsigned long long get_batches() const;
+
+		/**
+		Returns the first exception thrown by a callback
+		@return exception, or nullptr if no callback has thrown
+		*/
+		std::exception_ptr get_callback_exception() const;
+
+	protected:
+
+		struct Request{
+
+			std::atomic<Request *> next;
+
+			RequestType type;
+			arma::mat states;
+			double mu;
+			double delta_T;
+			std::chrono::steady_clock::time_point submitted;
+
+			std::promise<arma::mat> promise;
+			Callback callback;
+
+		};
+
+		void check_submission(const arma::mat & states) const;
+
+		/**
+		Appends a request to the queue. Wait-free, safe for concurrent producers
+		@param request request to append
+		*/
+		void push(Request * request);
+
+		/**
+		Removes the oldest request from the queue. Only called by the worker thread
+		@return request, or nullptr if the queue is empty or a producer is halfway through push
+		*/
+		Request * pop();
+
+		void run();
+
+		/**
+		Converts a micro-batch and completes its requests
+		@param batch requests of the micro-batch, deleted once completed
+		*/
+		void dispatch(std::vector<Request *> & batch);
+
+		ServiceSettings settings;
+
+		// Intrusive multi-producer single-consumer queue: producers exchange head, the worker owns tail
+		std::atomic<Request *> head;
+		Request * tail;
+		Request stub;
+
+		std::atomic<bool> running;
+		std::thread worker;
+
+		std::atomic<unsigned long long> requests;
+		std::atomic<unsigned long long> batches;
+
+		std::exception_ptr callback_exception;
+		mutable std::mutex callback_exception_mutex;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
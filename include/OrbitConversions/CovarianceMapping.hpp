@@ -0,0 +1,197 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef COVARIANCEMAPPING_HEADER 
+#define COVARIANCEMAPPING_HEADER
+
+#include "OrbitConversions/BatchConversions.hpp"
+#include "OrbitConversions/PackedCovariances.hpp"
+#include "OrbitConversions/Dual.hpp"
+
+namespace OC{
+
+	/**
+	How covariances are carried through a nonlinear map
+	*/
+	enum CovarianceMappingMode{
+		LINEARIZED = 0,
+		UNSCENTED = 1
+	};
+
+	/**
+	Scaling parameters of the unscented transform
+	*/
+	struct UnscentedParameters{
+
+		double alpha = 1;
+		double beta = 2;
+		double kappa = 0;
+
+	};
+
+	/**
+	Maps state covariances through the cartesian <-> keplerian conversions and through 
+	keplerian propagation. In LINEARIZED mode, the exact Jacobian of each conversion is obtained 
+	by forward-mode differentiation of the conversion kernel and applied as J * P * J^T 
+	directly on the packed storage. In UNSCENTED mode, the 13 sigma points of each state are mapped 
+	through the conversion instead, and the mapped states are set to the sigma-point mean.
+	Keplerian angles (Omega, omega, M0) are averaged as wrapped deviations from the mapped state
+	*/
+	class CovarianceMapping{
+
+	public:
+
+		/**
+		Maps keplerian states and their covariances to cartesian states
+		@param kep_states 6xN keplerian states (a, e, i, Omega, omega, M0)
+		@param kep_covariances covariances of kep_states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart_states set to the 6xN cartesian states
+		@param cart_covariances set to the covariances of cart_states
+		@param mode mapping mode
+		@param parameters unscented transform parameters (UNSCENTED mode only)
+		*/
+		static void kep_to_cart(const arma::mat & kep_states,
+			const PackedCovariances & kep_covariances,
+			double mu,double delta_T,
+			arma::mat & cart_states,
+			PackedCovariances & cart_covariances,
+			CovarianceMappingMode mode = LINEARIZED,
+			const UnscentedParameters & parameters = UnscentedParameters());
+
+		/**
+		Maps cartesian states and their covariances to keplerian states
+		@param cart_states 6xN cartesian states
+		@param cart_covariances covariances of cart_states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep_states set to the 6xN keplerian states (a, e, i, Omega, omega, M0)
+		@param kep_covariances set to the covariances of kep_states
+		@param mode mapping mode
+		@param parameters unscented transform parameters (UNSCENTED mode only)
+		*/
+		static void cart_to_kep(const arma::mat & cart_states,
+			const PackedCovariances & cart_covariances,
+			double mu,double delta_T,
+			arma::mat & kep_states,
+			PackedCovariances & kep_covariances,
+			CovarianceMappingMode mode = LINEARIZED,
+			const UnscentedParameters & parameters = UnscentedParameters());
+
+		/**
+		Propagates cartesian states and their covariances along their keplerian orbits.
+		The cartesian -> keplerian -> cartesian chain is differentiated as a whole, so 
+		the state transition matrix is never formed from two separate Jacobians
+		@param cart_states 6xN cartesian states at the initial time
+		@param cart_covariances covariances of cart_states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param dt propagation time
+		@param propagated_states set to the 6xN cartesian states after dt
+		@param propagated_covariances set to the covariances of propagated_states
+		@param mode mapping mode
+		@param parameters unscented transform parameters (UNSCENTED mode only)
+		*/
+		static void propagate(const arma::mat & cart_states,
+			const PackedCovariances & cart_covariances,
+			double mu,double dt,
+			arma::mat & propagated_states,
+			PackedCovariances & propagated_covariances,
+			CovarianceMappingMode mode = LINEARIZED,
+			const UnscentedParameters & parameters = UnscentedParameters());
+
+		/**
+		Jacobian of KepState::convert_to_cart with respect to the keplerian state
+		@param kep pointer to the 6 components of the keplerian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart pointer to 6 doubles receiving the cartesian state
+		@param J pointer to 36 doubles receiving the column-major 6x6 Jacobian
+		*/
+		static void kep_to_cart_jacobian(const double * kep,double mu,double delta_T,double * cart,double * J);
+
+		/**
+		Jacobian of CartState::convert_to_kep with respect to the cartesian state
+		@param cart pointer to the 6 components of the cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep pointer to 6 doubles receiving the keplerian state
+		@param J pointer to 36 doubles receiving the column-major 6x6 Jacobian
+		*/
+		static void cart_to_kep_jacobian(const double * cart,double mu,double delta_T,double * kep,double * J);
+
+		/**
+		State transition matrix of keplerian motion
+		@param cart pointer to the 6 components of the initial cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param dt propagation time
+		@param propagated_cart pointer to 6 doubles receiving the propagated cartesian state
+		@param J pointer to 36 doubles receiving the column-major 6x6 state transition matrix
+		*/
+		static void propagation_jacobian(const double * cart,double mu,double dt,double * propagated_cart,double * J);
+
+		/**
+		Conversion kernels templated on the scalar type, so that they can be evaluated on doubles or on 
+		dual numbers. They follow PreparedKepState::get_position_velocity and BatchConversions::cart_to_kep_kernel
+		*/
+		template <typename T> static void kep_to_cart_kernel(const T * kep,double mu,double delta_T,T * cart);
+		template <typename T> static void cart_to_kep_kernel(const T * cart,double mu,double delta_T,T * kep);
+
+	protected:
+
+		/**
+		Applies P_out = J * P_in * J^T to the i-th covariance of the packed storage
+		@param J pointer to the 36 components of the column-major Jacobian
+		@param input input covariances
+		@param i index of the covariance
+		@param output output covariances
+		*/
+		static void transform_covariance(const double * J,
+			const PackedCovariances & input,
+			unsigned int i,
+			PackedCovariances & output);
+
+		/**
+		Unscented transform of the i-th state and covariance through map
+		@param x pointer to the 6 components of the input state
+		@param input input covariances
+		@param i index of the covariance
+		@param map callable y = map(x), with signature void(const double *,double *)
+		@param wrapped_output flags the output components that are angles
+		@param parameters unscented transform parameters
+		@param y pointer to 6 doubles receiving the mean of the mapped sigma points
+		@param output output covariances
+		*/
+		template <typename Map> static void unscented_transform(const double * x,
+			const PackedCovariances & input,
+			unsigned int i,
+			const Map & map,
+			const bool * wrapped_output,
+			const UnscentedParameters & parameters,
+			double * y,
+			PackedCovariances & output);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef DISPERSION_HEADER 
+#define DISPERSION_HEADER
+
+#include "OrbitConversions/PreparedKepState.hpp"
+#include "OrbitConversions/CartState.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Sample statistics of a dispersed state at a given time
+	*/
+	struct DispersionStatistics{
+
+		// Time since epoch
+		double t;
+
+		// Number of samples
+		unsigned int samples;
+
+		// 6x1 sample mean of the cartesian state
+		arma::vec mean;
+
+		// 6x6 unbiased sample covariance of the cartesian state
+		arma::mat covariance;
+
+	};
+
+	/**
+	Monte Carlo propagation of perturbed samples around a nominal orbit. 
+	Each sample is prepared once when its block is processed, its Kepler solves are started from the nominal anomaly 
+	at the same time, and the cartesian states are reduced to their mean and covariance 
+	on the fly, so that the sample cloud is never stored. Samples are processed in blocks 
+	whose partial statistics are merged in a fixed order, so the results do not depend 
+	on the number of threads
+	*/
+	class Dispersion{
+
+	public:
+
+		/**
+		Propagates samples of keplerian elements
+		@param nominal nominal keplerian state
+		@param perturbations 6xS perturbations of the keplerian elements (a, e, i, Omega, omega, M0), 
+		one sample per column
+		@param times times since epoch at which the statistics are computed
+		@param block_size number of samples per reduction block
+		@return statistics at each of the prescribed times
+		*/
+		static std::vector<DispersionStatistics> propagate(const KepState & nominal,
+			const arma::mat & perturbations,
+			const arma::vec & times,
+			unsigned int block_size = 1024);
+
+		/**
+		Propagates samples of cartesian states
+		@param nominal nominal cartesian state, at epoch
+		@param perturbations 6xS perturbations of the cartesian state, one sample per column
+		@param times times since epoch at which the statistics are computed
+		@param block_size number of samples per reduction block
+		@return statistics at each of the prescribed times
+		*/
+		static std::vector<DispersionStatistics> propagate(const CartState & nominal,
+			const arma::mat & perturbations,
+			const arma::vec & times,
+			unsigned int block_size = 1024);
+
+	protected:
+
+		/**
+		Streaming mean and packed upper-triangular sum of squared deviations (Welford)
+		*/
+		struct MomentAccumulator{
+
+			double count = 0;
+			double mean[6] = {0,0,0,0,0,0};
+			double M2[21] = {0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0};
+
+			void add(const double * x);
+			void merge(const MomentAccumulator & other);
+
+		};
+
+		static std::vector<DispersionStatistics> propagate(const arma::vec & nominal_state,
+			double mu,
+			bool cartesian,
+			const arma::mat & perturbations,
+			const arma::vec & times,
+			unsigned int block_size);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
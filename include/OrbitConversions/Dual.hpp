@@ -0,0 +1,152 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef DUAL_HEADER 
+#define DUAL_HEADER
+
+#include <cmath>
+
+namespace OC{
+
+	/**
+	Forward-mode dual number carrying the partials of a value with respect to N inputs. 
+	Used to obtain exact Jacobians of the conversion kernels in a single pass
+	*/
+	template <unsigned int N> struct Dual{
+
+		Dual(double value = 0) : v(value){
+			for (unsigned int k = 0; k < N; ++k){
+				this -> d[k] = 0;
+			}
+		}
+
+		/**
+		Creates the k-th independent variable
+		@param value value of the variable
+		@param k index of the variable
+		@return dual number with unit partial with respect to the k-th input
+		*/
+		static Dual variable(double value,unsigned int k){
+			Dual x(value);
+			x.d[k] = 1;
+			return x;
+		}
+
+		// Value
+		double v;
+
+		// Partials
+		double d[N];
+
+	};
+
+	template <unsigned int N> Dual<N> chain(const Dual<N> & x,double value,double derivative){
+		Dual<N> y(value);
+		for (unsigned int k = 0; k < N; ++k){
+			y.d[k] = derivative * x.d[k];
+		}
+		return y;
+	}
+
+	template <unsigned int N> Dual<N> operator+(const Dual<N> & x,const Dual<N> & y){
+		Dual<N> z(x.v + y.v);
+		for (unsigned int k = 0; k < N; ++k){
+			z.d[k] = x.d[k] + y.d[k];
+		}
+		return z;
+	}
+
+	template <unsigned int N> Dual<N> operator-(const Dual<N> & x,const Dual<N> & y){
+		Dual<N> z(x.v - y.v);
+		for (unsigned int k = 0; k < N; ++k){
+			z.d[k] = x.d[k] - y.d[k];
+		}
+		return z;
+	}
+
+	template <unsigned int N> Dual<N> operator-(const Dual<N> & x){
+		return chain(x,- x.v,-1);
+	}
+
+	template <unsigned int N> Dual<N> operator*(const Dual<N> & x,const Dual<N> & y){
+		Dual<N> z(x.v * y.v);
+		for (unsigned int k = 0; k < N; ++k){
+			z.d[k] = x.d[k] * y.v + x.v * y.d[k];
+		}
+		return z;
+	}
+
+	template <unsigned int N> Dual<N> operator/(const Dual<N> & x,const Dual<N> & y){
+		Dual<N> z(x.v / y.v);
+		for (unsigned int k = 0; k < N; ++k){
+			z.d[k] = (x.d[k] - z.v * y.d[k]) / y.v;
+		}
+		return z;
+	}
+
+	template <unsigned int N> Dual<N> operator+(const Dual<N> & x,double y){ return chain(x,x.v + y,1); }
+	template <unsigned int N> Dual<N> operator+(double x,const Dual<N> & y){ return chain(y,x + y.v,1); }
+	template <unsigned int N> Dual<N> operator-(const Dual<N> & x,double y){ return chain(x,x.v - y,1); }
+	template <unsigned int N> Dual<N> operator-(double x,const Dual<N> & y){ return chain(y,x - y.v,-1); }
+	template <unsigned int N> Dual<N> operator*(const Dual<N> & x,double y){ return chain(x,x.v * y,y); }
+	template <unsigned int N> Dual<N> operator*(double x,const Dual<N> & y){ return chain(y,x * y.v,x); }
+	template <unsigned int N> Dual<N> operator/(const Dual<N> & x,double y){ return chain(x,x.v / y,1. / y); }
+	template <unsigned int N> Dual<N> operator/(double x,const Dual<N> & y){ return chain(y,x / y.v,- x / (y.v * y.v)); }
+
+	template <unsigned int N> bool operator<(const Dual<N> & x,double y){ return x.v < y; }
+	template <unsigned int N> bool operator>(const Dual<N> & x,double y){ return x.v > y; }
+
+	template <unsigned int N> Dual<N> sin(const Dual<N> & x){ return chain(x,std::sin(x.v),std::cos(x.v)); }
+	template <unsigned int N> Dual<N> cos(const Dual<N> & x){ return chain(x,std::cos(x.v),- std::sin(x.v)); }
+	template <unsigned int N> Dual<N> tan(const Dual<N> & x){ double t = std::tan(x.v); return chain(x,t,1 + t * t); }
+	template <unsigned int N> Dual<N> sinh(const Dual<N> & x){ return chain(x,std::sinh(x.v),std::cosh(x.v)); }
+	template <unsigned int N> Dual<N> cosh(const Dual<N> & x){ return chain(x,std::cosh(x.v),std::sinh(x.v)); }
+	template <unsigned int N> Dual<N> tanh(const Dual<N> & x){ double t = std::tanh(x.v); return chain(x,t,1 - t * t); }
+	template <unsigned int N> Dual<N> sqrt(const Dual<N> & x){ double s = std::sqrt(x.v); return chain(x,s,0.5 / s); }
+	template <unsigned int N> Dual<N> abs(const Dual<N> & x){ return x.v < 0 ? - x : x; }
+	template <unsigned int N> Dual<N> atan(const Dual<N> & x){ return chain(x,std::atan(x.v),1. / (1 + x.v * x.v)); }
+	template <unsigned int N> Dual<N> atanh(const Dual<N> & x){ return chain(x,std::atanh(x.v),1. / (1 - x.v * x.v)); }
+	template <unsigned int N> Dual<N> acos(const Dual<N> & x){ return chain(x,std::acos(x.v),- 1. / std::sqrt(1 - x.v * x.v)); }
+
+	template <unsigned int N> Dual<N> atan2(const Dual<N> & y,const Dual<N> & x){
+		Dual<N> z(std::atan2(y.v,x.v));
+		double r2 = x.v * x.v + y.v * y.v;
+		for (unsigned int k = 0; k < N; ++k){
+			z.d[k] = (x.v * y.d[k] - y.v * x.d[k]) / r2;
+		}
+		return z;
+	}
+
+	/**
+	Value of a double or of a dual number
+	*/
+	inline double value(double x){
+		return x;
+	}
+
+	template <unsigned int N> double value(const Dual<N> & x){
+		return x.v;
+	}
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,203 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef ECLIPSE_HEADER 
+#define ECLIPSE_HEADER
+
+#include "OrbitConversions/KepState.hpp"
+#include "OrbitConversions/StateCatalog.hpp"
+#include <vector>
+
+namespace OC{
+
+	enum ShadowModel{
+
+		// Shadow cylinder of the same radius as the central body. Only produces umbra intervals
+		CYLINDRICAL = 0,
+
+		// Umbra and penumbra cones, accounting for the finite size of the Sun
+		CONICAL = 1
+	};
+
+	enum ShadowType{
+		SUNLIT = 0,
+		PENUMBRA = 1,
+		UMBRA = 2
+	};
+
+	/**
+	Geometry of the shadow cast by the central body. 
+	Lengths are expressed in the length unit of the states
+	*/
+	struct ShadowGeometry{
+
+		ShadowModel model = CYLINDRICAL;
+
+		// Unit vector from the central body to the Sun, held fixed over the time window
+		arma::vec::fixed<3> sun_direction = {1,0,0};
+
+		// Radius of the central body
+		double body_radius = 1;
+
+		// Radius of the Sun and distance from the central body to the Sun. Only used by the CONICAL model
+		double sun_radius = 0;
+		double sun_distance = 1;
+
+	};
+
+	/**
+	Row of the eclipse table
+	*/
+	struct EclipseInterval{
+
+		// Index of the object in the catalog
+		unsigned int object;
+
+		// PENUMBRA or UMBRA. A penumbra interval spans the whole shadow crossing and contains the umbra interval, if any
+		ShadowType type;
+
+		// Times since epoch of shadow entry and exit, clipped to the time window
+		double t_entry;
+		double t_exit;
+
+	};
+
+	class Eclipse{
+
+	public:
+
+		/**
+		Computes the shadow intervals of every object in the catalog over a time window. 
+		The Keplerian orbit being fixed in space and the Sun direction being held constant, 
+		the shadow arcs of an elliptic orbit are the same at every revolution: they are bracketed 
+		once per object by sampling the shadow function in eccentric anomaly, refined by root finding 
+		on the eccentric anomaly, and mapped to every revolution of the window through Kepler's equation, 
+		which is evaluated in the direct direction only. Hyperbolic objects are sampled in hyperbolic anomaly 
+		over the window. Passages grazing the shadow between two samples are caught by refining the 
+		local minima of the sampled shadow function. Near-parabolic orbits are not special-cased
+		@param catalog keplerian states sharing a common epoch
+		@param geometry shadow geometry
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param samples number of bracketing samples per revolution (elliptic) or over the window (hyperbolic)
+		@return flat eclipse table, sorted by entry time
+		*/
+		static std::vector<EclipseInterval> find_eclipses(const std::vector<KepState> & catalog,
+			const ShadowGeometry & geometry,
+			double t0,double t1,
+			unsigned int samples = 72);
+
+		/**
+		Same as above, on a state catalog
+		@param catalog keplerian catalog
+		@param geometry shadow geometry
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param samples number of bracketing samples per revolution (elliptic) or over the window (hyperbolic)
+		@return flat eclipse table, sorted by entry time
+		*/
+		static std::vector<EclipseInterval> find_eclipses(const KepCatalog & catalog,
+			const ShadowGeometry & geometry,
+			double t0,double t1,
+			unsigned int samples = 72);
+
+		/**
+		Appends the shadow intervals of one object to an eclipse table
+		@param kep pointer to the 6 orbital elements (a, e, i, Omega, omega, M0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param geometry shadow geometry
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param object index of the object
+		@param samples number of bracketing samples
+		@param intervals eclipse table to append to
+		*/
+		static void add_eclipses(const double * kep,double mu,
+			const ShadowGeometry & geometry,
+			double t0,double t1,
+			unsigned int object,
+			unsigned int samples,
+			std::vector<EclipseInterval> & intervals);
+
+		/**
+		Classifies a position
+		@param position pointer to the 3 components of the position
+		@param geometry shadow geometry
+		@return SUNLIT, PENUMBRA or UMBRA
+		*/
+		static ShadowType get_shadow(const double * position,const ShadowGeometry & geometry);
+
+	protected:
+
+		/**
+		Concatenates per-object eclipse tables and sorts the result by entry time, then object
+		@param intervals_per_object eclipse tables of each object
+		@return flat eclipse table
+		*/
+		static std::vector<EclipseInterval> merge_intervals(const std::vector<std::vector<EclipseInterval> > & intervals_per_object);
+
+		/**
+		Radius of the umbra and penumbra cross-sections at distance xi behind the 
+		central body along the anti-Sun axis, in the form radius + slope * xi
+		@param geometry shadow geometry
+		@param umbra pointer to 2 doubles receiving (radius, slope) of the umbra
+		@param penumbra pointer to 2 doubles receiving (radius, slope) of the penumbra
+		*/
+		static void get_shadow_cones(const ShadowGeometry & geometry,double * umbra,double * penumbra);
+
+		/**
+		Shadow function, negative inside the shadow cone and continuous along the orbit
+		@param x position along the periapsis direction
+		@param y position along the in-plane direction 90 deg ahead of periapsis
+		@param alpha component of the Sun direction along the periapsis direction
+		@param beta component of the Sun direction along the in-plane direction 90 deg ahead of periapsis
+		@param cone (radius, slope) of the shadow cone
+		@return shadow function
+		*/
+		static double shadow_function(double x,double y,double alpha,double beta,const double * cone);
+
+		/**
+		Finds the anomaly arcs spent inside a shadow cone
+		@param a semi-major axis
+		@param e eccentricity
+		@param alpha component of the Sun direction along the periapsis direction
+		@param beta component of the Sun direction along the in-plane direction 90 deg ahead of periapsis
+		@param cone (radius, slope) of the shadow cone
+		@param anomaly_start start of the eccentric (elliptic) or hyperbolic anomaly range
+		@param anomaly_end end of the anomaly range
+		@param periodic true if the range covers a full revolution
+		@param samples number of bracketing samples
+		@param arcs set to the (entry, exit) anomalies. For periodic ranges, the exit anomaly may exceed anomaly_end
+		*/
+		static void find_shadow_arcs(double a,double e,
+			double alpha,double beta,
+			const double * cone,
+			double anomaly_start,double anomaly_end,
+			bool periodic,
+			unsigned int samples,
+			std::vector<std::pair<double,double> > & arcs);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,123 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef EQUINOCTIALSTATE_HEADER 
+#define EQUINOCTIALSTATE_HEADER
+
+#include "OrbitConversions/State.hpp"
+#include "OrbitConversions/CartState.hpp"
+
+namespace OC{
+
+	class CartState;
+	class EquinoctialState : public State{
+
+	public: 
+
+		/**
+		Constructor
+		@param state 6x1 vector of modified equinoctial elements ordered like so :
+		- p : semi-latus rectum [L]
+		- f : e * cos(omega + Omega) [-]
+		- g : e * sin(omega + Omega) [-]
+		- h : tan(i/2) * cos(Omega) [-]
+		- k : tan(i/2) * sin(Omega) [-]
+		- L0 : true longitude Omega + omega + true anomaly at epoch [rad]
+		The elements are non-singular for circular and equatorial orbits, 
+		but not for retrograde equatorial orbits (i = pi)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		*/
+		EquinoctialState(arma::vec state,double mu);
+		EquinoctialState();
+
+		/**
+		Returns orbit energy
+		@return energy (J)
+		*/
+		virtual double get_energy() const;
+
+		/**
+		Returns orbit sma
+		@return sma (m)
+		*/
+		virtual double get_a() const;
+
+		/**
+		Returns orbit eccentricity
+		@return eccentricity (-)
+		*/
+		virtual double get_eccentricity() const;
+
+		/**
+		Returns orbit momentum
+		@return orbit momentum (m^2/s)
+		*/
+		virtual double get_momentum() const;
+
+		double get_p() const;
+		double get_f() const;
+		double get_g() const;
+		double get_h() const;
+		double get_k() const;
+		double get_L0() const;
+
+		/* 
+		Returns the cartesian state corresponding to the 
+		equinoctial state
+		@param delta_T time since epoch
+		@return cartesian state vector (x, y, z, x_dot, y_dot, z_dot)
+		*/
+		CartState convert_to_cart(double delta_T) const;
+
+		/**
+		Propagates the true longitude by solving the equinoctial Kepler equation 
+		lambda = F - f * sin(F) + g * cos(F) for the eccentric longitude F (elliptic orbits).
+		Hyperbolic orbits are propagated through the hyperbolic anomaly
+		@param elements pointer to the 6 modified equinoctial elements (p,f,g,h,k,L)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T propagation time
+		@return true longitude delta_T after the epoch of the elements
+		*/
+		static double propagate_true_longitude(const double * elements,double mu,double delta_T);
+
+		/**
+		Allocation-free kernel behind convert_to_cart
+		@param elements pointer to the 6 modified equinoctial elements at epoch
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart pointer to 6 doubles receiving the cartesian state
+		*/
+		static void to_cart_kernel(const double * elements,double mu,double delta_T,double * cart);
+
+		/**
+		Allocation-free kernel behind CartState::convert_to_equinoctial
+		@param cart pointer to the 6 components of the cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch of the cartesian state
+		@param elements pointer to 6 doubles receiving the modified equinoctial elements at epoch
+		*/
+		static void from_cart_kernel(const double * cart,double mu,double delta_T,double * elements);
+
+	};
+
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef EVENTFINDER_HEADER 
+#define EVENTFINDER_HEADER
+
+#include "OrbitConversions/KepState.hpp"
+#include <vector>
+
+namespace OC{
+
+	enum EventType{
+		PERIAPSIS = 1,
+		APOAPSIS = 2,
+		ASCENDING_NODE = 4,
+		DESCENDING_NODE = 8,
+		TRUE_ANOMALY = 16,
+		ALL_EVENTS = 31
+	};
+
+	/**
+	Row of the event table
+	*/
+	struct OrbitEvent{
+
+		// Time since epoch of the event
+		double t;
+
+		// Index of the object in the catalog
+		unsigned int object;
+
+		// Type of the event
+		EventType type;
+
+		// Index of the true anomaly target, if type == TRUE_ANOMALY
+		unsigned int target;
+
+	};
+
+	class EventFinder{
+
+	public:
+
+		/**
+		Computes the times of the apsis, node and true anomaly crossings of every object 
+		in the catalog over a time window. The crossing times are obtained in closed form
+		from the mean anomaly, so no sampling is involved. Hyperbolic objects cross each event at most once
+		and have no apoapsis. Equatorial objects have no node events
+		@param catalog keplerian states sharing a common epoch
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param true_anomaly_targets true anomalies whose crossings are sought (rad)
+		@param event_types bitwise OR of the EventType values to report
+		@param node_inclination_tolerance node events are skipped for objects with |sin(i)| below this value
+		@return flat event table, sorted by time, then object, type and target
+		*/
+		static std::vector<OrbitEvent> find_events(const std::vector<KepState> & catalog,
+			double t0,double t1,
+			const std::vector<double> & true_anomaly_targets = std::vector<double>(),
+			unsigned int event_types = ALL_EVENTS,
+			double node_inclination_tolerance = 1e-8);
+
+		/**
+		Appends the crossing times of a given true anomaly to an event table
+		@param kep keplerian state
+		@param f true anomaly (rad)
+		@param t0 start of the time window (time since epoch)
+		@param t1 end of the time window (time since epoch)
+		@param object index of the object
+		@param type type of the event
+		@param target index of the true anomaly target
+		@param events event table to append to
+		*/
+		static void add_true_anomaly_crossings(const KepState & kep,
+			double f,
+			double t0,double t1,
+			unsigned int object,
+			EventType type,
+			unsigned int target,
+			std::vector<OrbitEvent> & events);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
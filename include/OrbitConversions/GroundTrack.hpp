@@ -0,0 +1,209 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef GROUNDTRACK_HEADER 
+#define GROUNDTRACK_HEADER
+
+#include <armadillo>
+#include <vector>
+#include <functional>
+
+namespace OC{
+
+	/**
+	Uniformly rotating ellipsoidal Earth. The Earth-fixed frame is obtained
+	by rotating the inertial frame about its z-axis by theta_0 + omega * t
+	*/
+	struct EarthModel{
+
+		EarthModel(double equatorial_radius = 6378.137,
+			double flattening = 1. / 298.257223563,
+			double omega = 7.2921150e-5,
+			double theta_0 = 0) : equatorial_radius(equatorial_radius), 
+		flattening(flattening),
+		omega(omega),
+		theta_0(theta_0){}
+
+		// Equatorial radius [L]
+		double equatorial_radius;
+
+		// Flattening of the ellipsoid [-]
+		double flattening;
+
+		// Rotation rate [rad/T]
+		double omega;
+
+		// Rotation angle at epoch [rad]
+		double theta_0;
+
+	};
+
+	/**
+	Ground station
+	*/
+	struct GroundStation{
+
+		GroundStation(double latitude = 0,
+			double longitude = 0,
+			double altitude = 0,
+			double min_elevation = 0) : latitude(latitude),
+		longitude(longitude),
+		altitude(altitude),
+		min_elevation(min_elevation){}
+
+		// Geodetic latitude [rad]
+		double latitude;
+
+		// Longitude [rad]
+		double longitude;
+
+		// Altitude above the ellipsoid [L]
+		double altitude;
+
+		// Elevation mask [rad]
+		double min_elevation;
+
+	};
+
+	/**
+	Time interval during which an object is above the elevation mask of a station
+	*/
+	struct VisibilityWindow{
+
+		// Index of the object
+		unsigned int object;
+
+		// Index of the station
+		unsigned int station;
+
+		// Rise time (start of the time grid if the object is already visible)
+		double rise;
+
+		// Set time (end of the time grid if the object is still visible)
+		double set;
+
+		// Largest sampled elevation over the window [rad]
+		double max_elevation;
+
+	};
+
+	class GroundTrack{
+
+	public:
+
+		/**
+		Computes the Earth-fixed positions and the geodetic coordinates of a trajectory
+		@param trajectory 6xK (or 3xK) inertial states sampled at times
+		@param times K sample times since epoch
+		@param earth_model Earth model
+		@param ecef_positions set to the 3xK Earth-fixed positions
+		@param lla set to the 3xK geodetic coordinates (latitude [rad], longitude [rad], altitude [L])
+		*/
+		static void compute_ground_track(const arma::mat & trajectory,
+			const arma::vec & times,
+			const EarthModel & earth_model,
+			arma::mat & ecef_positions,
+			arma::mat & lla);
+
+		/**
+		Computes the ground tracks of a set of trajectories sharing the same time grid, in parallel
+		@param trajectories 6xK (or 3xK) inertial states of each object
+		@param times K sample times since epoch
+		@param earth_model Earth model
+		@param lla set to the 3xK geodetic coordinates of each object
+		*/
+		static void compute_ground_tracks(const std::vector<arma::mat> & trajectories,
+			const arma::vec & times,
+			const EarthModel & earth_model,
+			std::vector<arma::mat> & lla);
+
+		/**
+		Computes the azimuth and elevation of a trajectory as seen from a station
+		@param trajectory 6xK (or 3xK) inertial states sampled at times
+		@param times K sample times since epoch
+		@param station ground station
+		@param earth_model Earth model
+		@param azimuth_elevation set to the 2xK azimuth (from north, towards east) and elevation [rad]
+		*/
+		static void compute_azimuth_elevation(const arma::mat & trajectory,
+			const arma::vec & times,
+			const GroundStation & station,
+			const EarthModel & earth_model,
+			arma::mat & azimuth_elevation);
+
+		/**
+		Finds the visibility windows of many objects from many stations. The elevation 
+		is sampled on the time grid, and each crossing of the elevation mask is refined by root finding 
+		on a cubic Hermite interpolation of the inertial trajectory between the bracketing samples.
+		Objects are processed in parallel, in chunks whose windows are streamed to a callback once complete
+		@param trajectories 6xK inertial states of each object
+		@param times K sample times since epoch
+		@param stations ground stations
+		@param earth_model Earth model
+		@param callback called with the windows of each chunk of objects, in object order. 
+		Windows are ordered by object, station and rise time
+		@param chunk_size number of objects per chunk
+		*/
+		static void compute_visibility(const std::vector<arma::mat> & trajectories,
+			const arma::vec & times,
+			const std::vector<GroundStation> & stations,
+			const EarthModel & earth_model,
+			const std::function<void(const std::vector<VisibilityWindow> &)> & callback,
+			unsigned int chunk_size = 256);
+
+		/**
+		Same as above, but collects all the windows
+		@return windows, ordered by object, station and rise time
+		*/
+		static std::vector<VisibilityWindow> compute_visibility(const std::vector<arma::mat> & trajectories,
+			const arma::vec & times,
+			const std::vector<GroundStation> & stations,
+			const EarthModel & earth_model);
+
+		/**
+		Computes the Earth-fixed position of a point given by its geodetic coordinates
+		@param latitude geodetic latitude [rad]
+		@param longitude longitude [rad]
+		@param altitude altitude above the ellipsoid [L]
+		@param earth_model Earth model
+		@return Earth-fixed position
+		*/
+		static arma::vec::fixed<3> get_ecef_position(double latitude,double longitude,double altitude,const EarthModel & earth_model);
+
+	protected:
+
+		static void inertial_to_ecef(const double * r,double t,const EarthModel & earth_model,double * r_ecef);
+		static void ecef_to_lla(const double * r_ecef,const EarthModel & earth_model,double * lla);
+		static double get_sin_elevation(const double * r_ecef,const double * station_ecef,const double * up);
+		static void interpolate_position(const double * state_0,const double * state_1,double t_0,double t_1,double t,double * r);
+		static void compute_object_visibility(const arma::mat & trajectory,
+			const arma::vec & times,
+			const std::vector<GroundStation> & stations,
+			const EarthModel & earth_model,
+			unsigned int object,
+			std::vector<VisibilityWindow> & windows);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
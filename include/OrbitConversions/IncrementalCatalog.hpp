@@ -0,0 +1,184 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef INCREMENTALCATALOG_HEADER 
+#define INCREMENTALCATALOG_HEADER
+
+#include "OrbitConversions/StateCatalog.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Partition of the objects of a catalog into a fixed number of parts, 
+	where moving one object costs O(1). The members of a part are not sorted
+	*/
+	class CatalogPartition{
+
+	public:
+
+		/**
+		Constructor. All the objects start in part 0
+		@param N number of objects
+		@param parts number of parts
+		*/
+		CatalogPartition(unsigned int N,unsigned int parts);
+
+		/**
+		Moves object i to a part
+		@param i object index
+		@param part destination part
+		*/
+		void assign(unsigned int i,unsigned int part);
+
+		/**
+		Returns the part of object i
+		@param i object index
+		@return part
+		*/
+		unsigned int get_part(unsigned int i) const;
+
+		/**
+		Returns the members of a part
+		@param part part index
+		@return object indices, in no particular order
+		*/
+		const std::vector<unsigned int> & get_members(unsigned int part) const;
+
+		unsigned int get_parts() const;
+
+	protected:
+
+		std::vector<std::vector<unsigned int> > members;
+
+		// Part of each object and its position among the members of that part
+		std::vector<unsigned int> part_of;
+		std::vector<unsigned int> position;
+
+	};
+
+	/**
+	Cartesian catalog whose keplerian elements, derived quantities and secondary indexes 
+	are kept up to date incrementally. Updated objects are flagged dirty, and refresh 
+	reconverts only them, in a single batch, so that the cost of a tracking cycle scales with 
+	the number of updates rather than with the size of the catalog. 
+	All the states are given at the same epoch
+	*/
+	class IncrementalCatalog{
+
+	public:
+
+		/**
+		Constructor. The whole catalog is converted once
+		@param cart_states 6xN cartesian states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param shell_radii increasing radii bounding the perigee/apogee shells. Shell s holds the 
+		radii in [shell_radii[s - 1],shell_radii[s]), shell 0 the radii below shell_radii[0] 
+		and the last shell the radii above the last bound, so that there are shell_radii.size() + 1 shells
+		*/
+		IncrementalCatalog(const arma::mat & cart_states,double mu,const std::vector<double> & shell_radii);
+
+		/**
+		Overwrites the cartesian state of object i and flags it dirty. 
+		The keplerian state, derived quantities and indexes of the object are stale until the next refresh
+		@param i object index
+		@param state pointer to the 6 components of the new cartesian state
+		*/
+		void update(unsigned int i,const double * state);
+
+		/**
+		Reconverts the dirty objects and updates their derived quantities and indexes
+		@return number of reconverted objects
+		*/
+		unsigned int refresh();
+
+		/**
+		Returns the number of objects updated since the last refresh
+		@return number of dirty objects
+		*/
+		unsigned int get_dirty_count() const;
+
+		unsigned int get_size() const;
+
+		const CartCatalog & get_cart_catalog() const;
+		const KepCatalog & get_kep_catalog() const;
+
+		// Derived quantities of object i, as of the last refresh
+		double get_a(unsigned int i) const;
+		double get_eccentricity(unsigned int i) const;
+		double get_n(unsigned int i) const;
+		double get_parameter(unsigned int i) const;
+		double get_energy(unsigned int i) const;
+		double get_perigee_radius(unsigned int i) const;
+
+		/**
+		Returns the apogee radius of object i, as of the last refresh
+		@param i object index
+		@return apogee radius, infinite if the orbit is not elliptic
+		*/
+		double get_apogee_radius(unsigned int i) const;
+
+		/**
+		Returns the shell holding a radius
+		@param radius radius
+		@return shell index
+		*/
+		unsigned int get_shell(double radius) const;
+
+		// Secondary indexes, as of the last refresh
+		const CatalogPartition & get_perigee_shells() const;
+		const CatalogPartition & get_apogee_shells() const;
+
+		/**
+		Returns the partition of the catalog by orbit regime
+		@return partition indexed by OrbitRegime
+		*/
+		const CatalogPartition & get_regimes() const;
+
+	protected:
+
+		double mu;
+		std::vector<double> shell_radii;
+
+		CartCatalog cart_catalog;
+		KepCatalog kep_catalog;
+
+		std::vector<double> n;
+		std::vector<double> parameter;
+		std::vector<double> energy;
+		std::vector<double> perigee_radius;
+		std::vector<double> apogee_radius;
+
+		CatalogPartition perigee_shells;
+		CatalogPartition apogee_shells;
+		CatalogPartition regimes;
+
+		// Dirty objects, each listed once
+		std::vector<unsigned int> dirty;
+		std::vector<char> is_dirty;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -102,6 +102,14 @@ namespace OC{
 
 		CartState convert_to_cart(double delta_T) const;
 
+		/* 
+		Same as above, with the convergence settings of the Kepler solve given by a policy
+		@param delta_T time since epoch
+		@param policy solver policy
+		@return cartesian state vector (x, y, z, x_dot, y_dot, z_dot)
+		*/
+		CartState convert_to_cart(double delta_T,const SolverPolicy & policy) const;
+
 		
 	protected:
 
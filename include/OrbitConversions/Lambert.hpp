@@ -0,0 +1,164 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef LAMBERT_HEADER 
+#define LAMBERT_HEADER
+
+#include "OrbitConversions/CartState.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Solution of Lambert's problem
+	*/
+	struct LambertSolution{
+
+		// Cartesian state at departure
+		CartState departure;
+
+		// Cartesian state at arrival
+		CartState arrival;
+
+		// Number of complete revolutions
+		unsigned int revolutions;
+
+		// True if this is the low-energy (left) branch of a multi-revolution solution
+		bool low_path;
+
+	};
+
+	/**
+	Lambert solver following Izzo's formulation (Izzo, D. "Revisiting Lambert's problem", 
+	Celestial Mechanics and Dynamical Astronomy, 2015), with Householder iterations 
+	on the time-of-flight equation and multi-revolution support
+	*/
+	class Lambert{
+
+	public:
+
+		/**
+		Finds all the solutions of Lambert's problem
+		@param r1 departure position
+		@param r2 arrival position
+		@param tof time of flight (> 0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param prograde if true, the transfer has a positive z-component of angular momentum
+		@param max_revolutions maximum number of complete revolutions to consider
+		@return solutions ordered by number of revolutions. Each multi-revolution pair is ordered low path first
+		*/
+		static std::vector<LambertSolution> solve(const arma::vec::fixed<3> & r1,
+			const arma::vec::fixed<3> & r2,
+			double tof,
+			double mu,
+			bool prograde = true,
+			unsigned int max_revolutions = 100);
+
+		/**
+		Finds the solution of Lambert's problem for a given number of revolutions and branch
+		@param r1 departure position
+		@param r2 arrival position
+		@param tof time of flight (> 0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param revolutions number of complete revolutions
+		@param low_path branch of the multi-revolution solution (ignored if revolutions == 0)
+		@param prograde if true, the transfer has a positive z-component of angular momentum
+		@param departure set to the cartesian state at departure
+		@param arrival set to the cartesian state at arrival
+		@return true if a solution exists and was found
+		*/
+		static bool solve(const arma::vec::fixed<3> & r1,
+			const arma::vec::fixed<3> & r2,
+			double tof,
+			double mu,
+			unsigned int revolutions,
+			bool low_path,
+			bool prograde,
+			CartState & departure,
+			CartState & arrival);
+
+		/**
+		Allocation-free kernel behind the other solve methods
+		@param r1 pointer to the 3 components of the departure position
+		@param r2 pointer to the 3 components of the arrival position
+		@param tof time of flight (> 0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param revolutions number of complete revolutions
+		@param low_path branch of the multi-revolution solution (ignored if revolutions == 0)
+		@param prograde if true, the transfer has a positive z-component of angular momentum
+		@param v1 pointer to 3 doubles receiving the departure velocity
+		@param v2 pointer to 3 doubles receiving the arrival velocity
+		@param x on input, initial guess of Izzo's x variable if finite (warm start), 
+		otherwise ignored. On output, converged value of x
+		@return true if a solution exists and was found. A warm start that converges 
+		onto the other multi-revolution branch is reported as a failure
+		*/
+		static bool solve(const double * r1,
+			const double * r2,
+			double tof,
+			double mu,
+			unsigned int revolutions,
+			bool low_path,
+			bool prograde,
+			double * v1,
+			double * v2,
+			double & x);
+
+		/**
+		Returns the largest number of complete revolutions for which a solution exists
+		@param r1 departure position
+		@param r2 arrival position
+		@param tof time of flight (> 0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param prograde if true, the transfer has a positive z-component of angular momentum
+		@return maximum number of revolutions
+		*/
+		static unsigned int get_max_revolutions(const arma::vec::fixed<3> & r1,
+			const arma::vec::fixed<3> & r2,
+			double tof,
+			double mu,
+			bool prograde = true);
+
+	protected:
+
+		static bool get_geometry(const double * r1,const double * r2,double tof,double mu,bool prograde,
+			double & lambda,double & T,double * i_r1,double * i_r2,double * i_t1,double * i_t2,
+			double & r1_norm,double & r2_norm,double & c_norm,double & s);
+
+		static unsigned int get_max_revolutions(double lambda,double T);
+
+		static double compute_y(double x,double lambda);
+		static double compute_psi(double x,double y,double lambda);
+		static double hypergeometric_series(double z);
+		static double tof_equation(double x,double y,double T0,double lambda,unsigned int M);
+		static double tof_derivative(double x,double y,double T,double lambda);
+		static double tof_second_derivative(double x,double y,double T,double dT,double lambda);
+		static double tof_third_derivative(double x,double y,double dT,double ddT,double lambda);
+		static double initial_guess(double T,double lambda,unsigned int M,bool low_path);
+		static bool householder(double & x,double T,double lambda,unsigned int M);
+		static bool compute_T_min(double lambda,unsigned int M,double & T_min);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
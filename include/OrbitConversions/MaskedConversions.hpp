@@ -0,0 +1,217 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MASKEDCONVERSIONS_HEADER 
+#define MASKEDCONVERSIONS_HEADER
+
+#include "OrbitConversions/BatchConversions.hpp"
+
+namespace OC{
+
+	/**
+	Variants of the keplerian conversions computing a subset of their outputs. 
+	The mask is a template parameter, so each variant compiles into a kernel from which the 
+	work behind the other outputs (velocity, Kepler inverse, acos/atan2 of the angles) has been 
+	removed. The outputs are packed: a state holds the requested components only, in their usual order, 
+	e.g (a, e, i) for KEP_SHAPE or (x, y, z) for CART_POSITION. 
+	The kernels are those of BatchConversions, instantiated on the mask, so the requested 
+	components are identical to those of the batch conversions
+	*/
+	class MaskedConversions{
+
+	public:
+
+		/**
+		Returns the number of outputs in a mask
+		@param mask output mask
+		@return number of outputs
+		*/
+		static constexpr unsigned int get_size(unsigned int mask){
+			return mask == 0 ? 0 : (mask & 1) + MaskedConversions::get_size(mask >> 1);
+		}
+
+		/**
+		Returns the number of rows of the packed outputs of a cartesian mask
+		@param mask output mask
+		@return 3 per requested vector
+		*/
+		static constexpr unsigned int get_cart_size(unsigned int mask){
+			return 3 * MaskedConversions::get_size(mask);
+		}
+
+		/**
+		Returns the position of an output among the packed outputs of a mask
+		@param mask output mask
+		@param output single output
+		@return position
+		*/
+		static constexpr unsigned int get_slot(unsigned int mask,unsigned int output){
+			return MaskedConversions::get_size(mask & (output - 1));
+		}
+
+		/**
+		Masked counterpart of KepState::convert_to_cart
+		@param kep keplerian state
+		@param delta_T time since epoch
+		@param policy Kepler solver policy
+		@return requested cartesian components
+		*/
+		template <unsigned int mask> static arma::vec convert_to_cart(const KepState & kep,double delta_T,
+			const SolverPolicy & policy = SolverPolicy::default_policy()){
+			arma::vec elements = kep.get_state();
+			arma::vec cart(MaskedConversions::get_cart_size(mask));
+			MaskedConversions::kep_to_cart_kernel<mask>(elements.memptr(),kep.get_mu(),delta_T,cart.memptr(),policy);
+			return cart;
+		}
+
+		/**
+		Masked counterpart of CartState::convert_to_kep
+		@param cart cartesian state
+		@param delta_T time since epoch
+		@return requested keplerian elements
+		*/
+		template <unsigned int mask> static arma::vec convert_to_kep(const CartState & cart,double delta_T){
+			arma::vec state = cart.get_state();
+			arma::vec kep(MaskedConversions::get_size(mask));
+			MaskedConversions::cart_to_kep_kernel<mask>(state.memptr(),cart.get_mu(),delta_T,kep.memptr());
+			return kep;
+		}
+
+		/**
+		Masked counterpart of BatchConversions::kep_to_cart. Regimes are dispatched per column
+		@param kep_states 6xN keplerian states (a, e, i, Omega, omega, M0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart_states set to the requested cartesian components, one column per state
+		@param policy Kepler solver policy
+		*/
+		template <unsigned int mask> static void kep_to_cart(const arma::mat & kep_states,double mu,double delta_T,arma::mat & cart_states,
+			const SolverPolicy & policy = SolverPolicy::default_policy()){
+
+			unsigned int N = kep_states.n_cols;
+			cart_states.set_size(MaskedConversions::get_cart_size(mask),N);
+
+			#pragma omp parallel for
+			for (unsigned int i = 0; i < N; ++i){
+				MaskedConversions::kep_to_cart_kernel<mask>(kep_states.colptr(i),mu,delta_T,cart_states.colptr(i),policy);
+			}
+
+		}
+
+		/**
+		Masked counterpart of BatchConversions::cart_to_kep. Regimes are dispatched per column
+		@param cart_states 6xN cartesian states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep_states set to the requested keplerian elements, one column per state
+		*/
+		template <unsigned int mask> static void cart_to_kep(const arma::mat & cart_states,double mu,double delta_T,arma::mat & kep_states){
+
+			unsigned int N = cart_states.n_cols;
+			kep_states.set_size(MaskedConversions::get_size(mask),N);
+
+			#pragma omp parallel for
+			for (unsigned int i = 0; i < N; ++i){
+				MaskedConversions::cart_to_kep_kernel<mask>(cart_states.colptr(i),mu,delta_T,kep_states.colptr(i));
+			}
+
+		}
+
+		/**
+		Masked counterpart of the kep_to_cart kernels of BatchConversions
+		@param kep pointer to the 6 components of the keplerian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param cart pointer to get_cart_size(mask) doubles receiving the requested components
+		@param policy Kepler solver policy
+		*/
+		template <unsigned int mask> static void kep_to_cart_kernel(const double * kep,double mu,double delta_T,double * cart,
+			const SolverPolicy & policy = SolverPolicy::default_policy()){
+
+			switch (BatchConversions::get_regime(kep[1])){
+
+				case ELLIPTIC:
+				BatchConversions::kep_to_cart_elliptic_kernel<mask>(kep,mu,delta_T,cart,policy);
+				break;
+
+				case NEAR_PARABOLIC:
+				BatchConversions::kep_to_cart_near_parabolic_kernel<mask>(kep,mu,delta_T,cart,policy);
+				break;
+
+				case HYPERBOLIC:
+				BatchConversions::kep_to_cart_hyperbolic_kernel<mask>(kep,mu,delta_T,cart,policy);
+				break;
+
+			}
+
+		}
+
+		/**
+		Masked counterpart of BatchConversions::cart_to_kep_kernel
+		@param cart pointer to the 6 components of the cartesian state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param delta_T time since epoch
+		@param kep pointer to get_size(mask) doubles receiving the requested elements
+		*/
+		template <unsigned int mask> static void cart_to_kep_kernel(const double * cart,double mu,double delta_T,double * kep){
+
+			// Unrequested elements are computed into full only if other elements depend on them
+			double full[6];
+			BatchConversions::cart_to_shape_kernel<mask>(cart,mu,full);
+
+			// Near-parabolic orbits take a and M0 from their dedicated kernel
+			OrbitRegime regime = BatchConversions::get_regime(full[1]);
+
+			if (regime == NEAR_PARABOLIC && (mask & (KEP_A | KEP_M0))){
+				double near_parabolic[6];
+				BatchConversions::cart_to_kep_near_parabolic_kernel(cart,mu,delta_T,near_parabolic);
+				full[0] = near_parabolic[0];
+				full[5] = near_parabolic[5];
+			}
+			else if (mask & KEP_M0){
+				if (regime == ELLIPTIC){
+					BatchConversions::set_mean_anomaly_elliptic(full,mu,delta_T);
+				}
+				else{
+					BatchConversions::set_mean_anomaly_hyperbolic(full,mu,delta_T);
+				}
+			}
+
+			MaskedConversions::pack_kep<mask>(full,kep);
+
+		}
+
+	protected:
+
+		template <unsigned int mask> static void pack_kep(const double * full,double * kep){
+			for (unsigned int k = 0; k < 6; ++k){
+				if (mask & (1u << k)){
+					kep[MaskedConversions::get_slot(mask,1u << k)] = full[k];
+				}
+			}
+		}
+
+	};
+
+}
+
+#endif
\ No newline at end of file
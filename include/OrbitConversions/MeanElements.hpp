@@ -0,0 +1,139 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MEANELEMENTS_HEADER 
+#define MEANELEMENTS_HEADER
+
+#include "OrbitConversions/KepState.hpp"
+
+namespace OC{
+
+	/**
+	First-order J2 mapping between mean and osculating keplerian elements, following the 
+	Brouwer-Lyddane short- and long-period corrections (Schaub & Junkins, Analytical Mechanics 
+	of Space Systems, appendix on mean and osculating elements). The Lyddane form of the eccentricity, 
+	mean anomaly and node corrections keeps the mapping regular for small eccentricities. 
+	The mapping is singular at the critical inclinations (cos^2 i = 1/5), where osculating_to_mean 
+	refuses the states within critical_inclination_band, and only applies to elliptic orbits. 
+	The mean elements are stored in KepState, M0 then being the mean mean anomaly at epoch. 
+	Mean elements drift at the secular rates returned by get_secular_rates
+	*/
+	class MeanElements{
+
+	public:
+
+		/**
+		Maps mean elements to osculating elements
+		@param mean mean keplerian state
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@return osculating keplerian state
+		*/
+		static KepState mean_to_osculating(const KepState & mean,double J2,double body_radius);
+
+		/**
+		Maps osculating elements to mean elements. The first-order inverse mapping is refined by the 
+		fixed-point iteration mean <- mean + (osculating - mean_to_osculating(mean)), so that 
+		mean_to_osculating(osculating_to_mean(osculating)) reproduces osculating
+		@param osculating osculating keplerian state
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param tolerance convergence tolerance on the residual (relative on a, absolute on the other elements)
+		@param max_iterations iteration cap
+		@return mean keplerian state
+		*/
+		static KepState osculating_to_mean(const KepState & osculating,double J2,double body_radius,
+			double tolerance = 1e-13,unsigned int max_iterations = 50);
+
+		/**
+		Batch counterpart of mean_to_osculating
+		@param mean_states 6xN mean keplerian states (a, e, i, Omega, omega, M0)
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param osculating_states set to the 6xN osculating keplerian states
+		*/
+		static void mean_to_osculating(const arma::mat & mean_states,double J2,double body_radius,arma::mat & osculating_states);
+
+		/**
+		Batch counterpart of osculating_to_mean
+		@param osculating_states 6xN osculating keplerian states (a, e, i, Omega, omega, M0)
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param mean_states set to the 6xN mean keplerian states
+		@param tolerance convergence tolerance on the residual (relative on a, absolute on the other elements)
+		@param max_iterations iteration cap
+		*/
+		static void osculating_to_mean(const arma::mat & osculating_states,double J2,double body_radius,arma::mat & mean_states,
+			double tolerance = 1e-13,unsigned int max_iterations = 50);
+
+		/**
+		Allocation-free kernel behind mean_to_osculating. 
+		With sign = -1, evaluates the first-order osculating to mean mapping instead
+		@param elements pointer to the 6 input elements (a, e, i, Omega, omega, M0)
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param mapped pointer to 6 doubles receiving the mapped elements, angles in [0,2 pi)
+		@param sign +1 (mean to osculating) or -1 (osculating to mean, first order)
+		*/
+		static void mean_to_osculating_kernel(const double * elements,double J2,double body_radius,double * mapped,double sign = 1);
+
+		/**
+		Allocation-free kernel behind osculating_to_mean
+		@param osculating pointer to the 6 osculating elements (a, e, i, Omega, omega, M0)
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param mean pointer to 6 doubles receiving the mean elements, angles in [0,2 pi). 
+		Set to NaN if the osculating inclination lies within critical_inclination_band of a critical inclination
+		@param tolerance convergence tolerance on the residual (relative on a, absolute on the other elements)
+		@param max_iterations iteration cap
+		@return true if the iteration converged to finite elliptic mean elements away from the critical inclinations
+		*/
+		static bool osculating_to_mean_kernel(const double * osculating,double J2,double body_radius,double * mean,
+			double tolerance = 1e-13,unsigned int max_iterations = 50);
+
+		/**
+		Computes the first-order secular J2 drift of the mean elements
+		@param mean mean keplerian state
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param rates pointer to 3 doubles receiving the rates of Omega, omega and of the mean anomaly (including the mean motion)
+		*/
+		static void get_secular_rates(const KepState & mean,double J2,double body_radius,double * rates);
+
+		/**
+		Propagates mean elements at the secular rates
+		@param mean mean keplerian state
+		@param J2 second zonal harmonic of the central body
+		@param body_radius reference radius of the central body
+		@param delta_T time since epoch
+		@return mean keplerian state re-epoched at delta_T, i.e whose M0 is the mean anomaly at delta_T
+		*/
+		static KepState propagate_mean(const KepState & mean,double J2,double body_radius,double delta_T);
+
+		// Half-width of the band of |1 - 5 cos^2 i| around the critical inclinations refused by osculating_to_mean
+		static const double critical_inclination_band;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef MEASUREMENTS_HEADER 
+#define MEASUREMENTS_HEADER
+
+#include "OrbitConversions/CartState.hpp"
+
+namespace OC{
+
+	/**
+	Rows of the measurement vector
+	*/
+	enum MeasurementType{
+		RANGE = 0,
+		RANGE_RATE = 1,
+		RIGHT_ASCENSION = 2,
+		DECLINATION = 3
+	};
+
+	/**
+	Simulated tracking measurements (range, range-rate and topocentric right-ascension/declination)
+	and their partials with respect to the cartesian state of the tracked object
+	*/
+	class Measurements{
+
+	public:
+
+		/**
+		Computes the measurements of a set of states.
+		Throws std::invalid_argument if the state matrices do not have 6 rows, 
+		or if the number of station states is neither 1 nor K
+		@param states 6xK inertial states of the tracked object
+		@param station_states 6xK (or 6x1) inertial states of the station
+		@param measurements set to the 4xK measurements, with rows ordered like MeasurementType.
+		Angles are in [-pi,pi] (right-ascension) and [-pi/2,pi/2] (declination)
+		@param partials set to the 6x(4K) partials: column 4 * k + m is the transposed H-matrix row of 
+		measurement m at sample k, so that each H-matrix row is contiguous
+		*/
+		static void compute(const arma::mat & states,
+			const arma::mat & station_states,
+			arma::mat & measurements,
+			arma::mat & partials);
+
+		/**
+		Computes the measurements of a single state.
+		Throws std::invalid_argument if the station state does not have 6 components
+		@param state inertial state of the tracked object
+		@param station_state 6x1 inertial state of the station
+		@param H set to the 4x6 partials of the measurements
+		@return 4x1 measurements, ordered like MeasurementType
+		*/
+		static arma::vec compute(const CartState & state,
+			const arma::vec & station_state,
+			arma::mat & H);
+
+	protected:
+
+		static void check_shapes(const arma::mat & states,const arma::mat & station_states,const char * caller);
+		static void measurement_kernel(const double * state,const double * station_state,double * measurement,double * partial);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -3,5 +3,29 @@
 
 #include "OrbitConversions/CartState.hpp"
 #include "OrbitConversions/KepState.hpp"
+#include "OrbitConversions/EquinoctialState.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+#include "OrbitConversions/PreparedKepState.hpp"
+#include "OrbitConversions/CloseApproach.hpp"
+#include "OrbitConversions/SnapshotGrid.hpp"
+#include "OrbitConversions/EventFinder.hpp"
+#include "OrbitConversions/Lambert.hpp"
+#include "OrbitConversions/Porkchop.hpp"
+#include "OrbitConversions/RelativeMotion.hpp"
+#include "OrbitConversions/GroundTrack.hpp"
+#include "OrbitConversions/Measurements.hpp"
+#include "OrbitConversions/PackedCovariances.hpp"
+#include "OrbitConversions/CovarianceMapping.hpp"
+#include "OrbitConversions/Dispersion.hpp"
+#include "OrbitConversions/ConversionCache.hpp"
+#include "OrbitConversions/SolverPolicy.hpp"
+#include "OrbitConversions/StateCatalog.hpp"
+#include "OrbitConversions/Eclipse.hpp"
+#include "OrbitConversions/ConversionService.hpp"
+#include "OrbitConversions/MeanElements.hpp"
+#include "OrbitConversions/SnapshotCodec.hpp"
+#include "OrbitConversions/IncrementalCatalog.hpp"
+#include "OrbitConversions/ArcBounds.hpp"
+#include "OrbitConversions/MaskedConversions.hpp"
 
 #endif
\ No newline at end of file
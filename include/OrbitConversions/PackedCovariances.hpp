@@ -0,0 +1,110 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PACKEDCOVARIANCES_HEADER 
+#define PACKEDCOVARIANCES_HEADER
+
+#include <armadillo>
+#include <vector>
+
+namespace OC{
+
+	/**
+	Container of N symmetric 6x6 covariances. Each covariance is packed into its 21 upper-triangular
+	components, and the storage is component-major: the N values of a given component are contiguous
+	*/
+	class PackedCovariances{
+
+	public:
+
+		/**
+		Constructor
+		@param N number of covariances, zero-initialized
+		*/
+		PackedCovariances(unsigned int N = 0);
+
+		/**
+		Resizes the container. The content is zeroed
+		@param N number of covariances
+		*/
+		void set_size(unsigned int N);
+
+		/**
+		Returns the number of covariances
+		@return number of covariances
+		*/
+		unsigned int get_size() const;
+
+		/**
+		Packs a covariance. Only the upper triangle of P is read
+		@param i index of the covariance
+		@param P 6x6 covariance
+		*/
+		void set(unsigned int i,const arma::mat & P);
+
+		/**
+		Unpacks a covariance
+		@param i index of the covariance
+		@return 6x6 covariance
+		*/
+		arma::mat get(unsigned int i) const;
+
+		/**
+		Returns a pointer to the N contiguous values of a packed component
+		@param c packed component index in [0,20]
+		@return pointer to the values of component c
+		*/
+		double * component(unsigned int c);
+		const double * component(unsigned int c) const;
+
+		/**
+		Unpacks a covariance into a column-major array
+		@param i index of the covariance
+		@param P pointer to 36 doubles receiving the symmetric covariance
+		*/
+		void unpack(unsigned int i,double * P) const;
+
+		/**
+		Packs the upper triangle of a column-major array
+		@param i index of the covariance
+		@param P pointer to the 36 components of the covariance
+		*/
+		void pack(unsigned int i,const double * P);
+
+		/**
+		Returns the packed index of a covariance component
+		@param row row index in [0,5]
+		@param col column index in [0,5]
+		@return packed component index
+		*/
+		static unsigned int index(unsigned int row,unsigned int col);
+
+	protected:
+
+		unsigned int N;
+		std::vector<double> data;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,65 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PORKCHOP_HEADER 
+#define PORKCHOP_HEADER
+
+#include "OrbitConversions/KepState.hpp"
+
+namespace OC{
+
+	class Porkchop{
+
+	public:
+
+		/**
+		Evaluates the departure and arrival delta-v of the Lambert transfers between two bodies 
+		over a grid of departure and arrival times. The grid is split in square tiles processed in parallel. 
+		Within a tile, each Lambert solve is warm-started from the solution of the neighbouring cell. 
+		Infeasible cells (non-positive time of flight, too many revolutions) are set to NaN
+		@param departure_body keplerian state of the departure body
+		@param arrival_body keplerian state of the arrival body (must share the epoch of departure_body)
+		@param departure_times departure times since epoch
+		@param arrival_times arrival times since epoch
+		@param departure_dv set to the departure delta-v. Element (i,j) corresponds to departure_times(i) and arrival_times(j)
+		@param arrival_dv set to the arrival delta-v, with the same layout as departure_dv
+		@param revolutions number of complete revolutions of the transfers
+		@param low_path branch of the multi-revolution transfers (ignored if revolutions == 0)
+		@param prograde if true, the transfers have a positive z-component of angular momentum
+		@param block_size side of the square tiles
+		*/
+		static void compute(const KepState & departure_body,
+			const KepState & arrival_body,
+			const arma::vec & departure_times,
+			const arma::vec & arrival_times,
+			arma::mat & departure_dv,
+			arma::mat & arrival_dv,
+			unsigned int revolutions = 0,
+			bool low_path = true,
+			bool prograde = true,
+			unsigned int block_size = 32);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
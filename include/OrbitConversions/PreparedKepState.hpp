@@ -0,0 +1,142 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef PREPAREDKEPSTATE_HEADER 
+#define PREPAREDKEPSTATE_HEADER
+
+#include "OrbitConversions/KepState.hpp"
+
+namespace OC{
+
+	/**
+	Keplerian state whose orientation and conic constants are computed once,
+	so that repeated evaluations of the cartesian position/velocity 
+	(screening, root finding, bulk propagation) only involve the Kepler solve 
+	and a handful of flops
+	*/
+	class PreparedKepState{
+
+	public:
+
+		/**
+		Constructor
+		@param kep keplerian state to prepare (elliptic or hyperbolic)
+		*/
+		PreparedKepState(const KepState & kep);
+
+		/**
+		Constructor
+		@param elements pointer to the 6 orbital elements (a, e, i, Omega, omega, M0)
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		*/
+		PreparedKepState(const double * elements,double mu);
+		PreparedKepState();
+
+		/**
+		Computes the cartesian position and velocity at the prescribed time
+		@param dt time since epoch
+		@param pos pointer to 3 doubles receiving the position
+		@param vel pointer to 3 doubles receiving the velocity
+		@param policy Kepler solver policy
+		*/
+		void get_position_velocity(double dt,double * pos,double * vel,const SolverPolicy & policy = SolverPolicy::default_policy()) const;
+
+		/**
+		Computes the cartesian position and velocity at the prescribed time, 
+		starting the Kepler solve from a known approximation of the anomaly
+		@param dt time since epoch
+		@param anomaly_guess guess of the eccentric (elliptic) or hyperbolic anomaly, 
+		typically obtained from get_anomaly on a neighbouring orbit
+		@param pos pointer to 3 doubles receiving the position
+		@param vel pointer to 3 doubles receiving the velocity
+		@param policy Kepler solver policy
+		*/
+		void get_position_velocity(double dt,double anomaly_guess,double * pos,double * vel,const SolverPolicy & policy = SolverPolicy::default_policy()) const;
+
+		/**
+		Computes the eccentric (elliptic) or hyperbolic anomaly at the prescribed time.
+		The eccentric anomaly is solved from the mean anomaly wrapped to [-pi,pi]
+		@param dt time since epoch
+		@param policy Kepler solver policy
+		@return anomaly
+		*/
+		double get_anomaly(double dt,const SolverPolicy & policy = SolverPolicy::default_policy()) const;
+
+		/**
+		Computes the cartesian position at the prescribed time
+		@param dt time since epoch
+		@param pos pointer to 3 doubles receiving the position
+		@param policy Kepler solver policy
+		*/
+		void get_position(double dt,double * pos,const SolverPolicy & policy = SolverPolicy::default_policy()) const;
+
+		/**
+		Returns the characteristic time of the orbit, i.e 2 pi / n. 
+		This is the orbital period if the orbit is elliptic
+		@return characteristic time (s)
+		*/
+		double get_time_scale() const;
+
+		/**
+		Returns the speed at periapsis, which bounds the orbit speed
+		@return speed at periapsis (m/s)
+		*/
+		double get_max_speed() const;
+
+		double get_a() const;
+		double get_eccentricity() const;
+		double get_n() const;
+		double get_M0() const;
+		double get_mu() const;
+		bool is_elliptic() const;
+
+	protected:
+
+		void get_position_velocity_from_anomaly(double anomaly,double * pos,double * vel) const;
+
+		double a;
+		double e;
+		double n;
+		double M0;
+		double mu;
+
+		// sqrt(|1 - e^2|)
+		double b_factor;
+
+		// sqrt(mu * |a|)
+		double sqrt_mu_a;
+
+		// Conic parameter and sqrt(mu / p)
+		double p;
+		double sqrt_mu_p;
+
+		// Unit vectors towards periapsis and at 90 deg ahead of periapsis in the orbit plane
+		double P[3];
+		double Q[3];
+
+		bool elliptic;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,95 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RELATIVEMOTION_HEADER 
+#define RELATIVEMOTION_HEADER
+
+#include "OrbitConversions/CartState.hpp"
+
+namespace OC{
+
+	/**
+	Conversions between inertial states and relative states expressed in the 
+	radial/in-track/cross-track (RIC, or Hill) frame of a chief. 
+	The RIC frame is defined by R = r/|r|, C = h/|h|, I = C x R, and rotates 
+	at the rate omega = h/r^2 with respect to the inertial frame. The relative 
+	velocity is the time derivative of the relative position in the rotating frame.
+	The batch methods process one state per column, do not allocate when the output
+	already has the right size, and accept either one chief per deputy or a single chief
+	shared by all deputies
+	*/
+	class RelativeMotion{
+
+	public:
+
+		/**
+		Converts inertial deputy states into relative states in the RIC frame of the chief
+		@param chief inertial chief state
+		@param deputy inertial deputy state
+		@return 6x1 relative state (x,y,z,x_dot,y_dot,z_dot) in the RIC frame
+		*/
+		static arma::vec inertial_to_ric(const CartState & chief,const CartState & deputy);
+
+		/**
+		Converts a relative state in the RIC frame of the chief into an inertial deputy state
+		@param chief inertial chief state
+		@param ric_state 6x1 relative state in the RIC frame
+		@return inertial deputy state
+		*/
+		static CartState ric_to_inertial(const CartState & chief,const arma::vec & ric_state);
+
+		/**
+		Batch version of inertial_to_ric.
+		Throws std::invalid_argument if the state matrices do not have 6 rows, 
+		or if the number of chief states is neither 1 nor N
+		@param chief_states 6xN (or 6x1) inertial chief states
+		@param deputy_states 6xN inertial deputy states
+		@param ric_states set to the 6xN relative states in the RIC frames of the chiefs
+		*/
+		static void inertial_to_ric(const arma::mat & chief_states,
+			const arma::mat & deputy_states,
+			arma::mat & ric_states);
+
+		/**
+		Batch version of ric_to_inertial.
+		Throws std::invalid_argument if the state matrices do not have 6 rows, 
+		or if the number of chief states is neither 1 nor N
+		@param chief_states 6xN (or 6x1) inertial chief states
+		@param ric_states 6xN relative states in the RIC frames of the chiefs
+		@param deputy_states set to the 6xN inertial deputy states
+		*/
+		static void ric_to_inertial(const arma::mat & chief_states,
+			const arma::mat & ric_states,
+			arma::mat & deputy_states);
+
+	protected:
+
+		static void check_shapes(const arma::mat & chief_states,const arma::mat & states,const char * caller);
+		static void get_ric_frame(const double * chief,double * R,double * I,double * C,double & omega);
+		static void inertial_to_ric_kernel(const double * chief,const double * deputy,double * ric);
+		static void ric_to_inertial_kernel(const double * chief,const double * ric,double * deputy);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
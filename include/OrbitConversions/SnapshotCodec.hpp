@@ -0,0 +1,235 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SNAPSHOTCODEC_HEADER 
+#define SNAPSHOTCODEC_HEADER
+
+#include <armadillo>
+#include <cstdint>
+#include <vector>
+
+namespace OC{
+
+	enum SnapshotType{
+
+		// 6xN keplerian states (a, e, i, Omega, omega, M), M being the mean anomaly at the snapshot time
+		KEPLERIAN_SNAPSHOT = 0,
+
+		// 6xN cartesian states
+		CARTESIAN_SNAPSHOT = 1
+	};
+
+	enum SnapshotPrediction{
+
+		// Quantized values are coded as they are
+		INTRA_PREDICTION = 0,
+
+		// Quantized values are coded as differences with the previous snapshot
+		PREVIOUS_PREDICTION = 1,
+
+		// Quantized values are coded as differences with the previous snapshot propagated 
+		// on its Keplerian orbit to the time of the current one
+		KEPLER_PREDICTION = 2
+	};
+
+	/**
+	Settings of a SnapshotEncoder
+	*/
+	struct SnapshotSettings{
+
+		SnapshotType type = CARTESIAN_SNAPSHOT;
+
+		SnapshotPrediction prediction = KEPLER_PREDICTION;
+
+		// Quantization step of each component. The reconstruction error is at most half a step. 
+		// For the angles of keplerian snapshots (Omega, omega, M), the step is shrunk so that 
+		// a turn holds a whole number of steps
+		double quantum[6] = {1e-6,1e-6,1e-6,1e-6,1e-6,1e-6};
+
+		// One snapshot every keyframe_interval is coded without prediction, so that decoding can start from it.
+		// 0 never re-keys: only the first snapshot and the snapshots changing the number of objects are keyframes
+		unsigned int keyframe_interval = 64;
+
+	};
+
+	/**
+	Common part of SnapshotEncoder and SnapshotDecoder. 
+	A snapshot is stored as an 80-byte header followed by its residuals: each component is 
+	quantized, predicted from the previously reconstructed snapshot and the integer residuals, 
+	stored component by component, are zigzag-mapped and bit-packed by blocks of 128 values 
+	at the width of the largest residual of the block. Encoder and decoder share the 
+	reconstructed snapshot the predictions are made from, so quantization errors do not accumulate. 
+	The byte stream is little-endian. Kepler predictions are recomputed by the decoder and are only 
+	guaranteed to match the encoder's on the same platform
+	*/
+	class SnapshotCodec{
+
+	public:
+
+		/**
+		Returns the last reconstructed snapshot
+		@return 6xN states
+		*/
+		const arma::mat & get_states() const;
+
+		/**
+		Returns the time of the last reconstructed snapshot
+		@return time
+		*/
+		double get_time() const;
+
+		// Number of values per bit-packed block
+		static const unsigned int block_size = 128;
+
+	protected:
+
+		struct Header{
+			uint32_t magic;
+			uint8_t type;
+			uint8_t prediction;
+			uint16_t reserved;
+			uint32_t N;
+			uint32_t payload_size;
+			double t;
+			double mu;
+			double quantum[6];
+		};
+
+		static const uint32_t magic = 0x4e53434f;
+
+		SnapshotCodec();
+
+		/**
+		Computes the quantized prediction of the next snapshot from the last reconstructed one
+		@param prediction prediction mode
+		@param t time of the next snapshot
+		@param N number of objects, which must match the last reconstructed snapshot unless prediction is INTRA_PREDICTION
+		@param predicted buffer receiving the Kepler predictions
+		@return pointer to the 6N predicted quantized values, component-major, 
+		or nullptr if prediction is INTRA_PREDICTION
+		*/
+		const long long * predict(SnapshotPrediction prediction,double t,unsigned int N,std::vector<long long> & predicted) const;
+
+		/**
+		Returns the number of quantization steps per turn of component k, or 0 if the component does not wrap around
+		@param k component index
+		@return steps per turn
+		*/
+		long long get_steps_per_turn(unsigned int k) const;
+
+		/**
+		Computes the per-component constants of dequantization
+		@param steps pointer to 6 values receiving the steps per turn of each component
+		@param scales pointer to 6 values receiving the dequantized value of one step of each component
+		*/
+		void get_scales(long long * steps,double * scales) const;
+
+		/**
+		Quantizes a value
+		@param value value to quantize
+		@param steps steps per turn of the component, 0 if it does not wrap around
+		@param scale quantization step
+		@return quantized value, in [0,steps) if the component wraps around
+		*/
+		static long long quantize(double value,long long steps,double scale);
+
+		/**
+		Bit-packs values by blocks of block_size
+		@param values pointer to the values
+		@param n number of values
+		@param bytes byte stream to append to
+		*/
+		static void pack(const uint64_t * values,size_t n,std::vector<unsigned char> & bytes);
+
+		/**
+		Unpacks values packed by pack
+		@param data pointer to the packed values
+		@param size number of available bytes
+		@param n number of values
+		@param values pointer to n values receiving the unpacked values
+		@return number of bytes read, or 0 if data is too short
+		*/
+		static size_t unpack(const unsigned char * data,size_t size,size_t n,uint64_t * values);
+
+		SnapshotSettings settings;
+		double mu;
+
+		arma::mat states;
+		std::vector<long long> quantized;
+		double t;
+		unsigned int count;
+		bool has_reference;
+
+		// Reused across snapshots
+		std::vector<uint64_t> residuals;
+
+	};
+
+	/**
+	Encodes a sequence of catalog snapshots into a compact byte stream
+	*/
+	class SnapshotEncoder : public SnapshotCodec{
+
+	public:
+
+		/**
+		Constructor
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param settings encoding settings
+		*/
+		SnapshotEncoder(double mu,const SnapshotSettings & settings = SnapshotSettings());
+
+		/**
+		Encodes a snapshot. A keyframe is emitted for the first snapshot, 
+		every keyframe_interval snapshots (unless it is 0), and whenever the number of objects changes
+		@param states 6xN states of the type given in the settings
+		@param t time of the snapshot
+		@param bytes byte stream to append the snapshot to
+		*/
+		void encode(const arma::mat & states,double t,std::vector<unsigned char> & bytes);
+
+	};
+
+	/**
+	Streaming decoder of the snapshots produced by SnapshotEncoder. 
+	Snapshots are decoded one at a time from a byte buffer, whatever the chunking of the stream
+	*/
+	class SnapshotDecoder : public SnapshotCodec{
+
+	public:
+
+		SnapshotDecoder();
+
+		/**
+		Decodes the next snapshot of the stream, available through get_states and get_time
+		@param data pointer to the start of the next snapshot
+		@param size number of available bytes
+		@return number of bytes consumed, or 0 if the snapshot is incomplete or corrupt. 
+		Predicted snapshots received before a keyframe are skipped
+		*/
+		size_t decode(const unsigned char * data,size_t size);
+
+	};
+
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,147 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SNAPSHOTGRID_HEADER 
+#define SNAPSHOTGRID_HEADER
+
+#include "OrbitConversions/PreparedKepState.hpp"
+#include <vector>
+
+namespace OC{
+
+	/**
+	Snapshot of a constellation propagated to a common time, with the positions
+	binned into a uniform spatial hash grid. The cells are kept in an open-addressing
+	table and their members in a single compressed (CSR) array filled by counting sort, 
+	so that each cell is a contiguous range of object indices followed by some slack. 
+	Moving the snapshot to a nearby time only moves the objects that have crossed a cell 
+	boundary, by swap-removing them from their old range and appending them to the new one. 
+	The bins are rebuilt from scratch only when a range, or the table, runs out of room
+	*/
+	class SnapshotGrid{
+
+	public:
+
+		/**
+		Constructor. Propagates the constellation to t and bins it
+		@param constellation keplerian states sharing a common epoch
+		@param cell_size size of the grid cells. Should be set to the typical query radius
+		@param t time since epoch of the snapshot
+		*/
+		SnapshotGrid(const std::vector<KepState> & constellation,double cell_size,double t = 0);
+
+		/**
+		Propagates all the objects to the prescribed time and moves the objects
+		that changed cell to their new cell
+		@param t time since epoch of the snapshot
+		@return number of objects that changed cell
+		*/
+		unsigned int propagate(double t);
+
+		/**
+		Returns the indices of the objects within a sphere
+		@param point center of the sphere
+		@param radius radius of the sphere
+		@return indices of the objects within radius of point, in increasing order
+		*/
+		std::vector<unsigned int> query_radius(const arma::vec::fixed<3> & point,double radius) const;
+
+		/**
+		Returns all the pairs of objects closer than the prescribed distance
+		@param distance pair distance threshold
+		@return pairs (i,j) with i < j, in lexicographic order
+		*/
+		std::vector<std::pair<unsigned int,unsigned int> > query_pairs(double distance) const;
+
+		/**
+		Returns the object positions at the snapshot time
+		@return 3xN matrix of positions
+		*/
+		const arma::mat & get_positions() const;
+
+		/**
+		Returns the snapshot time
+		@return time since epoch
+		*/
+		double get_time() const;
+
+		double get_cell_size() const;
+		unsigned int get_number_of_objects() const;
+
+		/**
+		Returns the number of times the bins were built from scratch, including 
+		the construction of the snapshot
+		@return number of rebuilds
+		*/
+		unsigned int get_number_of_rebuilds() const;
+
+	protected:
+
+		struct Cell{
+			long long key;
+			unsigned int offset;
+			unsigned int count;
+			unsigned int capacity;
+		};
+
+		typedef long long CellKey;
+
+		CellKey get_cell_key(const double * pos) const;
+		static CellKey pack_key(long long ix,long long iy,long long iz);
+		static void unpack_key(CellKey key,long long & ix,long long & iy,long long & iz);
+
+		const Cell * find_cell(CellKey key) const;
+		unsigned int find_or_insert_cell(CellKey key);
+		void remove_cell(unsigned int slot);
+		bool move_object(unsigned int i);
+		void rebuild();
+		void propagate_positions(double t);
+
+		std::vector<PreparedKepState> orbits;
+		arma::mat positions;
+		double t;
+		double cell_size;
+
+		// Open-addressing table of cells, with a power of two capacity of at least twice the number of objects.
+		// Since empty cells are removed, there are never more occupied cells than objects and the table does not need to grow
+		std::vector<Cell> cells;
+		std::vector<bool> occupied;
+
+		// Object indices grouped by cell: cell c owns members[cells[c].offset, cells[c].offset + cells[c].count)
+		// and may grow up to cells[c].offset + cells[c].capacity. Cells created by incremental moves
+		// reuse the (offset, capacity) ranges of the emptied cells, or are allocated past members_end
+		std::vector<unsigned int> members;
+		std::vector<std::pair<unsigned int,unsigned int> > free_ranges;
+		unsigned int members_end;
+
+		// Cell key, table slot and position in members of each object
+		std::vector<CellKey> object_keys;
+		std::vector<unsigned int> object_cells;
+		std::vector<unsigned int> object_slots;
+
+		unsigned int number_of_rebuilds;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
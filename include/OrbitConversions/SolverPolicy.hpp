@@ -0,0 +1,87 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SOLVERPOLICY_HEADER 
+#define SOLVERPOLICY_HEADER
+
+namespace OC{
+
+	/**
+	Behavior of the Kepler solvers when the iteration cap is reached
+	*/
+	enum SolverFailureMode{
+		WARN_ON_FAILURE = 0,
+		IGNORE_FAILURE = 1,
+		NAN_ON_FAILURE = 2
+	};
+
+	/**
+	Convergence settings of the Kepler equation solvers (State::ecc_from_M, State::H_from_M and 
+	the APIs built on them). The iterations stop as soon as one of the tolerances is met
+	*/
+	struct SolverPolicy{
+
+		// Tolerance on the mean anomaly residual
+		double tolerance;
+
+		// Tolerance on the magnitude of the last Newton step
+		double step_tolerance;
+
+		// The elliptic solver also stops once the magnitude of the eccentric anomaly falls below this value
+		double zero_tolerance;
+
+		// Iteration cap
+		unsigned int max_iterations;
+
+		// Newton steps are clamped to this magnitude
+		double max_step;
+
+		// What happens when max_iterations is reached
+		SolverFailureMode failure_mode;
+
+		/**
+		Screening preset: 1e-8 rad tolerance on the mean anomaly residual, 
+		Newton steps clamped to 1 rad and a small iteration cap. 
+		Non-converged solves are returned silently
+		@return policy
+		*/
+		static SolverPolicy fast_policy();
+
+		/**
+		Preset reproducing the historical behavior of the solvers
+		(1e-13 residual, 1e-12 step, 1e-10 zero tolerance, 1000 iterations, 0.1 rad step clamp)
+		@return policy
+		*/
+		static SolverPolicy default_policy();
+
+		/**
+		Preset ignoring the zero tolerance and iterating until the Newton step 
+		falls below 1e-14, i.e to the rounding level of the anomaly
+		@return policy
+		*/
+		static SolverPolicy precise_policy();
+
+	};
+
+}
+
+#endif
\ No newline at end of file
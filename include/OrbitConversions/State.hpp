@@ -24,6 +24,7 @@
 #define STATE_HEADER
 
 #include <armadillo>
+#include "OrbitConversions/SolverPolicy.hpp"
 
 namespace OC{
 
@@ -92,6 +93,39 @@ namespace OC{
 		@return hyperbolic anomaly
 		*/
 		static double H_from_M(const  double & M,const  double & e,const bool & pedantic = false);
+
+		/**
+		Computes eccentric anomaly from mean anomaly, starting the iterations from a 
+		known approximation (e.g the anomaly of a neighbouring orbit)
+		@param M mean anomaly
+		@param e eccentricity (0 =< e < 1)
+		@param ecc_0 initial guess of the eccentric anomaly
+		@param pedantic if true, will print out convergence details
+		@return eccentric anomaly
+		*/
+		static double ecc_from_M_warm_start(const double & M,const double & e,const double & ecc_0,const bool & pedantic = false);
+
+		/**
+		Computes hyperbolic anomaly from mean anomaly, starting the iterations from a 
+		known approximation (e.g the anomaly of a neighbouring orbit)
+		@param M mean anomaly
+		@param e eccentricity (1 < e)
+		@param H_0 initial guess of the hyperbolic anomaly
+		@param pedantic if true, will print out convergence details
+		@return hyperbolic anomaly
+		*/
+		static double H_from_M_warm_start(const double & M,const double & e,const double & H_0,const bool & pedantic = false);
+
+		/**
+		Same as f_from_M, ecc_from_M, H_from_M, ecc_from_M_warm_start and H_from_M_warm_start, 
+		with the convergence settings of the Kepler solve given by a policy
+		@param policy solver policy (e.g SolverPolicy::fast_policy())
+		*/
+		static double f_from_M(const double & M,const double & e,const SolverPolicy & policy);
+		static double ecc_from_M(const double & M,const double & e,const SolverPolicy & policy,const bool & pedantic = false);
+		static double H_from_M(const double & M,const double & e,const SolverPolicy & policy,const bool & pedantic = false);
+		static double ecc_from_M_warm_start(const double & M,const double & e,const double & ecc_0,const SolverPolicy & policy,const bool & pedantic = false);
+		static double H_from_M_warm_start(const double & M,const double & e,const double & H_0,const SolverPolicy & policy,const bool & pedantic = false);
 		
 
 		/**
@@ -118,6 +152,24 @@ namespace OC{
 		*/
 		static double M_from_f(const double & f,const double & e);
 
+		/**
+		Stumpff function S(z) = (sqrt(z) - sin(sqrt(z))) / sqrt(z)^3, continued
+		to z <= 0 through its series. Used to write x - sin(x) = x^3 S(x^2)
+		and sinh(x) - x = x^3 S(-x^2) without cancellation
+		@param z argument
+		@return S(z)
+		*/
+		static double stumpff_S(const double & z);
+
+		/**
+		Stumpff function C(z) = (1 - cos(sqrt(z))) / z, continued
+		to z <= 0 through its series. Used to write 1 - cos(x) = x^2 C(x^2)
+		and cosh(x) - 1 = x^2 C(-x^2) without cancellation
+		@param z argument
+		@return C(z)
+		*/
+		static double stumpff_C(const double & z);
+
 		virtual double get_momentum() const = 0;
 		virtual double get_energy() const = 0;
 		virtual double get_a() const = 0;
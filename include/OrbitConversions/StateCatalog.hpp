@@ -0,0 +1,363 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef STATECATALOG_HEADER 
+#define STATECATALOG_HEADER
+
+#include "OrbitConversions/CartState.hpp"
+#include "OrbitConversions/KepState.hpp"
+#include <memory>
+#include <vector>
+
+namespace OC{
+
+	/**
+	Memory layouts of a state catalog
+	*/
+	enum CatalogLayout{
+
+		// Array of structures: the 6 components of each object are contiguous
+		AOS = 0,
+
+		// Structure of arrays: the N values of each component are contiguous
+		SOA = 1
+	};
+
+	/**
+	Read-only handle to a keplerian state stored in a KepCatalog. 
+	Offers the accessors of KepState without owning any memory.
+	Handles are invalidated when their catalog is destroyed or changes layout
+	*/
+	class KepStateHandle{
+
+	public:
+
+		/**
+		Constructor
+		@param base pointer to the first component (a) of the state
+		@param stride distance between two consecutive components of the state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		*/
+		KepStateHandle(const double * base,unsigned int stride,double mu) : base(base),stride(stride),mu(mu){}
+
+		// The accessors are defined here so that they inline in catalog-wide loops
+		double get_a() const { return this -> base[0]; }
+		double get_eccentricity() const { return this -> base[this -> stride]; }
+		double get_inclination() const { return this -> base[2 * this -> stride]; }
+		double get_Omega() const { return this -> base[3 * this -> stride]; }
+		double get_omega() const { return this -> base[4 * this -> stride]; }
+		double get_M0() const { return this -> base[5 * this -> stride]; }
+		double get_mu() const { return this -> mu; }
+
+		double get_n() const { return std::sqrt(this -> mu / std::pow(std::abs(this -> get_a()),3)); }
+		double get_parameter() const { return this -> get_a() * (1 - this -> get_eccentricity() * this -> get_eccentricity()); }
+		double get_energy() const { return - this -> mu / (2 * this -> get_a()); }
+		double get_momentum() const { return std::sqrt(this -> mu * this -> get_parameter()); }
+
+		/**
+		Returns a copy of the state
+		@return 6x1 state (a, e, i, Omega, omega, M0)
+		*/
+		arma::vec get_state() const;
+
+		/**
+		Same as KepState::convert_to_cart
+		@param delta_T time since epoch
+		@return cartesian state
+		*/
+		CartState convert_to_cart(double delta_T) const;
+
+	protected:
+
+		const double * base;
+		unsigned int stride;
+		double mu;
+
+	};
+
+	/**
+	Read-only handle to a cartesian state stored in a CartCatalog. 
+	Offers the accessors of CartState without owning any memory.
+	Handles are invalidated when their catalog is destroyed or changes layout
+	*/
+	class CartStateHandle{
+
+	public:
+
+		/**
+		Constructor
+		@param base pointer to the first component (x) of the state
+		@param stride distance between two consecutive components of the state
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		*/
+		CartStateHandle(const double * base,unsigned int stride,double mu) : base(base),stride(stride),mu(mu){}
+
+		double get(unsigned int k) const { return this -> base[k * this -> stride]; }
+		double get_mu() const { return this -> mu; }
+
+		double get_radius() const { return std::sqrt(this -> get(0) * this -> get(0) + this -> get(1) * this -> get(1) + this -> get(2) * this -> get(2)); }
+		double get_speed() const { return std::sqrt(this -> get(3) * this -> get(3) + this -> get(4) * this -> get(4) + this -> get(5) * this -> get(5)); }
+		double get_energy() const { return this -> get_speed() * this -> get_speed() / 2 - this -> mu / this -> get_radius(); }
+		double get_a() const { return - this -> mu / (2 * this -> get_energy()); }
+
+		double get_momentum() const;
+		double get_eccentricity() const;
+
+		arma::vec::fixed<3> get_position_vector() const;
+		arma::vec::fixed<3> get_velocity_vector() const;
+
+		/**
+		Returns a copy of the state
+		@return 6x1 state (x, y, z, x_dot, y_dot, z_dot)
+		*/
+		arma::vec get_state() const;
+
+		/**
+		Same as CartState::convert_to_kep
+		@param delta_T time since epoch
+		@return keplerian state
+		*/
+		KepState convert_to_kep(double delta_T) const;
+
+	protected:
+
+		const double * base;
+		unsigned int stride;
+		double mu;
+
+	};
+
+	/**
+	Contiguous storage of N 6-component states sharing a gravitational parameter. 
+	All the states live in a single allocation, laid out either as an array of 
+	structures or as a structure of arrays. Component k of object i is found at 
+	get_data()[i * get_object_stride() + k * get_component_stride()] in both layouts
+	*/
+	class StateCatalog{
+
+	public:
+
+		unsigned int get_size() const;
+		double get_mu() const;
+		CatalogLayout get_layout() const;
+
+		/**
+		Returns the distance between the same component of two consecutive objects
+		@return 6 (AOS) or 1 (SOA)
+		*/
+		unsigned int get_object_stride() const;
+
+		/**
+		Returns the distance between two consecutive components of the same object
+		@return 1 (AOS) or N (SOA)
+		*/
+		unsigned int get_component_stride() const;
+
+		double * get_data();
+		const double * get_data() const;
+
+		/**
+		Returns component k of object i
+		@param i object index
+		@param k component index
+		@return component value
+		*/
+		double get(unsigned int i,unsigned int k) const { return this -> data[i * this -> object_stride + k * this -> component_stride]; }
+
+		/**
+		Sets component k of object i
+		@param i object index
+		@param k component index
+		@param value component value
+		*/
+		void set(unsigned int i,unsigned int k,double value) { this -> data[i * this -> object_stride + k * this -> component_stride] = value; }
+
+		/**
+		Copies the state of object i
+		@param i object index
+		@param state pointer to 6 doubles receiving the state
+		*/
+		void get_state(unsigned int i,double * state) const;
+
+		/**
+		Overwrites the state of object i
+		@param i object index
+		@param state pointer to the 6 components of the state
+		*/
+		void set_state(unsigned int i,const double * state);
+
+		/**
+		Returns a copy of the whole catalog
+		@return 6xN states
+		*/
+		arma::mat get_states() const;
+
+		/**
+		Rearranges the catalog in the prescribed layout
+		@param layout new layout
+		*/
+		void set_layout(CatalogLayout layout);
+
+	protected:
+
+		StateCatalog(unsigned int N,double mu,CatalogLayout layout);
+		StateCatalog(const double * states,unsigned int N,double mu,CatalogLayout source_layout,CatalogLayout layout);
+
+		void allocate(unsigned int N,CatalogLayout layout);
+
+		/**
+		Copies states from an external buffer, in parallel
+		@param states pointer to the 6N components of the states
+		@param source_layout layout of states
+		*/
+		void load(const double * states,CatalogLayout source_layout);
+
+		unsigned int N;
+		double mu;
+		CatalogLayout layout;
+		unsigned int object_stride;
+		unsigned int component_stride;
+		std::unique_ptr<double[]> data;
+
+	};
+
+	class CartCatalog;
+
+	/**
+	Catalog of keplerian states (a, e, i, Omega, omega, M0)
+	*/
+	class KepCatalog : public StateCatalog{
+
+	public:
+
+		/**
+		Constructor. The states are left uninitialized
+		@param N number of objects
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param layout memory layout
+		*/
+		KepCatalog(unsigned int N,double mu,CatalogLayout layout = SOA);
+
+		/**
+		Bulk constructor
+		@param states 6xN keplerian states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param layout memory layout
+		*/
+		KepCatalog(const arma::mat & states,double mu,CatalogLayout layout = SOA);
+
+		/**
+		Bulk constructor from a raw buffer
+		@param states pointer to the 6N components of the states
+		@param N number of objects
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param source_layout layout of states
+		@param layout memory layout
+		*/
+		KepCatalog(const double * states,unsigned int N,double mu,CatalogLayout source_layout,CatalogLayout layout = SOA);
+
+		/**
+		Bulk constructor from individual states
+		@param states keplerian states, assumed to share the gravitational parameter of the first one
+		@param layout memory layout
+		*/
+		KepCatalog(const std::vector<KepState> & states,CatalogLayout layout = SOA);
+
+		/**
+		Returns a handle to object i
+		@param i object index
+		@return handle
+		*/
+		KepStateHandle operator[](unsigned int i) const{
+			return KepStateHandle(this -> data.get() + i * this -> object_stride,this -> component_stride,this -> mu);
+		}
+
+		/**
+		Converts the whole catalog, in parallel
+		@param delta_T time since epoch
+		@return cartesian catalog with the same layout
+		*/
+		CartCatalog convert_to_cart(double delta_T) const;
+
+	};
+
+	/**
+	Catalog of cartesian states (x, y, z, x_dot, y_dot, z_dot)
+	*/
+	class CartCatalog : public StateCatalog{
+
+	public:
+
+		/**
+		Constructor. The states are left uninitialized
+		@param N number of objects
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param layout memory layout
+		*/
+		CartCatalog(unsigned int N,double mu,CatalogLayout layout = SOA);
+
+		/**
+		Bulk constructor
+		@param states 6xN cartesian states
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param layout memory layout
+		*/
+		CartCatalog(const arma::mat & states,double mu,CatalogLayout layout = SOA);
+
+		/**
+		Bulk constructor from a raw buffer
+		@param states pointer to the 6N components of the states
+		@param N number of objects
+		@param mu standard gravitational parameter of central body [L^3/T^2]
+		@param source_layout layout of states
+		@param layout memory layout
+		*/
+		CartCatalog(const double * states,unsigned int N,double mu,CatalogLayout source_layout,CatalogLayout layout = SOA);
+
+		/**
+		Bulk constructor from individual states
+		@param states cartesian states, assumed to share the gravitational parameter of the first one
+		@param layout memory layout
+		*/
+		CartCatalog(const std::vector<CartState> & states,CatalogLayout layout = SOA);
+
+		/**
+		Returns a handle to object i
+		@param i object index
+		@return handle
+		*/
+		CartStateHandle operator[](unsigned int i) const{
+			return CartStateHandle(this -> data.get() + i * this -> object_stride,this -> component_stride,this -> mu);
+		}
+
+		/**
+		Converts the whole catalog, in parallel
+		@param delta_T time since epoch
+		@return keplerian catalog with the same layout
+		*/
+		KepCatalog convert_to_kep(double delta_T) const;
+
+	};
+
+}
+
+#endif
\ No newline at end of file
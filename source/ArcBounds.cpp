@@ -0,0 +1,386 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/ArcBounds.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace OC{
+
+	void ArcBox::merge(const ArcBox & other){
+		for (unsigned int k = 0; k < 3; ++k){
+			this -> min[k] = std::min(this -> min[k],other.min[k]);
+			this -> max[k] = std::max(this -> max[k],other.max[k]);
+		}
+	}
+
+	ArcBox ArcBounds::get_box(const KepState & kep,double t0,double t1){
+
+		arma::vec elements = kep.get_state();
+		ArcBox box;
+		ArcShell shell;
+		ArcBounds::get_bounds_kernel(elements.memptr(),kep.get_mu(),t0,t1,box,shell);
+		return box;
+
+	}
+
+	ArcShell ArcBounds::get_shell(const KepState & kep,double t0,double t1){
+
+		arma::vec elements = kep.get_state();
+		ArcBox box;
+		ArcShell shell;
+		ArcBounds::get_bounds_kernel(elements.memptr(),kep.get_mu(),t0,t1,box,shell);
+		return shell;
+
+	}
+
+	void ArcBounds::get_anomaly_range(const double * kep,double mu,double t0,double t1,double & x0,double & x1){
+
+		double a = kep[0];
+		double e = kep[1];
+		double n = std::sqrt(mu / std::pow(std::abs(a),3));
+		double M_0 = kep[5] + n * t0;
+		double M_1 = kep[5] + n * t1;
+
+		if (e < 1){
+
+			// The Kepler solve runs on M wrapped to [-pi,pi], the turns being added back afterwards
+			double turns_0 = std::round(M_0 / (2 * arma::datum::pi));
+			double turns_1 = std::round(M_1 / (2 * arma::datum::pi));
+			double M_0_wrapped = M_0 - 2 * arma::datum::pi * turns_0;
+			double M_1_wrapped = M_1 - 2 * arma::datum::pi * turns_1;
+
+			double E_0 = State::ecc_from_M(M_0_wrapped,e);
+			double E_1 = State::ecc_from_M(M_1_wrapped,e);
+
+			// dM/dE >= 1 - e bounds the anomaly error from the residual
+			double error_0 = std::abs(State::M_from_ecc(E_0,e) - M_0_wrapped) / (1 - e);
+			double error_1 = std::abs(State::M_from_ecc(E_1,e) - M_1_wrapped) / (1 - e);
+
+			x0 = E_0 + 2 * arma::datum::pi * turns_0 - error_0;
+			x1 = E_1 + 2 * arma::datum::pi * turns_1 + error_1;
+
+		}
+		else{
+
+			double H_0 = State::H_from_M(M_0,e);
+			double H_1 = State::H_from_M(M_1,e);
+
+			// dM/dH >= e - 1 bounds the anomaly error from the residual
+			x0 = H_0 - std::abs(State::M_from_H(H_0,e) - M_0) / (e - 1);
+			x1 = H_1 + std::abs(State::M_from_H(H_1,e) - M_1) / (e - 1);
+
+		}
+
+	}
+
+	void ArcBounds::get_bounds_kernel(const double * kep,double mu,double t0,double t1,ArcBox & box,ArcShell & shell){
+
+		double a = kep[0];
+		double e = kep[1];
+
+		double x0,x1;
+		ArcBounds::get_anomaly_range(kep,mu,std::min(t0,t1),std::max(t0,t1),x0,x1);
+
+		double P[3];
+		double Q[3];
+		BatchConversions::get_perifocal_basis(kep,P,Q);
+
+		// Position component k is A_k c(x) + B_k s(x) + C_k, 
+		// with (c,s) = (cos,sin) (elliptic) or (cosh,sinh) (hyperbolic)
+		double A[3];
+		double B[3];
+		double C[3];
+		double b = std::abs(a) * std::sqrt(std::abs(1 - e * e));
+		for (unsigned int k = 0; k < 3; ++k){
+			A[k] = a * P[k];
+			B[k] = b * Q[k];
+			C[k] = - a * e * P[k];
+		}
+
+		auto position = [&](double x,unsigned int k){
+			if (e < 1){
+				return A[k] * std::cos(x) + B[k] * std::sin(x) + C[k];
+			}
+			return A[k] * std::cosh(x) + B[k] * std::sinh(x) + C[k];
+		};
+
+		auto radius = [&](double x){
+			if (e < 1){
+				return a * (1 - e * std::cos(x));
+			}
+			return a * (1 - e * std::cosh(x));
+		};
+
+		// A range longer than a turn covers the whole ellipse
+		if (e < 1 && x1 - x0 > 2 * arma::datum::pi){
+			x1 = x0 + 2 * arma::datum::pi;
+		}
+
+		double r_0 = radius(x0);
+		double r_1 = radius(x1);
+		shell.r_min = std::min(r_0,r_1);
+		shell.r_max = std::max(r_0,r_1);
+
+		for (unsigned int k = 0; k < 3; ++k){
+
+			double p_0 = position(x0,k);
+			double p_1 = position(x1,k);
+			box.min[k] = std::min(p_0,p_1);
+			box.max[k] = std::max(p_0,p_1);
+
+			// Interior stationary points
+			if (e < 1){
+				double x_star = std::atan2(B[k],A[k]);
+				double x = x_star + arma::datum::pi * std::ceil((x0 - x_star) / arma::datum::pi);
+				for (; x < x1; x += arma::datum::pi){
+					double p = position(x,k);
+					box.min[k] = std::min(box.min[k],p);
+					box.max[k] = std::max(box.max[k],p);
+				}
+			}
+			else if (std::abs(B[k]) < std::abs(A[k])){
+				double x = std::atanh(- B[k] / A[k]);
+				if (x > x0 && x < x1){
+					double p = position(x,k);
+					box.min[k] = std::min(box.min[k],p);
+					box.max[k] = std::max(box.max[k],p);
+				}
+			}
+
+		}
+
+		// Periapsis and apoapsis passages
+		if (e < 1){
+			if (std::ceil(x0 / (2 * arma::datum::pi)) * 2 * arma::datum::pi < x1){
+				shell.r_min = a * (1 - e);
+			}
+			if (std::ceil((x0 - arma::datum::pi) / (2 * arma::datum::pi)) * 2 * arma::datum::pi + arma::datum::pi < x1){
+				shell.r_max = a * (1 + e);
+			}
+		}
+		else if (x0 < 0 && x1 > 0){
+			shell.r_min = a * (1 - e);
+		}
+
+		// Padding for the rounding errors of the evaluations
+		double padding = 1e-12 * shell.r_max;
+		for (unsigned int k = 0; k < 3; ++k){
+			box.min[k] -= padding;
+			box.max[k] += padding;
+		}
+		shell.r_min -= padding;
+		shell.r_max += padding;
+
+	}
+
+	ArcBVH::ArcBVH(const std::vector<KepState> & catalog,double t0,double t1,unsigned int leaf_size){
+
+		arma::mat states(6,catalog.size());
+		for (unsigned int i = 0; i < catalog.size(); ++i){
+			states.col(i) = catalog[i].get_state();
+		}
+		double mu = catalog.empty() ? 1 : catalog.front().get_mu();
+
+		this -> build(states.memptr(),6,1,catalog.size(),mu,t0,t1,leaf_size);
+
+	}
+
+	ArcBVH::ArcBVH(const KepCatalog & catalog,double t0,double t1,unsigned int leaf_size){
+
+		this -> build(catalog.get_data(),catalog.get_object_stride(),catalog.get_component_stride(),
+			catalog.get_size(),catalog.get_mu(),t0,t1,leaf_size);
+
+	}
+
+	void ArcBVH::build(const double * states,unsigned int object_stride,unsigned int component_stride,
+		unsigned int N,double mu,double t0,double t1,unsigned int leaf_size){
+
+		this -> boxes.resize(N);
+		this -> shells.resize(N);
+		this -> order.resize(N);
+		this -> nodes.clear();
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			double kep[6];
+			for (unsigned int k = 0; k < 6; ++k){
+				kep[k] = states[i * object_stride + k * component_stride];
+			}
+			ArcBounds::get_bounds_kernel(kep,mu,t0,t1,this -> boxes[i],this -> shells[i]);
+			this -> order[i] = i;
+		}
+
+		if (N > 0){
+			this -> nodes.reserve(2 * (N / std::max(1u,leaf_size)) + 1);
+			this -> build_node(0,N,std::max(1u,leaf_size));
+		}
+
+	}
+
+	unsigned int ArcBVH::build_node(unsigned int first,unsigned int count,unsigned int leaf_size){
+
+		unsigned int index = this -> nodes.size();
+		this -> nodes.push_back(Node());
+
+		ArcBox box = this -> boxes[this -> order[first]];
+		for (unsigned int j = first + 1; j < first + count; ++j){
+			box.merge(this -> boxes[this -> order[j]]);
+		}
+		this -> nodes[index].box = box;
+		this -> nodes[index].first = first;
+		this -> nodes[index].count = count;
+
+		if (count <= leaf_size){
+			return index;
+		}
+
+		unsigned int axis = 0;
+		for (unsigned int k = 1; k < 3; ++k){
+			if (box.max[k] - box.min[k] > box.max[axis] - box.min[axis]){
+				axis = k;
+			}
+		}
+
+		unsigned int half = count / 2;
+		std::nth_element(this -> order.begin() + first,this -> order.begin() + first + half,this -> order.begin() + first + count,
+			[this,axis](unsigned int i,unsigned int j){
+				return this -> boxes[i].min[axis] + this -> boxes[i].max[axis] < this -> boxes[j].min[axis] + this -> boxes[j].max[axis];
+			});
+
+		unsigned int left = this -> build_node(first,half,leaf_size);
+		unsigned int right = this -> build_node(first + half,count - half,leaf_size);
+
+		// Inner nodes hold no arcs of their own
+		this -> nodes[index].left = left;
+		this -> nodes[index].right = right;
+		this -> nodes[index].count = 0;
+
+		return index;
+
+	}
+
+	std::vector<unsigned int> ArcBVH::query(const ArcBox & box,double distance) const{
+
+		std::vector<unsigned int> result;
+		if (!this -> nodes.empty()){
+			this -> query_node(0,box,distance,result);
+		}
+		std::sort(result.begin(),result.end());
+		return result;
+
+	}
+
+	void ArcBVH::query_node(unsigned int node,const ArcBox & box,double distance,std::vector<unsigned int> & result) const{
+
+		const Node & current = this -> nodes[node];
+		if (!current.box.overlaps(box,distance)){
+			return;
+		}
+
+		if (current.count > 0){
+			for (unsigned int j = current.first; j < current.first + current.count; ++j){
+				if (this -> boxes[this -> order[j]].overlaps(box,distance)){
+					result.push_back(this -> order[j]);
+				}
+			}
+			return;
+		}
+
+		this -> query_node(current.left,box,distance,result);
+		this -> query_node(current.right,box,distance,result);
+
+	}
+
+	std::vector<std::pair<unsigned int,unsigned int> > ArcBVH::find_overlapping_pairs(double distance) const{
+
+		std::vector<std::pair<unsigned int,unsigned int> > pairs;
+		if (!this -> nodes.empty()){
+			this -> find_pairs(0,0,distance,pairs);
+		}
+		std::sort(pairs.begin(),pairs.end());
+		return pairs;
+
+	}
+
+	void ArcBVH::find_pairs(unsigned int node_a,unsigned int node_b,double distance,
+		std::vector<std::pair<unsigned int,unsigned int> > & pairs) const{
+
+		const Node & a = this -> nodes[node_a];
+		const Node & b = this -> nodes[node_b];
+
+		if (node_a != node_b && !a.box.overlaps(b.box,distance)){
+			return;
+		}
+
+		// Two leaves (or a leaf with itself): test the arcs pairwise
+		if (a.count > 0 && b.count > 0){
+			for (unsigned int j_a = a.first; j_a < a.first + a.count; ++j_a){
+				unsigned int j_b_first = node_a == node_b ? j_a + 1 : b.first;
+				for (unsigned int j_b = j_b_first; j_b < b.first + b.count; ++j_b){
+					unsigned int i = this -> order[j_a];
+					unsigned int j = this -> order[j_b];
+					if (this -> boxes[i].overlaps(this -> boxes[j],distance) && this -> shells[i].overlaps(this -> shells[j],distance)){
+						pairs.push_back(std::make_pair(std::min(i,j),std::max(i,j)));
+					}
+				}
+			}
+			return;
+		}
+
+		if (node_a == node_b){
+			this -> find_pairs(a.left,a.left,distance,pairs);
+			this -> find_pairs(a.right,a.right,distance,pairs);
+			this -> find_pairs(a.left,a.right,distance,pairs);
+			return;
+		}
+
+		// Descend into the inner node with the larger box
+		bool split_a = b.count > 0 
+		|| (a.count == 0 && (a.box.max[0] - a.box.min[0]) + (a.box.max[1] - a.box.min[1]) + (a.box.max[2] - a.box.min[2]) 
+			>= (b.box.max[0] - b.box.min[0]) + (b.box.max[1] - b.box.min[1]) + (b.box.max[2] - b.box.min[2]));
+
+		if (split_a){
+			this -> find_pairs(a.left,node_b,distance,pairs);
+			this -> find_pairs(a.right,node_b,distance,pairs);
+		}
+		else{
+			this -> find_pairs(node_a,b.left,distance,pairs);
+			this -> find_pairs(node_a,b.right,distance,pairs);
+		}
+
+	}
+
+	const ArcBox & ArcBVH::get_box(unsigned int i) const{
+		return this -> boxes[i];
+	}
+
+	const ArcShell & ArcBVH::get_shell(unsigned int i) const{
+		return this -> shells[i];
+	}
+
+	unsigned int ArcBVH::get_size() const{
+		return this -> boxes.size();
+	}
+
+}
@@ -0,0 +1,263 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/BatchConversions.hpp"
+
+namespace OC{
+
+	const double BatchConversions::near_parabolic_band = 1e-2;
+
+	void BatchConversions::kep_to_cart(const arma::mat & kep_states,double mu,double delta_T,arma::mat & cart_states,
+		const SolverPolicy & policy){
+
+		unsigned int N = kep_states.n_cols;
+		cart_states.set_size(6,N);
+
+		std::vector<std::vector<unsigned int> > partitions;
+		BatchConversions::partition_by_regime(kep_states,1,partitions);
+
+		const std::vector<unsigned int> & elliptic = partitions[ELLIPTIC];
+		const std::vector<unsigned int> & near_parabolic = partitions[NEAR_PARABOLIC];
+		const std::vector<unsigned int> & hyperbolic = partitions[HYPERBOLIC];
+
+		#pragma omp parallel
+		{
+
+			#pragma omp for nowait
+			for (unsigned int k = 0; k < elliptic.size(); ++k){
+				unsigned int i = elliptic[k];
+				BatchConversions::kep_to_cart_elliptic_kernel<CART_ALL>(kep_states.colptr(i),mu,delta_T,cart_states.colptr(i),policy);
+			}
+
+			#pragma omp for nowait
+			for (unsigned int k = 0; k < near_parabolic.size(); ++k){
+				unsigned int i = near_parabolic[k];
+				BatchConversions::kep_to_cart_near_parabolic_kernel<CART_ALL>(kep_states.colptr(i),mu,delta_T,cart_states.colptr(i),policy);
+			}
+
+			#pragma omp for nowait
+			for (unsigned int k = 0; k < hyperbolic.size(); ++k){
+				unsigned int i = hyperbolic[k];
+				BatchConversions::kep_to_cart_hyperbolic_kernel<CART_ALL>(kep_states.colptr(i),mu,delta_T,cart_states.colptr(i),policy);
+			}
+
+		}
+
+	}
+
+	void BatchConversions::cart_to_kep(const arma::mat & cart_states,double mu,double delta_T,arma::mat & kep_states){
+
+		unsigned int N = cart_states.n_cols;
+		kep_states.set_size(6,N);
+
+		// The regime is only known once the eccentricity is, 
+		// so the shape of the orbits is computed before partitioning. 
+		// The near-parabolic partition is then recomputed from the cartesian states
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			BatchConversions::cart_to_shape_kernel<KEP_ALL>(cart_states.colptr(i),mu,kep_states.colptr(i));
+		}
+
+		std::vector<std::vector<unsigned int> > partitions;
+		BatchConversions::partition_by_regime(kep_states,1,partitions);
+
+		const std::vector<unsigned int> & elliptic = partitions[ELLIPTIC];
+		const std::vector<unsigned int> & near_parabolic = partitions[NEAR_PARABOLIC];
+		const std::vector<unsigned int> & hyperbolic = partitions[HYPERBOLIC];
+
+		#pragma omp parallel
+		{
+
+			#pragma omp for nowait
+			for (unsigned int k = 0; k < elliptic.size(); ++k){
+				BatchConversions::set_mean_anomaly_elliptic(kep_states.colptr(elliptic[k]),mu,delta_T);
+			}
+
+			#pragma omp for nowait
+			for (unsigned int k = 0; k < near_parabolic.size(); ++k){
+				unsigned int i = near_parabolic[k];
+				BatchConversions::cart_to_kep_near_parabolic_kernel(cart_states.colptr(i),mu,delta_T,kep_states.colptr(i));
+			}
+
+			#pragma omp for nowait
+			for (unsigned int k = 0; k < hyperbolic.size(); ++k){
+				BatchConversions::set_mean_anomaly_hyperbolic(kep_states.colptr(hyperbolic[k]),mu,delta_T);
+			}
+
+		}
+
+	}
+
+	void BatchConversions::equinoctial_to_cart(const arma::mat & equinoctial_states,double mu,double delta_T,arma::mat & cart_states){
+
+		unsigned int N = equinoctial_states.n_cols;
+		cart_states.set_size(6,N);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			EquinoctialState::to_cart_kernel(equinoctial_states.colptr(i),mu,delta_T,cart_states.colptr(i));
+		}
+
+	}
+
+	void BatchConversions::cart_to_equinoctial(const arma::mat & cart_states,double mu,double delta_T,arma::mat & equinoctial_states){
+
+		unsigned int N = cart_states.n_cols;
+		equinoctial_states.set_size(6,N);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			EquinoctialState::from_cart_kernel(cart_states.colptr(i),mu,delta_T,equinoctial_states.colptr(i));
+		}
+
+	}
+
+	void BatchConversions::cart_to_kep_kernel(const double * cart,double mu,double delta_T,double * kep){
+
+		BatchConversions::cart_to_shape_kernel<KEP_ALL>(cart,mu,kep);
+
+		if (kep[1] < 1){
+			BatchConversions::set_mean_anomaly_elliptic(kep,mu,delta_T);
+		}
+		else {
+			BatchConversions::set_mean_anomaly_hyperbolic(kep,mu,delta_T);
+		}
+
+	}
+
+	OrbitRegime BatchConversions::get_regime(double e){
+
+		if (std::abs(e - 1) < BatchConversions::near_parabolic_band){
+			return NEAR_PARABOLIC;
+		}
+		else if (e < 1){
+			return ELLIPTIC;
+		}
+		return HYPERBOLIC;
+
+	}
+
+	void BatchConversions::partition_by_regime(const arma::mat & states,
+		unsigned int eccentricity_row,
+		std::vector<std::vector<unsigned int> > & partitions){
+
+		partitions.resize(3);
+		for (unsigned int r = 0; r < 3; ++r){
+			partitions[r].clear();
+		}
+
+		for (unsigned int i = 0; i < states.n_cols; ++i){
+			partitions[BatchConversions::get_regime(states(eccentricity_row,i))].push_back(i);
+		}
+
+	}
+
+	void BatchConversions::get_perifocal_basis(const double * kep,double * P,double * Q){
+
+		double cos_Omega = std::cos(kep[3]);
+		double sin_Omega = std::sin(kep[3]);
+		double cos_omega = std::cos(kep[4]);
+		double sin_omega = std::sin(kep[4]);
+		double cos_i = std::cos(kep[2]);
+		double sin_i = std::sin(kep[2]);
+
+		P[0] = cos_omega * cos_Omega - sin_omega * cos_i * sin_Omega;
+		P[1] = cos_omega * sin_Omega + sin_omega * cos_i * cos_Omega;
+		P[2] = sin_omega * sin_i;
+
+		Q[0] = - sin_omega * cos_Omega - cos_omega * cos_i * sin_Omega;
+		Q[1] = - sin_omega * sin_Omega + cos_omega * cos_i * cos_Omega;
+		Q[2] = cos_omega * sin_i;
+
+	}
+
+	void BatchConversions::set_mean_anomaly_elliptic(double * kep,double mu,double delta_T){
+
+		double a = kep[0];
+		double e = kep[1];
+		double M = State::M_from_ecc(State::ecc_from_f(kep[5],e),e);
+
+		// mean motion
+		double n = std::sqrt(mu / (a * a * a));
+		kep[5] = M - n * delta_T;
+
+	}
+
+	void BatchConversions::set_mean_anomaly_hyperbolic(double * kep,double mu,double delta_T){
+
+		double a = kep[0];
+		double e = kep[1];
+		double M = State::M_from_H(State::H_from_f(kep[5],e),e);
+
+		// mean motion
+		double n = std::sqrt(- mu / (a * a * a));
+		kep[5] = M - n * delta_T;
+
+	}
+
+	void BatchConversions::cart_to_kep_near_parabolic_kernel(const double * cart,double mu,double delta_T,double * kep){
+
+		BatchConversions::cart_to_shape_kernel<KEP_ALL>(cart,mu,kep);
+
+		const double * r_vec = cart;
+		const double * v_vec = cart + 3;
+
+		double r = std::sqrt(r_vec[0] * r_vec[0] + r_vec[1] * r_vec[1] + r_vec[2] * r_vec[2]);
+		double r_dot_v = r_vec[0] * v_vec[0] + r_vec[1] * v_vec[1] + r_vec[2] * v_vec[2];
+		double h_vec[3] = {r_vec[1] * v_vec[2] - r_vec[2] * v_vec[1],
+			r_vec[2] * v_vec[0] - r_vec[0] * v_vec[2],
+			r_vec[0] * v_vec[1] - r_vec[1] * v_vec[0]};
+
+		// The conic parameter is well conditioned close to the parabola, unlike the energy. 
+		// Deriving a from it keeps a * (1 - e) consistent with the periapsis radius
+		double p = (h_vec[0] * h_vec[0] + h_vec[1] * h_vec[1] + h_vec[2] * h_vec[2]) / mu;
+		double e = kep[1];
+		double a = p / ((1 - e) * (1 + e));
+
+		// Two-argument form of the true anomaly, well conditioned at periapsis
+		double f = std::atan2(std::sqrt(p / mu) * r_dot_v / r,p / r - 1);
+		if (f < 0){
+			f += 2 * arma::datum::pi;
+		}
+
+		double abs_a = std::abs(a);
+		double one_minus_e = std::abs(1 - e);
+		double s = e < 1 ? 1 : -1;
+
+		double w = std::sqrt(one_minus_e / (1 + e)) * std::tan(f / 2);
+		double x = s > 0 ? 2 * std::atan(w) : 2 * std::atanh(w);
+
+		// M = |1 - e| x + e x^3 S(+-x^2), i.e x - e sin(x) or e sinh(x) - x without cancellation
+		double M = one_minus_e * x + e * x * x * x * State::stumpff_S(s * x * x);
+
+		// Unlike State::ecc_from_f, the mean anomaly is left in (-pi,pi]: shifting the small 
+		// negative anomalies found just before periapsis to [0,2 pi) would discard their precision
+
+		// mean motion
+		double n = std::sqrt(mu / (abs_a * abs_a * abs_a));
+
+		kep[0] = a;
+		kep[5] = M - n * delta_T;
+
+	}
+
+}
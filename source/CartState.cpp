@@ -110,22 +110,15 @@ namespace OC{
 		double omega = std::atan2(ON(0,2),ON(1,2));
 
 
-		double cos_e = 1./e * (p / this -> get_radius() - 1);
-		double f;
-		if (std::abs(cos_e - 1) < 1e-10){
-			f = 0;
-		}
-		else if (std::abs(cos_e + 1) < 1e-10){
-			f = arma::datum::pi;
-		}
-		else{
-			f = std::acos(cos_e);
-		}
-
-
-
-		if (arma::dot(this -> get_position_vector(),this -> get_velocity_vector()) < 0){
-			f = 2 * arma::datum::pi - f;
+    // true anomaly, from e cos(f) = p / r - 1 and e sin(f) = h (r.v) / (mu r).
+    // acos(cos(f)) would lose half of the digits of f near the apsides
+		double r = this -> get_radius();
+		double e_cos_f = p / r - 1;
+		double e_sin_f = h * arma::dot(this -> get_position_vector(),this -> get_velocity_vector()) / (this -> mu * r);
+		double f = std::atan2(e_sin_f,e_cos_f);
+
+		if (f < 0){
+			f += 2 * arma::datum::pi;
 		}
 
 		double ecc,M,H;
@@ -163,4 +156,13 @@ namespace OC{
 		return KepState(kep_state,this -> mu);
 
 	}
+
+	EquinoctialState CartState::convert_to_equinoctial(double delta_T) const{
+
+		arma::vec equinoctial_state(6);
+		EquinoctialState::from_cart_kernel(this -> state.memptr(),this -> mu,delta_T,equinoctial_state.memptr());
+		return EquinoctialState(equinoctial_state,this -> mu);
+
+	}
+
 }
\ No newline at end of file
@@ -0,0 +1,188 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/CloseApproach.hpp"
+
+namespace OC{
+
+	std::vector<CloseApproachEvent> CloseApproach::find_close_approaches(const KepState & kep_1,
+		const KepState & kep_2,
+		double t0,double t1,
+		double threshold,
+		unsigned int steps_per_period){
+
+		return CloseApproach::find_close_approaches(PreparedKepState(kep_1),
+			PreparedKepState(kep_2),
+			t0,t1,threshold,steps_per_period);
+	}
+
+	std::vector<CloseApproachEvent> CloseApproach::find_close_approaches(const PreparedKepState & orbit_1,
+		const PreparedKepState & orbit_2,
+		double t0,double t1,
+		double threshold,
+		unsigned int steps_per_period){
+
+		std::vector<CloseApproachEvent> events;
+
+		if (t1 <= t0){
+			return events;
+		}
+
+		// Coarse step, bounded by the shortest characteristic time
+		double time_scale = std::min(orbit_1.get_time_scale(),orbit_2.get_time_scale());
+		unsigned int N_steps = std::max(1u,(unsigned int)(std::ceil((t1 - t0) / time_scale * steps_per_period)));
+		double h = (t1 - t0) / N_steps;
+
+		// Bound on the relative speed, used to skip brackets that cannot get below threshold
+		double max_relative_speed = orbit_1.get_max_speed() + orbit_2.get_max_speed();
+
+		double distance_a,distance_b,speed_a,speed_b;
+		double t_a = t0;
+		double g_a = CloseApproach::range_rate_function(orbit_1,orbit_2,t_a,distance_a,speed_a);
+
+		for (unsigned int k = 0; k < N_steps; ++k){
+
+			double t_b = t0 + (k + 1) * h;
+			double g_b = CloseApproach::range_rate_function(orbit_1,orbit_2,t_b,distance_b,speed_b);
+
+			// A distance minimum is bracketed when the range-rate goes from negative to positive
+			if (g_a < 0 && g_b >= 0 && 0.5 * (distance_a + distance_b - max_relative_speed * h) < threshold){
+
+				// Illinois variant of the regula falsi
+				double t_low = t_a;
+				double t_up = t_b;
+				double g_low = g_a;
+				double g_up = g_b;
+				double t_root = t_b;
+				double distance = distance_b;
+				double relative_speed = speed_b;
+				int side = 0;
+
+				for (unsigned int i = 0; i < 100; ++i){
+
+					t_root = (t_low * g_up - t_up * g_low) / (g_up - g_low);
+					double g_root = CloseApproach::range_rate_function(orbit_1,orbit_2,t_root,distance,relative_speed);
+
+					if (g_root == 0 || t_up - t_low < 1e-12 * h){
+						break;
+					}
+
+					if (g_root < 0){
+						t_low = t_root;
+						g_low = g_root;
+						if (side == -1){
+							g_up /= 2;
+						}
+						side = -1;
+					}
+					else{
+						t_up = t_root;
+						g_up = g_root;
+						if (side == 1){
+							g_low /= 2;
+						}
+						side = 1;
+					}
+
+					if (std::abs(g_root) < 1e-14 * distance * relative_speed){
+						break;
+					}
+
+				}
+
+				if (distance < threshold){
+					CloseApproachEvent event;
+					event.t = t_root;
+					event.distance = distance;
+					event.relative_speed = relative_speed;
+					events.push_back(event);
+				}
+			}
+
+			t_a = t_b;
+			g_a = g_b;
+			distance_a = distance_b;
+			speed_a = speed_b;
+
+		}
+
+		return events;
+
+	}
+
+	std::vector<std::vector<CloseApproachEvent> > CloseApproach::find_close_approaches(const std::vector<KepState> & catalog,
+		const std::vector<std::pair<unsigned int,unsigned int> > & candidates,
+		double t0,double t1,
+		double threshold,
+		unsigned int steps_per_period){
+
+		std::vector<PreparedKepState> prepared_catalog(catalog.size());
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < catalog.size(); ++i){
+			prepared_catalog[i] = PreparedKepState(catalog[i]);
+		}
+
+		std::vector<std::vector<CloseApproachEvent> > events(candidates.size());
+
+		#pragma omp parallel for schedule(dynamic,64)
+		for (unsigned int k = 0; k < candidates.size(); ++k){
+			events[k] = CloseApproach::find_close_approaches(prepared_catalog[candidates[k].first],
+				prepared_catalog[candidates[k].second],
+				t0,t1,threshold,steps_per_period);
+		}
+
+		return events;
+
+	}
+
+	double CloseApproach::range_rate_function(const PreparedKepState & orbit_1,
+		const PreparedKepState & orbit_2,
+		double t,
+		double & distance,
+		double & relative_speed){
+
+		double pos_1[3],vel_1[3],pos_2[3],vel_2[3];
+
+		orbit_1.get_position_velocity(t,pos_1,vel_1);
+		orbit_2.get_position_velocity(t,pos_2,vel_2);
+
+		double g = 0;
+		double distance_squared = 0;
+		double speed_squared = 0;
+
+		for (int k = 0; k < 3; ++k){
+			double dr = pos_2[k] - pos_1[k];
+			double dv = vel_2[k] - vel_1[k];
+			g += dr * dv;
+			distance_squared += dr * dr;
+			speed_squared += dv * dv;
+		}
+
+		distance = std::sqrt(distance_squared);
+		relative_speed = std::sqrt(speed_squared);
+
+		return g;
+
+	}
+
+}
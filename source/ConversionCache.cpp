@@ -0,0 +1,190 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/ConversionCache.hpp"
+#include <cstring>
+
+namespace OC{
+
+	ConversionCache::ConversionCache(unsigned int capacity,unsigned int shards) : hits(0),misses(0){
+
+		shards = std::max(1u,std::min(shards,std::max(1u,capacity)));
+		this -> shard_capacity = std::max(1u,(capacity + shards - 1) / shards);
+
+		for (unsigned int s = 0; s < shards; ++s){
+			this -> shards.push_back(std::unique_ptr<Shard>(new Shard()));
+			this -> shards.back() -> index.reserve(this -> shard_capacity);
+		}
+
+	}
+
+	KepState ConversionCache::convert_to_kep(const CartState & cart,double delta_T){
+
+		Key key = ConversionCache::make_key(CART_TO_KEP,cart.get_state(),cart.get_mu(),delta_T);
+		arma::vec result(6);
+
+		if (this -> find(key,result.memptr())){
+			return KepState(result,cart.get_mu());
+		}
+
+		KepState kep = cart.convert_to_kep(delta_T);
+		this -> insert(key,kep.get_state().memptr());
+		return kep;
+
+	}
+
+	CartState ConversionCache::convert_to_cart(const KepState & kep,double delta_T){
+
+		Key key = ConversionCache::make_key(KEP_TO_CART,kep.get_state(),kep.get_mu(),delta_T);
+		arma::vec result(6);
+
+		if (this -> find(key,result.memptr())){
+			return CartState(result,kep.get_mu());
+		}
+
+		CartState cart = kep.convert_to_cart(delta_T);
+		this -> insert(key,cart.get_state().memptr());
+		return cart;
+
+	}
+
+	void ConversionCache::clear(){
+
+		for (unsigned int s = 0; s < this -> shards.size(); ++s){
+			std::lock_guard<std::mutex> lock(this -> shards[s] -> mutex);
+			this -> shards[s] -> entries.clear();
+			this -> shards[s] -> index.clear();
+		}
+
+		this -> hits = 0;
+		this -> misses = 0;
+
+	}
+
+	unsigned long long ConversionCache::get_hits() const{
+		return this -> hits.load();
+	}
+
+	unsigned long long ConversionCache::get_misses() const{
+		return this -> misses.load();
+	}
+
+	unsigned int ConversionCache::get_size() const{
+
+		unsigned int size = 0;
+		for (unsigned int s = 0; s < this -> shards.size(); ++s){
+			std::lock_guard<std::mutex> lock(this -> shards[s] -> mutex);
+			size += this -> shards[s] -> entries.size();
+		}
+		return size;
+
+	}
+
+	unsigned int ConversionCache::get_capacity() const{
+		return this -> shard_capacity * this -> shards.size();
+	}
+
+	bool ConversionCache::find(const Key & key,double * result){
+
+		Shard & shard = this -> get_shard(key);
+
+		{
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			auto it = shard.index.find(key);
+
+			if (it != shard.index.end()){
+				shard.entries.splice(shard.entries.begin(),shard.entries,it -> second);
+				std::copy(it -> second -> result,it -> second -> result + 6,result);
+				this -> hits.fetch_add(1,std::memory_order_relaxed);
+				return true;
+			}
+		}
+
+		this -> misses.fetch_add(1,std::memory_order_relaxed);
+		return false;
+
+	}
+
+	void ConversionCache::insert(const Key & key,const double * result){
+
+		Shard & shard = this -> get_shard(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		// Another thread may have converted the same query in the meantime
+		auto it = shard.index.find(key);
+		if (it != shard.index.end()){
+			shard.entries.splice(shard.entries.begin(),shard.entries,it -> second);
+			return;
+		}
+
+		if (shard.entries.size() >= this -> shard_capacity){
+			shard.index.erase(shard.entries.back().key);
+			shard.entries.pop_back();
+		}
+
+		Entry entry;
+		entry.key = key;
+		std::copy(result,result + 6,entry.result);
+		shard.entries.push_front(entry);
+		shard.index[key] = shard.entries.begin();
+
+	}
+
+	ConversionCache::Shard & ConversionCache::get_shard(const Key & key){
+
+		// The low bits of the hash index the buckets of the shard maps, 
+		// so the shard is drawn from the high bits
+		unsigned long long hash = KeyHash()(key);
+		return *this -> shards[(hash >> 32) % this -> shards.size()];
+
+	}
+
+	ConversionCache::Key ConversionCache::make_key(ConversionType type,const arma::vec & state,double mu,double delta_T){
+
+		Key key;
+		std::memcpy(key.bits,state.memptr(),6 * sizeof(double));
+		std::memcpy(key.bits + 6,&mu,sizeof(double));
+		std::memcpy(key.bits + 7,&delta_T,sizeof(double));
+		key.bits[8] = type;
+		return key;
+
+	}
+
+	bool ConversionCache::Key::operator==(const Key & other) const{
+		return std::memcmp(this -> bits,other.bits,sizeof(this -> bits)) == 0;
+	}
+
+	size_t ConversionCache::KeyHash::operator()(const Key & key) const{
+
+		// splitmix64 finalizer applied to each word
+		unsigned long long hash = 0x9e3779b97f4a7c15ULL;
+		for (unsigned int k = 0; k < 9; ++k){
+			unsigned long long z = key.bits[k] + hash + 0x9e3779b97f4a7c15ULL;
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			hash = z ^ (z >> 31);
+		}
+		return hash;
+
+	}
+
+}
@@ -0,0 +1,298 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/ConversionService.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace OC{
+
+	ConversionService::ConversionService(const ServiceSettings & settings){
+
+		this -> settings = settings;
+
+		this -> stub.next.store(nullptr);
+		this -> head.store(&this -> stub);
+		this -> tail = &this -> stub;
+
+		this -> requests.store(0);
+		this -> batches.store(0);
+
+		this -> running.store(true);
+		this -> worker = std::thread(&ConversionService::run,this);
+
+	}
+
+	ConversionService::~ConversionService(){
+		this -> stop();
+	}
+
+	std::future<arma::mat> ConversionService::submit(RequestType type,const arma::mat & states,double mu,double delta_T){
+
+		this -> check_submission(states);
+
+		Request * request = new Request;
+		request -> type = type;
+		request -> states = states;
+		request -> mu = mu;
+		request -> delta_T = delta_T;
+		request -> submitted = std::chrono::steady_clock::now();
+
+		std::future<arma::mat> future = request -> promise.get_future();
+		this -> push(request);
+		return future;
+
+	}
+
+	void ConversionService::submit(RequestType type,const arma::mat & states,double mu,double delta_T,Callback callback){
+
+		this -> check_submission(states);
+
+		Request * request = new Request;
+		request -> type = type;
+		request -> states = states;
+		request -> mu = mu;
+		request -> delta_T = delta_T;
+		request -> submitted = std::chrono::steady_clock::now();
+		request -> callback = callback;
+
+		this -> push(request);
+
+	}
+
+	void ConversionService::check_submission(const arma::mat & states) const{
+
+		// A request queued after the worker has left would never be completed
+		if (!this -> running.load()){
+			throw std::logic_error("ConversionService::submit: the service is stopped");
+		}
+
+		// The worker reads 6 doubles per column straight from the state buffer
+		if (states.n_rows != 6){
+			throw std::invalid_argument("ConversionService::submit: states must have 6 rows, got " + std::to_string(states.n_rows));
+		}
+
+	}
+
+	void ConversionService::stop(){
+
+		if (this -> worker.joinable()){
+			this -> running.store(false);
+			this -> worker.join();
+		}
+
+	}
+
+	unsigned long long ConversionService::get_requests() const{
+		return this -> requests.load();
+	}
+
+	unsigned long long ConversionService::get_batches() const{
+		return this -> batches.load();
+	}
+
+	std::exception_ptr ConversionService::get_callback_exception() const{
+		std::lock_guard<std::mutex> lock(this -> callback_exception_mutex);
+		return this -> callback_exception;
+	}
+
+	void ConversionService::push(Request * request){
+
+		request -> next.store(nullptr,std::memory_order_relaxed);
+		Request * previous = this -> head.exchange(request,std::memory_order_acq_rel);
+		previous -> next.store(request,std::memory_order_release);
+
+	}
+
+	ConversionService::Request * ConversionService::pop(){
+
+		Request * tail = this -> tail;
+		Request * next = tail -> next.load(std::memory_order_acquire);
+
+		// Skips the stub
+		if (tail == &this -> stub){
+			if (next == nullptr){
+				return nullptr;
+			}
+			this -> tail = next;
+			tail = next;
+			next = next -> next.load(std::memory_order_acquire);
+		}
+
+		if (next != nullptr){
+			this -> tail = next;
+			return tail;
+		}
+
+		// A producer has exchanged head but not linked its request yet
+		if (tail != this -> head.load(std::memory_order_acquire)){
+			return nullptr;
+		}
+
+		// tail is the last request: the stub is pushed back behind it so that tail can be detached
+		this -> push(&this -> stub);
+		next = tail -> next.load(std::memory_order_acquire);
+		if (next != nullptr){
+			this -> tail = next;
+			return tail;
+		}
+
+		return nullptr;
+
+	}
+
+	void ConversionService::run(){
+
+		std::vector<Request *> batch;
+		auto budget = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+			std::chrono::duration<double>(this -> settings.latency_budget));
+		unsigned int idle_polls = 0;
+
+		while (true){
+
+			Request * request = this -> pop();
+
+			if (request == nullptr){
+
+				// Pending requests are completed before the worker leaves
+				if (!this -> running.load() && this -> head.load() == this -> tail){
+					break;
+				}
+
+				if (++idle_polls < 64){
+					std::this_thread::yield();
+				}
+				else{
+					std::this_thread::sleep_for(std::chrono::microseconds(20));
+				}
+				continue;
+
+			}
+
+			idle_polls = 0;
+
+			// Coalesces requests until the batch is full or the oldest request has used up its budget
+			auto deadline = request -> submitted + budget;
+			unsigned int size = request -> states.n_cols;
+			batch.push_back(request);
+
+			while (size < this -> settings.max_batch_size){
+				request = this -> pop();
+				if (request != nullptr){
+					size += request -> states.n_cols;
+					batch.push_back(request);
+				}
+				else if (std::chrono::steady_clock::now() < deadline){
+					std::this_thread::yield();
+				}
+				else{
+					break;
+				}
+			}
+
+			this -> dispatch(batch);
+			batch.clear();
+
+		}
+
+	}
+
+	void ConversionService::dispatch(std::vector<Request *> & batch){
+
+		// Counted before any request completes, so that the statistics are up to date when a future becomes ready
+		this -> requests += batch.size();
+		++this -> batches;
+
+		// Requests are grouped by conversion, mu and delta_T, keeping their arrival order within a group
+		std::stable_sort(batch.begin(),batch.end(),
+			[](const Request * lhs,const Request * rhs){
+				if (lhs -> type != rhs -> type){
+					return lhs -> type < rhs -> type;
+				}
+				if (lhs -> mu != rhs -> mu){
+					return lhs -> mu < rhs -> mu;
+				}
+				return lhs -> delta_T < rhs -> delta_T;
+			});
+
+		arma::mat inputs,outputs;
+
+		for (unsigned int first = 0; first < batch.size(); ){
+
+			unsigned int last = first;
+			unsigned int size = 0;
+			while (last < batch.size() 
+				&& batch[last] -> type == batch[first] -> type 
+				&& batch[last] -> mu == batch[first] -> mu 
+				&& batch[last] -> delta_T == batch[first] -> delta_T){
+				size += batch[last] -> states.n_cols;
+				++last;
+			}
+
+			inputs.set_size(6,size);
+			unsigned int column = 0;
+			for (unsigned int k = first; k < last; ++k){
+				std::copy(batch[k] -> states.memptr(),batch[k] -> states.memptr() + 6 * batch[k] -> states.n_cols,inputs.colptr(column));
+				column += batch[k] -> states.n_cols;
+			}
+
+			if (batch[first] -> type == KEP_TO_CART){
+				BatchConversions::kep_to_cart(inputs,batch[first] -> mu,batch[first] -> delta_T,outputs);
+			}
+			else{
+				BatchConversions::cart_to_kep(inputs,batch[first] -> mu,batch[first] -> delta_T,outputs);
+			}
+
+			column = 0;
+			for (unsigned int k = first; k < last; ++k){
+				arma::mat result(6,batch[k] -> states.n_cols);
+				std::copy(outputs.colptr(column),outputs.colptr(column) + 6 * batch[k] -> states.n_cols,result.memptr());
+				column += batch[k] -> states.n_cols;
+
+				if (batch[k] -> callback){
+
+					// A throwing callback must not reach std::terminate on the worker thread
+					try{
+						batch[k] -> callback(result);
+					}
+					catch (...){
+						std::lock_guard<std::mutex> lock(this -> callback_exception_mutex);
+						if (!this -> callback_exception){
+							this -> callback_exception = std::current_exception();
+						}
+					}
+
+				}
+				else{
+					batch[k] -> promise.set_value(result);
+				}
+				delete batch[k];
+			}
+
+			first = last;
+
+		}
+
+	}
+
+}
@@ -0,0 +1,489 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/CovarianceMapping.hpp"
+
+namespace OC{
+
+	typedef Dual<6> Dual6;
+
+	template <typename T> void CovarianceMapping::kep_to_cart_kernel(const T * kep,double mu,double delta_T,T * cart){
+
+		using std::sin;
+		using std::cos;
+		using std::sqrt;
+		using std::abs;
+		using std::atan;
+		using std::tanh;
+
+		const T & a = kep[0];
+		const T & e = kep[1];
+
+		T n = sqrt(mu / (abs(a) * abs(a) * abs(a)));
+		T M = kep[5] + n * delta_T;
+
+		T x,y,x_dot,y_dot;
+
+		if (value(e) < 1){
+
+			// The anomaly is solved on the values only, then a single Newton step 
+			// carried in T recovers the partials of the implicit solution
+			double M_value = value(M);
+			double M_wrapped = std::remainder(M_value,2 * arma::datum::pi);
+			double ecc_value = State::ecc_from_M(M_wrapped,value(e)) + (M_value - M_wrapped);
+
+			T ecc = ecc_value - (ecc_value - e * std::sin(ecc_value) - M) / (1 - e * std::cos(ecc_value));
+			T cos_ecc = cos(ecc);
+			T sin_ecc = sin(ecc);
+			T b_factor = sqrt(1 - e * e);
+			T sqrt_mu_a = sqrt(mu * a);
+			T r = a * (1 - e * cos_ecc);
+
+			x = a * (cos_ecc - e);
+			y = a * b_factor * sin_ecc;
+			x_dot = - sqrt_mu_a * sin_ecc / r;
+			y_dot = sqrt_mu_a * b_factor * cos_ecc / r;
+		}
+		else{
+
+			double H_value = State::H_from_M(value(M),value(e));
+			T H = H_value - (e * std::sinh(H_value) - H_value - M) / (e * std::cosh(H_value) - 1);
+			T f = 2 * atan(sqrt((1 + e) / (e - 1)) * tanh(H / 2));
+
+			if (value(H) < 0 && value(f) > 0){
+				f = f - 2 * arma::datum::pi;
+			}
+			else if (value(H) > 0 && value(f) < 0){
+				f = f + 2 * arma::datum::pi;
+			}
+
+			T cos_f = cos(f);
+			T sin_f = sin(f);
+			T p = a * (1 - e * e);
+			T sqrt_mu_p = sqrt(mu / p);
+			T r = p / (1 + e * cos_f);
+
+			x = r * cos_f;
+			y = r * sin_f;
+			x_dot = - sqrt_mu_p * sin_f;
+			y_dot = sqrt_mu_p * (e + cos_f);
+		}
+
+		T cos_Omega = cos(kep[3]);
+		T sin_Omega = sin(kep[3]);
+		T cos_omega = cos(kep[4]);
+		T sin_omega = sin(kep[4]);
+		T cos_i = cos(kep[2]);
+		T sin_i = sin(kep[2]);
+
+		T P[3] = {cos_omega * cos_Omega - sin_omega * cos_i * sin_Omega,
+			cos_omega * sin_Omega + sin_omega * cos_i * cos_Omega,
+			sin_omega * sin_i};
+
+		T Q[3] = {- sin_omega * cos_Omega - cos_omega * cos_i * sin_Omega,
+			- sin_omega * sin_Omega + cos_omega * cos_i * cos_Omega,
+			cos_omega * sin_i};
+
+		for (int k = 0; k < 3; ++k){
+			cart[k] = x * P[k] + y * Q[k];
+			cart[k + 3] = x_dot * P[k] + y_dot * Q[k];
+		}
+
+	}
+
+	template <typename T> void CovarianceMapping::cart_to_kep_kernel(const T * cart,double mu,double delta_T,T * kep){
+
+		using std::sin;
+		using std::cos;
+		using std::sqrt;
+		using std::abs;
+		using std::atan2;
+		using std::atanh;
+		using std::sinh;
+		using std::acos;
+		using std::tan;
+
+		const T * r_vec = cart;
+		const T * v_vec = cart + 3;
+
+		T r = sqrt(r_vec[0] * r_vec[0] + r_vec[1] * r_vec[1] + r_vec[2] * r_vec[2]);
+		T v2 = v_vec[0] * v_vec[0] + v_vec[1] * v_vec[1] + v_vec[2] * v_vec[2];
+		T r_dot_v = r_vec[0] * v_vec[0] + r_vec[1] * v_vec[1] + r_vec[2] * v_vec[2];
+
+		// semi major axis
+		T a = - mu / (v2 - 2 * mu / r);
+
+		// spacecraft's angular momentum
+		T h_vec[3] = {r_vec[1] * v_vec[2] - r_vec[2] * v_vec[1],
+			r_vec[2] * v_vec[0] - r_vec[0] * v_vec[2],
+			r_vec[0] * v_vec[1] - r_vec[1] * v_vec[0]};
+		T h = sqrt(h_vec[0] * h_vec[0] + h_vec[1] * h_vec[1] + h_vec[2] * h_vec[2]);
+
+		// eccentricity
+		T e_vec[3] = {(v_vec[1] * h_vec[2] - v_vec[2] * h_vec[1]) / mu - r_vec[0] / r,
+			(v_vec[2] * h_vec[0] - v_vec[0] * h_vec[2]) / mu - r_vec[1] / r,
+			(v_vec[0] * h_vec[1] - v_vec[1] * h_vec[0]) / mu - r_vec[2] / r};
+		T e = sqrt(e_vec[0] * e_vec[0] + e_vec[1] * e_vec[1] + e_vec[2] * e_vec[2]);
+
+		// conic parameter
+		T p = h * h / mu;
+
+		// orbit DCM elements used by the angles
+		T h_hat[3] = {h_vec[0] / h,h_vec[1] / h,h_vec[2] / h};
+		T ON_02 = e_vec[2] / e;
+		T ON_12 = (h_hat[0] * e_vec[1] - h_hat[1] * e_vec[0]) / e;
+
+		T Omega = atan2(h_hat[0],- h_hat[1]);
+		T i = acos(h_hat[2]);
+		T omega = atan2(ON_02,ON_12);
+
+		// The two-argument form keeps the partials finite at the apsides, 
+		// where the arc-cosine used by CartState::convert_to_kep is not differentiable
+		T f = atan2(sqrt(p / mu) * r_dot_v / r,p / r - 1);
+		if (value(f) < 0){
+			f = f + 2 * arma::datum::pi;
+		}
+
+		T M;
+		if (value(e) < 1){
+			T ecc = atan2(sqrt(1 - e * e) * sin(f),e + cos(f));
+			if (value(ecc) < 0){
+				ecc = ecc + 2 * arma::datum::pi;
+			}
+			M = ecc - e * sin(ecc);
+		}
+		else {
+			T H = 2 * atanh(sqrt((e - 1) / (1 + e)) * tan(f / 2));
+			M = e * sinh(H) - H;
+		}
+
+		// mean motion
+		T n = sqrt(mu / (abs(a) * abs(a) * abs(a)));
+
+		kep[0] = a;
+		kep[1] = e;
+		kep[2] = i;
+		kep[3] = Omega;
+		kep[4] = omega;
+		kep[5] = M - n * delta_T;
+
+	}
+
+	template void CovarianceMapping::kep_to_cart_kernel<double>(const double *,double,double,double *);
+	template void CovarianceMapping::kep_to_cart_kernel<Dual6>(const Dual6 *,double,double,Dual6 *);
+	template void CovarianceMapping::cart_to_kep_kernel<double>(const double *,double,double,double *);
+	template void CovarianceMapping::cart_to_kep_kernel<Dual6>(const Dual6 *,double,double,Dual6 *);
+
+	void CovarianceMapping::kep_to_cart_jacobian(const double * kep,double mu,double delta_T,double * cart,double * J){
+
+		Dual6 kep_dual[6];
+		Dual6 cart_dual[6];
+
+		for (unsigned int k = 0; k < 6; ++k){
+			kep_dual[k] = Dual6::variable(kep[k],k);
+		}
+
+		CovarianceMapping::kep_to_cart_kernel(kep_dual,mu,delta_T,cart_dual);
+
+		for (unsigned int row = 0; row < 6; ++row){
+			cart[row] = cart_dual[row].v;
+			for (unsigned int col = 0; col < 6; ++col){
+				J[row + 6 * col] = cart_dual[row].d[col];
+			}
+		}
+
+	}
+
+	void CovarianceMapping::cart_to_kep_jacobian(const double * cart,double mu,double delta_T,double * kep,double * J){
+
+		Dual6 cart_dual[6];
+		Dual6 kep_dual[6];
+
+		for (unsigned int k = 0; k < 6; ++k){
+			cart_dual[k] = Dual6::variable(cart[k],k);
+		}
+
+		CovarianceMapping::cart_to_kep_kernel(cart_dual,mu,delta_T,kep_dual);
+
+		for (unsigned int row = 0; row < 6; ++row){
+			kep[row] = kep_dual[row].v;
+			for (unsigned int col = 0; col < 6; ++col){
+				J[row + 6 * col] = kep_dual[row].d[col];
+			}
+		}
+
+	}
+
+	void CovarianceMapping::propagation_jacobian(const double * cart,double mu,double dt,double * propagated_cart,double * J){
+
+		Dual6 cart_dual[6];
+		Dual6 kep_dual[6];
+		Dual6 propagated_dual[6];
+
+		for (unsigned int k = 0; k < 6; ++k){
+			cart_dual[k] = Dual6::variable(cart[k],k);
+		}
+
+		CovarianceMapping::cart_to_kep_kernel(cart_dual,mu,0,kep_dual);
+		CovarianceMapping::kep_to_cart_kernel(kep_dual,mu,dt,propagated_dual);
+
+		for (unsigned int row = 0; row < 6; ++row){
+			propagated_cart[row] = propagated_dual[row].v;
+			for (unsigned int col = 0; col < 6; ++col){
+				J[row + 6 * col] = propagated_dual[row].d[col];
+			}
+		}
+
+	}
+
+	void CovarianceMapping::kep_to_cart(const arma::mat & kep_states,
+		const PackedCovariances & kep_covariances,
+		double mu,double delta_T,
+		arma::mat & cart_states,
+		PackedCovariances & cart_covariances,
+		CovarianceMappingMode mode,
+		const UnscentedParameters & parameters){
+
+		unsigned int N = kep_states.n_cols;
+		cart_states.set_size(6,N);
+		if (cart_covariances.get_size() != N){
+			cart_covariances.set_size(N);
+		}
+
+		const bool wrapped[6] = {false,false,false,false,false,false};
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+
+			if (mode == UNSCENTED){
+				auto map = [mu,delta_T](const double * kep,double * cart){
+					CovarianceMapping::kep_to_cart_kernel(kep,mu,delta_T,cart);
+				};
+				CovarianceMapping::unscented_transform(kep_states.colptr(i),kep_covariances,i,
+					map,wrapped,parameters,cart_states.colptr(i),cart_covariances);
+			}
+			else{
+				double J[36];
+				CovarianceMapping::kep_to_cart_jacobian(kep_states.colptr(i),mu,delta_T,cart_states.colptr(i),J);
+				CovarianceMapping::transform_covariance(J,kep_covariances,i,cart_covariances);
+			}
+
+		}
+
+	}
+
+	void CovarianceMapping::cart_to_kep(const arma::mat & cart_states,
+		const PackedCovariances & cart_covariances,
+		double mu,double delta_T,
+		arma::mat & kep_states,
+		PackedCovariances & kep_covariances,
+		CovarianceMappingMode mode,
+		const UnscentedParameters & parameters){
+
+		unsigned int N = cart_states.n_cols;
+		kep_states.set_size(6,N);
+		if (kep_covariances.get_size() != N){
+			kep_covariances.set_size(N);
+		}
+
+		const bool wrapped[6] = {false,false,false,true,true,true};
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+
+			if (mode == UNSCENTED){
+				auto map = [mu,delta_T](const double * cart,double * kep){
+					CovarianceMapping::cart_to_kep_kernel(cart,mu,delta_T,kep);
+				};
+				CovarianceMapping::unscented_transform(cart_states.colptr(i),cart_covariances,i,
+					map,wrapped,parameters,kep_states.colptr(i),kep_covariances);
+			}
+			else{
+				double J[36];
+				CovarianceMapping::cart_to_kep_jacobian(cart_states.colptr(i),mu,delta_T,kep_states.colptr(i),J);
+				CovarianceMapping::transform_covariance(J,cart_covariances,i,kep_covariances);
+			}
+
+		}
+
+	}
+
+	void CovarianceMapping::propagate(const arma::mat & cart_states,
+		const PackedCovariances & cart_covariances,
+		double mu,double dt,
+		arma::mat & propagated_states,
+		PackedCovariances & propagated_covariances,
+		CovarianceMappingMode mode,
+		const UnscentedParameters & parameters){
+
+		unsigned int N = cart_states.n_cols;
+		propagated_states.set_size(6,N);
+		if (propagated_covariances.get_size() != N){
+			propagated_covariances.set_size(N);
+		}
+
+		const bool wrapped[6] = {false,false,false,false,false,false};
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+
+			if (mode == UNSCENTED){
+				auto map = [mu,dt](const double * cart,double * propagated_cart){
+					double kep[6];
+					CovarianceMapping::cart_to_kep_kernel(cart,mu,0.,kep);
+					CovarianceMapping::kep_to_cart_kernel(kep,mu,dt,propagated_cart);
+				};
+				CovarianceMapping::unscented_transform(cart_states.colptr(i),cart_covariances,i,
+					map,wrapped,parameters,propagated_states.colptr(i),propagated_covariances);
+			}
+			else{
+				double J[36];
+				CovarianceMapping::propagation_jacobian(cart_states.colptr(i),mu,dt,propagated_states.colptr(i),J);
+				CovarianceMapping::transform_covariance(J,cart_covariances,i,propagated_covariances);
+			}
+
+		}
+
+	}
+
+	void CovarianceMapping::transform_covariance(const double * J,
+		const PackedCovariances & input,
+		unsigned int i,
+		PackedCovariances & output){
+
+		double P[36];
+		input.unpack(i,P);
+
+		// JP = J * P
+		double JP[36];
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row < 6; ++row){
+				double sum = 0;
+				for (unsigned int k = 0; k < 6; ++k){
+					sum += J[row + 6 * k] * P[k + 6 * col];
+				}
+				JP[row + 6 * col] = sum;
+			}
+		}
+
+		// Only the upper triangle of JP * J^T is formed, straight into the packed storage
+		unsigned int c = 0;
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row <= col; ++row, ++c){
+				double sum = 0;
+				for (unsigned int k = 0; k < 6; ++k){
+					sum += JP[row + 6 * k] * J[col + 6 * k];
+				}
+				output.component(c)[i] = sum;
+			}
+		}
+
+	}
+
+	template <typename Map> void CovarianceMapping::unscented_transform(const double * x,
+		const PackedCovariances & input,
+		unsigned int i,
+		const Map & map,
+		const bool * wrapped_output,
+		const UnscentedParameters & parameters,
+		double * y,
+		PackedCovariances & output){
+
+		const unsigned int n = 6;
+		double lambda = parameters.alpha * parameters.alpha * (n + parameters.kappa) - n;
+		double scale = std::sqrt(n + lambda);
+
+		double W0_mean = lambda / (n + lambda);
+		double W0_cov = W0_mean + 1 - parameters.alpha * parameters.alpha + parameters.beta;
+		double Wi = 1. / (2 * (n + lambda));
+
+		// Lower Cholesky factor of the covariance. Non-positive pivots are 
+		// zeroed so that semi-definite covariances are accepted
+		double L[36];
+		input.unpack(i,L);
+		for (unsigned int col = 0; col < n; ++col){
+			double pivot = L[col + n * col];
+			for (unsigned int k = 0; k < col; ++k){
+				pivot -= L[col + n * k] * L[col + n * k];
+			}
+			pivot = pivot > 0 ? std::sqrt(pivot) : 0;
+			L[col + n * col] = pivot;
+
+			for (unsigned int row = col + 1; row < n; ++row){
+				double sum = L[row + n * col];
+				for (unsigned int k = 0; k < col; ++k){
+					sum -= L[row + n * k] * L[col + n * k];
+				}
+				L[row + n * col] = pivot > 0 ? sum / pivot : 0;
+			}
+			for (unsigned int row = 0; row < col; ++row){
+				L[row + n * col] = 0;
+			}
+		}
+
+		// Mapped sigma points, stored as deviations from the mapped central point
+		double y_center[6];
+		double deviations[12][6];
+		map(x,y_center);
+
+		for (unsigned int s = 0; s < 2 * n; ++s){
+			double sigma_point[6];
+			double sign = s < n ? 1 : -1;
+			for (unsigned int k = 0; k < n; ++k){
+				sigma_point[k] = x[k] + sign * scale * L[k + n * (s % n)];
+			}
+
+			double y_sigma[6];
+			map(sigma_point,y_sigma);
+
+			for (unsigned int k = 0; k < n; ++k){
+				deviations[s][k] = y_sigma[k] - y_center[k];
+				if (wrapped_output[k]){
+					deviations[s][k] = std::remainder(deviations[s][k],2 * arma::datum::pi);
+				}
+			}
+		}
+
+		double mean_deviation[6];
+		for (unsigned int k = 0; k < n; ++k){
+			double sum = 0;
+			for (unsigned int s = 0; s < 2 * n; ++s){
+				sum += deviations[s][k];
+			}
+			mean_deviation[k] = Wi * sum;
+			y[k] = y_center[k] + mean_deviation[k];
+		}
+
+		unsigned int c = 0;
+		for (unsigned int col = 0; col < n; ++col){
+			for (unsigned int row = 0; row <= col; ++row, ++c){
+				double sum = W0_cov * mean_deviation[row] * mean_deviation[col];
+				for (unsigned int s = 0; s < 2 * n; ++s){
+					sum += Wi * (deviations[s][row] - mean_deviation[row]) * (deviations[s][col] - mean_deviation[col]);
+				}
+				output.component(c)[i] = sum;
+			}
+		}
+
+	}
+
+}
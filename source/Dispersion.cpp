@@ -0,0 +1,190 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/Dispersion.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+
+namespace OC{
+
+	std::vector<DispersionStatistics> Dispersion::propagate(const KepState & nominal,
+		const arma::mat & perturbations,
+		const arma::vec & times,
+		unsigned int block_size){
+
+		return Dispersion::propagate(nominal.get_state(),nominal.get_mu(),false,perturbations,times,block_size);
+
+	}
+
+	std::vector<DispersionStatistics> Dispersion::propagate(const CartState & nominal,
+		const arma::mat & perturbations,
+		const arma::vec & times,
+		unsigned int block_size){
+
+		return Dispersion::propagate(nominal.get_state(),nominal.get_mu(),true,perturbations,times,block_size);
+
+	}
+
+	std::vector<DispersionStatistics> Dispersion::propagate(const arma::vec & nominal_state,
+		double mu,
+		bool cartesian,
+		const arma::mat & perturbations,
+		const arma::vec & times,
+		unsigned int block_size){
+
+		unsigned int S = perturbations.n_cols;
+		unsigned int T = times.n_rows;
+		block_size = std::max(block_size,1u);
+		unsigned int blocks = (S + block_size - 1) / block_size;
+
+		double nominal_elements[6];
+		if (cartesian){
+			BatchConversions::cart_to_kep_kernel(nominal_state.memptr(),mu,0,nominal_elements);
+		}
+		else{
+			std::copy(nominal_state.memptr(),nominal_state.memptr() + 6,nominal_elements);
+		}
+		PreparedKepState nominal(nominal_elements,mu);
+
+		// Nominal anomalies, used as starting points of the sample Kepler solves
+		std::vector<double> nominal_anomalies(T);
+		for (unsigned int j = 0; j < T; ++j){
+			nominal_anomalies[j] = nominal.get_anomaly(times(j));
+		}
+
+		// Partial statistics of each block, block-major
+		std::vector<MomentAccumulator> accumulators(blocks * T);
+
+		#pragma omp parallel for schedule(dynamic)
+		for (unsigned int b = 0; b < blocks; ++b){
+
+			MomentAccumulator * block_accumulators = accumulators.data() + b * T;
+			unsigned int end = std::min(S,(b + 1) * block_size);
+
+			for (unsigned int s = b * block_size; s < end; ++s){
+
+				double sample_state[6];
+				double elements[6];
+				for (unsigned int k = 0; k < 6; ++k){
+					sample_state[k] = nominal_state(k) + perturbations(k,s);
+				}
+
+				if (cartesian){
+					BatchConversions::cart_to_kep_kernel(sample_state,mu,0,elements);
+				}
+				else{
+					std::copy(sample_state,sample_state + 6,elements);
+				}
+
+				PreparedKepState sample(elements,mu);
+				bool warm_start = sample.is_elliptic() == nominal.is_elliptic();
+
+				for (unsigned int j = 0; j < T; ++j){
+					double state[6];
+					if (warm_start){
+						sample.get_position_velocity(times(j),nominal_anomalies[j],state,state + 3);
+					}
+					else{
+						sample.get_position_velocity(times(j),state,state + 3);
+					}
+					block_accumulators[j].add(state);
+				}
+
+			}
+
+		}
+
+		std::vector<DispersionStatistics> statistics(T);
+
+		for (unsigned int j = 0; j < T; ++j){
+
+			MomentAccumulator total;
+			for (unsigned int b = 0; b < blocks; ++b){
+				total.merge(accumulators[b * T + j]);
+			}
+
+			statistics[j].t = times(j);
+			statistics[j].samples = S;
+			statistics[j].mean = arma::vec(total.mean,6);
+			statistics[j].covariance = arma::zeros<arma::mat>(6,6);
+
+			if (S > 1){
+				unsigned int c = 0;
+				for (unsigned int col = 0; col < 6; ++col){
+					for (unsigned int row = 0; row <= col; ++row, ++c){
+						statistics[j].covariance(row,col) = total.M2[c] / (S - 1);
+						statistics[j].covariance(col,row) = statistics[j].covariance(row,col);
+					}
+				}
+			}
+
+		}
+
+		return statistics;
+
+	}
+
+	void Dispersion::MomentAccumulator::add(const double * x){
+
+		this -> count += 1;
+
+		double delta[6];
+		for (unsigned int k = 0; k < 6; ++k){
+			delta[k] = x[k] - this -> mean[k];
+			this -> mean[k] += delta[k] / this -> count;
+		}
+
+		unsigned int c = 0;
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row <= col; ++row, ++c){
+				this -> M2[c] += delta[row] * (x[col] - this -> mean[col]);
+			}
+		}
+
+	}
+
+	void Dispersion::MomentAccumulator::merge(const MomentAccumulator & other){
+
+		if (other.count == 0){
+			return;
+		}
+
+		// Pairwise combination of Chan et al.
+		double count = this -> count + other.count;
+		double delta[6];
+		for (unsigned int k = 0; k < 6; ++k){
+			delta[k] = other.mean[k] - this -> mean[k];
+			this -> mean[k] += delta[k] * other.count / count;
+		}
+
+		double factor = this -> count * other.count / count;
+		unsigned int c = 0;
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row <= col; ++row, ++c){
+				this -> M2[c] += other.M2[c] + delta[row] * delta[col] * factor;
+			}
+		}
+
+		this -> count = count;
+
+	}
+
+}
@@ -0,0 +1,401 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/Eclipse.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+#include <algorithm>
+
+namespace OC{
+
+	std::vector<EclipseInterval> Eclipse::find_eclipses(const std::vector<KepState> & catalog,
+		const ShadowGeometry & geometry,
+		double t0,double t1,
+		unsigned int samples){
+
+		std::vector<std::vector<EclipseInterval> > intervals_per_object(catalog.size());
+
+		#pragma omp parallel for schedule(dynamic,256)
+		for (unsigned int i = 0; i < catalog.size(); ++i){
+			arma::vec kep = catalog[i].get_state();
+			Eclipse::add_eclipses(kep.memptr(),catalog[i].get_mu(),geometry,t0,t1,i,samples,intervals_per_object[i]);
+		}
+
+		return Eclipse::merge_intervals(intervals_per_object);
+
+	}
+
+	std::vector<EclipseInterval> Eclipse::find_eclipses(const KepCatalog & catalog,
+		const ShadowGeometry & geometry,
+		double t0,double t1,
+		unsigned int samples){
+
+		std::vector<std::vector<EclipseInterval> > intervals_per_object(catalog.get_size());
+
+		#pragma omp parallel for schedule(dynamic,256)
+		for (unsigned int i = 0; i < catalog.get_size(); ++i){
+			double kep[6];
+			catalog.get_state(i,kep);
+			Eclipse::add_eclipses(kep,catalog.get_mu(),geometry,t0,t1,i,samples,intervals_per_object[i]);
+		}
+
+		return Eclipse::merge_intervals(intervals_per_object);
+
+	}
+
+	std::vector<EclipseInterval> Eclipse::merge_intervals(const std::vector<std::vector<EclipseInterval> > & intervals_per_object){
+
+		std::vector<EclipseInterval> eclipse_table;
+		for (unsigned int i = 0; i < intervals_per_object.size(); ++i){
+			eclipse_table.insert(eclipse_table.end(),intervals_per_object[i].begin(),intervals_per_object[i].end());
+		}
+
+		std::sort(eclipse_table.begin(),eclipse_table.end(),
+			[](const EclipseInterval & lhs,const EclipseInterval & rhs){
+				if (lhs.t_entry != rhs.t_entry){
+					return lhs.t_entry < rhs.t_entry;
+				}
+				if (lhs.object != rhs.object){
+					return lhs.object < rhs.object;
+				}
+				return lhs.type < rhs.type;
+			});
+
+		return eclipse_table;
+
+	}
+
+	void Eclipse::add_eclipses(const double * kep,double mu,
+		const ShadowGeometry & geometry,
+		double t0,double t1,
+		unsigned int object,
+		unsigned int samples,
+		std::vector<EclipseInterval> & intervals){
+
+		double a = kep[0];
+		double e = kep[1];
+		double M0 = kep[5];
+		double n = std::sqrt(mu / std::pow(std::abs(a),3));
+
+		// Sun direction in the perifocal frame. Only its in-plane components matter
+		double P[3];
+		double Q[3];
+		BatchConversions::get_perifocal_basis(kep,P,Q);
+		double alpha = P[0] * geometry.sun_direction(0) + P[1] * geometry.sun_direction(1) + P[2] * geometry.sun_direction(2);
+		double beta = Q[0] * geometry.sun_direction(0) + Q[1] * geometry.sun_direction(1) + Q[2] * geometry.sun_direction(2);
+
+		double cones[2][2];
+		Eclipse::get_shadow_cones(geometry,cones[0],cones[1]);
+		ShadowType types[2] = {UMBRA,PENUMBRA};
+		unsigned int n_types = geometry.model == CONICAL ? 2 : 1;
+
+		std::vector<std::pair<double,double> > arcs;
+
+		EclipseInterval interval;
+		interval.object = object;
+
+		for (unsigned int c = 0; c < n_types; ++c){
+
+			interval.type = types[c];
+
+			if (e < 1){
+
+				Eclipse::find_shadow_arcs(a,e,alpha,beta,cones[c],0,2 * arma::datum::pi,true,samples,arcs);
+
+				double period = 2 * arma::datum::pi / n;
+
+				for (unsigned int k = 0; k < arcs.size(); ++k){
+
+					double t_entry_first = (State::M_from_ecc(arcs[k].first,e) - M0) / n;
+					double duration = (State::M_from_ecc(arcs[k].second,e) - State::M_from_ecc(arcs[k].first,e)) / n;
+
+					// Shadowed over the whole revolution
+					if (duration >= period){
+						interval.t_entry = t0;
+						interval.t_exit = t1;
+						intervals.push_back(interval);
+						continue;
+					}
+
+					for (double r = std::ceil((t0 - t_entry_first - duration) / period); t_entry_first + r * period <= t1; ++r){
+						interval.t_entry = std::max(t0,t_entry_first + r * period);
+						interval.t_exit = std::min(t1,t_entry_first + r * period + duration);
+						intervals.push_back(interval);
+					}
+
+				}
+
+			}
+			else{
+
+				double H_start = State::H_from_M(M0 + n * t0,e);
+				double H_end = State::H_from_M(M0 + n * t1,e);
+
+				Eclipse::find_shadow_arcs(a,e,alpha,beta,cones[c],H_start,H_end,false,samples,arcs);
+
+				for (unsigned int k = 0; k < arcs.size(); ++k){
+					interval.t_entry = std::max(t0,(State::M_from_H(arcs[k].first,e) - M0) / n);
+					interval.t_exit = std::min(t1,(State::M_from_H(arcs[k].second,e) - M0) / n);
+					intervals.push_back(interval);
+				}
+
+			}
+
+		}
+
+	}
+
+	ShadowType Eclipse::get_shadow(const double * position,const ShadowGeometry & geometry){
+
+		double umbra[2];
+		double penumbra[2];
+		Eclipse::get_shadow_cones(geometry,umbra,penumbra);
+
+		double xi = - (position[0] * geometry.sun_direction(0) + position[1] * geometry.sun_direction(1) + position[2] * geometry.sun_direction(2));
+
+		if (xi <= 0){
+			return SUNLIT;
+		}
+
+		double rho = 0;
+		for (unsigned int k = 0; k < 3; ++k){
+			rho += std::pow(position[k] + xi * geometry.sun_direction(k),2);
+		}
+		rho = std::sqrt(rho);
+
+		if (rho < umbra[0] + umbra[1] * xi){
+			return UMBRA;
+		}
+		if (geometry.model == CONICAL && rho < penumbra[0] + penumbra[1] * xi){
+			return PENUMBRA;
+		}
+		return SUNLIT;
+
+	}
+
+	void Eclipse::get_shadow_cones(const ShadowGeometry & geometry,double * umbra,double * penumbra){
+
+		if (geometry.model == CYLINDRICAL){
+			umbra[0] = geometry.body_radius;
+			umbra[1] = 0;
+			penumbra[0] = geometry.body_radius;
+			penumbra[1] = 0;
+			return;
+		}
+
+		// Half-angles of the cones tangent to both the Sun and the central body
+		double sin_umbra = (geometry.sun_radius - geometry.body_radius) / geometry.sun_distance;
+		double sin_penumbra = (geometry.sun_radius + geometry.body_radius) / geometry.sun_distance;
+		double cos_umbra = std::sqrt(1 - sin_umbra * sin_umbra);
+		double cos_penumbra = std::sqrt(1 - sin_penumbra * sin_penumbra);
+
+		// The umbra narrows and the penumbra widens behind the central body
+		umbra[0] = geometry.body_radius / cos_umbra;
+		umbra[1] = - sin_umbra / cos_umbra;
+		penumbra[0] = geometry.body_radius / cos_penumbra;
+		penumbra[1] = sin_penumbra / cos_penumbra;
+
+	}
+
+	double Eclipse::shadow_function(double x,double y,double alpha,double beta,const double * cone){
+
+		double r2 = x * x + y * y;
+
+		// Distance behind the central body along the anti-Sun axis
+		double xi = - (x * alpha + y * beta);
+
+		// On the day side the function is continued by its value at xi = 0, 
+		// which is positive for orbits that do not intersect the central body
+		if (xi <= 0){
+			return std::sqrt(r2) - cone[0];
+		}
+
+		double rho = std::sqrt(std::max(r2 - xi * xi,0.));
+
+		return rho - (cone[0] + cone[1] * xi);
+
+	}
+
+	void Eclipse::find_shadow_arcs(double a,double e,
+		double alpha,double beta,
+		const double * cone,
+		double anomaly_start,double anomaly_end,
+		bool periodic,
+		unsigned int samples,
+		std::vector<std::pair<double,double> > & arcs){
+
+		arcs.clear();
+
+		double b_factor = std::sqrt(std::abs(1 - e * e));
+
+		auto h = [&](double anomaly){
+			double x,y;
+			if (e < 1){
+				x = a * (std::cos(anomaly) - e);
+				y = a * b_factor * std::sin(anomaly);
+			}
+			else{
+				x = a * (std::cosh(anomaly) - e);
+				y = - a * b_factor * std::sinh(anomaly);
+			}
+			return Eclipse::shadow_function(x,y,alpha,beta,cone);
+		};
+
+		// Illinois variant of the regula falsi, bracketing the sign change of h over [lo,hi]
+		auto refine = [&](double lo,double hi,double h_lo,double h_hi){
+			int side = 0;
+			double anomaly = lo;
+			for (unsigned int i = 0; i < 100; ++i){
+				anomaly = (lo * h_hi - hi * h_lo) / (h_hi - h_lo);
+				if (hi - lo < 1e-13 * (1 + std::abs(anomaly))){
+					break;
+				}
+				double h_anomaly = h(anomaly);
+				if (h_anomaly == 0){
+					break;
+				}
+				if ((h_anomaly < 0) == (h_hi < 0)){
+					hi = anomaly;
+					h_hi = h_anomaly;
+					if (side == -1){
+						h_lo /= 2;
+					}
+					side = -1;
+				}
+				else{
+					lo = anomaly;
+					h_lo = h_anomaly;
+					if (side == 1){
+						h_hi /= 2;
+					}
+					side = 1;
+				}
+			}
+			return anomaly;
+		};
+
+		double step = (anomaly_end - anomaly_start) / samples;
+		double h_start = h(anomaly_start);
+
+		// Samples of (anomaly, h). For periodic ranges the last sample closes the revolution
+		std::vector<std::pair<double,double> > points(samples + 1);
+		for (unsigned int j = 0; j <= samples; ++j){
+			points[j].first = anomaly_start + j * step;
+			points[j].second = (j == 0 || (periodic && j == samples)) ? h_start : h(points[j].first);
+		}
+
+		// Grazing passages can dip into the shadow between two samples without changing the sign 
+		// of the sampled function. The sampled local minima are refined by golden-section search 
+		// and any shadowed point found is added to the samples
+		const double ratio = (std::sqrt(5.) - 1) / 2;
+		for (unsigned int j = periodic ? 0 : 1; j < samples; ++j){
+
+			double h_prev = points[j == 0 ? samples - 1 : j - 1].second;
+			double h_next = points[j + 1].second;
+			if (points[j].second <= 0 || points[j].second > h_prev || points[j].second > h_next){
+				continue;
+			}
+
+			double lo = points[j].first - step;
+			double hi = points[j].first + step;
+			double x1 = hi - ratio * (hi - lo);
+			double x2 = lo + ratio * (hi - lo);
+			double h1 = h(x1);
+			double h2 = h(x2);
+			for (unsigned int i = 0; i < 100 && h1 >= 0 && h2 >= 0 && hi - lo > 1e-12 * (1 + std::abs(lo)); ++i){
+				if (h1 < h2){
+					hi = x2;
+					x2 = x1;
+					h2 = h1;
+					x1 = hi - ratio * (hi - lo);
+					h1 = h(x1);
+				}
+				else{
+					lo = x1;
+					x1 = x2;
+					h1 = h2;
+					x2 = lo + ratio * (hi - lo);
+					h2 = h(x2);
+				}
+			}
+
+			if (std::min(h1,h2) < 0){
+				double anomaly = h1 < h2 ? x1 : x2;
+				if (anomaly < anomaly_start){
+					anomaly += anomaly_end - anomaly_start;
+				}
+				points.push_back(std::make_pair(anomaly,std::min(h1,h2)));
+			}
+
+		}
+		std::sort(points.begin(),points.end());
+
+		// Sign changes of h between consecutive samples, flagged true when entering the shadow
+		std::vector<std::pair<double,bool> > crossings;
+		for (unsigned int j = 1; j < points.size(); ++j){
+			if ((points[j - 1].second < 0) != (points[j].second < 0)){
+				crossings.push_back(std::make_pair(
+					refine(points[j - 1].first,points[j].first,points[j - 1].second,points[j].second),
+					points[j - 1].second >= 0));
+			}
+		}
+
+		if (!periodic){
+
+			double entry = anomaly_start;
+			bool inside = h_start < 0;
+			for (unsigned int k = 0; k < crossings.size(); ++k){
+				if (crossings[k].second){
+					entry = crossings[k].first;
+				}
+				else{
+					arcs.push_back(std::make_pair(entry,crossings[k].first));
+				}
+				inside = crossings[k].second;
+			}
+			if (inside){
+				arcs.push_back(std::make_pair(entry,anomaly_end));
+			}
+			return;
+
+		}
+
+		if (crossings.empty()){
+			if (h_start < 0){
+				arcs.push_back(std::make_pair(anomaly_start,anomaly_end));
+			}
+			return;
+		}
+
+		// Crossings alternate, so arcs are formed by starting from the first entry and wrapping around
+		unsigned int first_entry = crossings[0].second ? 0 : 1;
+		for (unsigned int k = first_entry; k + 1 < crossings.size() + first_entry; k += 2){
+			double entry = crossings[k].first;
+			double exit = crossings[(k + 1) % crossings.size()].first;
+			if (exit < entry){
+				exit += anomaly_end - anomaly_start;
+			}
+			arcs.push_back(std::make_pair(entry,exit));
+		}
+
+	}
+
+}
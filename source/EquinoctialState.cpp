@@ -0,0 +1,211 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/EquinoctialState.hpp"
+
+namespace OC{
+
+	EquinoctialState::EquinoctialState( arma::vec state,double mu) : State(state,mu){
+	}
+
+	EquinoctialState::EquinoctialState() : State(arma::zeros<arma::vec>(6),1){
+	}
+
+	double EquinoctialState::get_energy() const{
+		return - this -> mu / (2 * this -> get_a());
+	}
+
+	double EquinoctialState::get_momentum() const{
+		return std::sqrt(this -> mu * this -> get_p());
+	}
+
+	double EquinoctialState::get_a() const{
+		return this -> get_p() / (1 - std::pow(this -> get_f(),2) - std::pow(this -> get_g(),2));
+	}
+
+	double EquinoctialState::get_eccentricity() const{
+		return std::sqrt(std::pow(this -> get_f(),2) + std::pow(this -> get_g(),2));
+	}
+
+	double EquinoctialState::get_p() const{
+		return this -> state(0);
+	}
+
+	double EquinoctialState::get_f() const{
+		return this -> state(1);
+	}
+
+	double EquinoctialState::get_g() const{
+		return this -> state(2);
+	}	
+
+	double EquinoctialState::get_h() const{
+		return this -> state(3);
+	}
+
+	double EquinoctialState::get_k() const{
+		return this -> state(4);
+	}
+
+	double EquinoctialState::get_L0() const{
+		return this -> state(5);
+	}
+
+	CartState EquinoctialState::convert_to_cart(double delta_T) const{
+
+		arma::vec cartesian_state(6);
+		EquinoctialState::to_cart_kernel(this -> state.memptr(),this -> mu,delta_T,cartesian_state.memptr());
+		return CartState(cartesian_state,this -> mu);
+
+	}
+
+	double EquinoctialState::propagate_true_longitude(const double * elements,double mu,double delta_T){
+
+		double p = elements[0];
+		double f = elements[1];
+		double g = elements[2];
+		double L = elements[5];
+
+		if (delta_T == 0){
+			return L;
+		}
+
+		double e2 = f * f + g * g;
+		double a = p / (1 - e2);
+		double n = std::sqrt(mu / std::pow(std::abs(a),3));
+
+		if (e2 < 1){
+
+			double eta = std::sqrt(1 - e2);
+
+			// True longitude -> eccentric longitude -> mean longitude
+			double cos_L = std::cos(L);
+			double sin_L = std::sin(L);
+			double F = L + 2 * std::atan((g * cos_L - f * sin_L) / (1 + eta + f * cos_L + g * sin_L));
+			double lambda = F - f * std::sin(F) + g * std::cos(F) + n * delta_T;
+
+			// Equinoctial Kepler equation, solved for F with Newton iterations. 
+			// The offset of lambda from F is bounded by e, which the initial guess uses
+			double lambda_wrapped = std::remainder(lambda,2 * arma::datum::pi);
+			double offset = lambda - lambda_wrapped;
+			double cos_lambda = std::cos(lambda_wrapped);
+			double sin_lambda = std::sin(lambda_wrapped);
+			F = lambda_wrapped + 0.85 * std::sqrt(e2) * (f * sin_lambda - g * cos_lambda >= 0 ? 1 : -1);
+
+			for (unsigned int i = 0; i < 50; ++i){
+				double cos_F = std::cos(F);
+				double sin_F = std::sin(F);
+				double residual = F - f * sin_F + g * cos_F - lambda_wrapped;
+				double dF = residual / (1 - f * cos_F - g * sin_F);
+				F -= dF;
+				if (std::abs(dF) < 1e-14){
+					break;
+				}
+			}
+
+			// Eccentric longitude -> true longitude
+			double cos_F = std::cos(F);
+			double sin_F = std::sin(F);
+			return offset + F + 2 * std::atan((f * sin_F - g * cos_F) / (1 + eta - f * cos_F - g * sin_F));
+
+		}
+		else{
+
+			double e = std::sqrt(e2);
+			double varpi = std::atan2(g,f);
+			double M = State::M_from_f(std::remainder(L - varpi,2 * arma::datum::pi),e) + n * delta_T;
+			return varpi + State::f_from_M(M,e);
+
+		}
+
+	}
+
+	void EquinoctialState::to_cart_kernel(const double * elements,double mu,double delta_T,double * cart){
+
+		double p = elements[0];
+		double f = elements[1];
+		double g = elements[2];
+		double h = elements[3];
+		double k = elements[4];
+		double L = EquinoctialState::propagate_true_longitude(elements,mu,delta_T);
+
+		double cos_L = std::cos(L);
+		double sin_L = std::sin(L);
+
+		double alpha2 = h * h - k * k;
+		double s2 = 1 + h * h + k * k;
+		double hk = h * k;
+		double r = p / (1 + f * cos_L + g * sin_L);
+		double r_s2 = r / s2;
+		double v_s2 = - std::sqrt(mu / p) / s2;
+
+		cart[0] = r_s2 * (cos_L + alpha2 * cos_L + 2 * hk * sin_L);
+		cart[1] = r_s2 * (sin_L - alpha2 * sin_L + 2 * hk * cos_L);
+		cart[2] = 2 * r_s2 * (h * sin_L - k * cos_L);
+
+		cart[3] = v_s2 * (sin_L + alpha2 * sin_L - 2 * hk * cos_L + g - 2 * f * hk + alpha2 * g);
+		cart[4] = v_s2 * (- cos_L + alpha2 * cos_L + 2 * hk * sin_L - f + 2 * g * hk + alpha2 * f);
+		cart[5] = - 2 * v_s2 * (h * cos_L + k * sin_L + f * h + g * k);
+
+	}
+
+	void EquinoctialState::from_cart_kernel(const double * cart,double mu,double delta_T,double * elements){
+
+		const double * r = cart;
+		const double * v = cart + 3;
+
+		double h_vec[3] = {r[1] * v[2] - r[2] * v[1],
+			r[2] * v[0] - r[0] * v[2],
+			r[0] * v[1] - r[1] * v[0]};
+
+		double h_norm = std::sqrt(h_vec[0] * h_vec[0] + h_vec[1] * h_vec[1] + h_vec[2] * h_vec[2]);
+		double r_norm = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+
+		double p = h_norm * h_norm / mu;
+		double h = - h_vec[1] / (h_norm + h_vec[2]);
+		double k = h_vec[0] / (h_norm + h_vec[2]);
+
+		// Equinoctial frame
+		double s2 = 1 + h * h + k * k;
+		double f_hat[3] = {(1 - k * k + h * h) / s2,2 * k * h / s2,- 2 * k / s2};
+		double g_hat[3] = {2 * k * h / s2,(1 + k * k - h * h) / s2,2 * h / s2};
+
+		// Eccentricity vector
+		double e_vec[3];
+		e_vec[0] = (v[1] * h_vec[2] - v[2] * h_vec[1]) / mu - r[0] / r_norm;
+		e_vec[1] = (v[2] * h_vec[0] - v[0] * h_vec[2]) / mu - r[1] / r_norm;
+		e_vec[2] = (v[0] * h_vec[1] - v[1] * h_vec[0]) / mu - r[2] / r_norm;
+
+		elements[0] = p;
+		elements[1] = e_vec[0] * f_hat[0] + e_vec[1] * f_hat[1] + e_vec[2] * f_hat[2];
+		elements[2] = e_vec[0] * g_hat[0] + e_vec[1] * g_hat[1] + e_vec[2] * g_hat[2];
+		elements[3] = h;
+		elements[4] = k;
+		elements[5] = std::atan2(r[0] * g_hat[0] + r[1] * g_hat[1] + r[2] * g_hat[2],
+			r[0] * f_hat[0] + r[1] * f_hat[1] + r[2] * f_hat[2]);
+
+		// True longitude at epoch
+		elements[5] = EquinoctialState::propagate_true_longitude(elements,mu,- delta_T);
+
+	}
+
+}
@@ -0,0 +1,140 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/EventFinder.hpp"
+#include <algorithm>
+
+namespace OC{
+
+	std::vector<OrbitEvent> EventFinder::find_events(const std::vector<KepState> & catalog,
+		double t0,double t1,
+		const std::vector<double> & true_anomaly_targets,
+		unsigned int event_types,
+		double node_inclination_tolerance){
+
+		std::vector<std::vector<OrbitEvent> > events_per_object(catalog.size());
+
+		#pragma omp parallel for schedule(dynamic,256)
+		for (unsigned int i = 0; i < catalog.size(); ++i){
+
+			const KepState & kep = catalog[i];
+			std::vector<OrbitEvent> & events = events_per_object[i];
+
+			if (event_types & PERIAPSIS){
+				EventFinder::add_true_anomaly_crossings(kep,0,t0,t1,i,PERIAPSIS,0,events);
+			}
+
+			if ((event_types & APOAPSIS) && kep.get_eccentricity() < 1){
+				EventFinder::add_true_anomaly_crossings(kep,arma::datum::pi,t0,t1,i,APOAPSIS,0,events);
+			}
+
+			// The argument of latitude omega + f is 0 at the ascending node and pi at the descending node.
+			// The nodes of equatorial orbits are undefined, so none are reported
+			bool has_nodes = std::abs(std::sin(kep.get_inclination())) >= node_inclination_tolerance;
+
+			if ((event_types & ASCENDING_NODE) && has_nodes){
+				EventFinder::add_true_anomaly_crossings(kep,- kep.get_omega(),t0,t1,i,ASCENDING_NODE,0,events);
+			}
+
+			if ((event_types & DESCENDING_NODE) && has_nodes){
+				EventFinder::add_true_anomaly_crossings(kep,arma::datum::pi - kep.get_omega(),t0,t1,i,DESCENDING_NODE,0,events);
+			}
+
+			if (event_types & TRUE_ANOMALY){
+				for (unsigned int k = 0; k < true_anomaly_targets.size(); ++k){
+					EventFinder::add_true_anomaly_crossings(kep,true_anomaly_targets[k],t0,t1,i,TRUE_ANOMALY,k,events);
+				}
+			}
+
+		}
+
+		std::vector<OrbitEvent> event_table;
+		for (unsigned int i = 0; i < events_per_object.size(); ++i){
+			event_table.insert(event_table.end(),events_per_object[i].begin(),events_per_object[i].end());
+		}
+
+		std::sort(event_table.begin(),event_table.end(),
+			[](const OrbitEvent & lhs,const OrbitEvent & rhs){
+				if (lhs.t != rhs.t){
+					return lhs.t < rhs.t;
+				}
+				if (lhs.object != rhs.object){
+					return lhs.object < rhs.object;
+				}
+				if (lhs.type != rhs.type){
+					return lhs.type < rhs.type;
+				}
+				return lhs.target < rhs.target;
+			});
+
+		return event_table;
+
+	}
+
+	void EventFinder::add_true_anomaly_crossings(const KepState & kep,
+		double f,
+		double t0,double t1,
+		unsigned int object,
+		EventType type,
+		unsigned int target,
+		std::vector<OrbitEvent> & events){
+
+		double e = kep.get_eccentricity();
+		double n = kep.get_n();
+
+		// True anomaly brought back to [-pi,pi)
+		f = std::remainder(f,2 * arma::datum::pi);
+
+		OrbitEvent event;
+		event.object = object;
+		event.type = type;
+		event.target = target;
+
+		if (e < 1){
+
+			double period = 2 * arma::datum::pi / n;
+			double t_first = (State::M_from_f(f,e) - kep.get_M0()) / n;
+
+			for (double k = std::ceil((t0 - t_first) / period); t_first + k * period <= t1; ++k){
+				event.t = t_first + k * period;
+				events.push_back(event);
+			}
+
+		}
+		else{
+
+			// Only the true anomalies between the asymptotes are ever reached
+			if (std::abs(f) >= std::acos(- 1. / e)){
+				return;
+			}
+
+			event.t = (State::M_from_f(f,e) - kep.get_M0()) / n;
+
+			if (event.t >= t0 && event.t <= t1){
+				events.push_back(event);
+			}
+
+		}
+
+	}
+
+}
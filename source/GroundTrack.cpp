@@ -0,0 +1,324 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/GroundTrack.hpp"
+
+namespace OC{
+
+	void GroundTrack::compute_ground_track(const arma::mat & trajectory,
+		const arma::vec & times,
+		const EarthModel & earth_model,
+		arma::mat & ecef_positions,
+		arma::mat & lla){
+
+		unsigned int K = trajectory.n_cols;
+		ecef_positions.set_size(3,K);
+		lla.set_size(3,K);
+
+		for (unsigned int k = 0; k < K; ++k){
+			GroundTrack::inertial_to_ecef(trajectory.colptr(k),times(k),earth_model,ecef_positions.colptr(k));
+			GroundTrack::ecef_to_lla(ecef_positions.colptr(k),earth_model,lla.colptr(k));
+		}
+
+	}
+
+	void GroundTrack::compute_ground_tracks(const std::vector<arma::mat> & trajectories,
+		const arma::vec & times,
+		const EarthModel & earth_model,
+		std::vector<arma::mat> & lla){
+
+		lla.resize(trajectories.size());
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < trajectories.size(); ++i){
+			arma::mat ecef_positions;
+			GroundTrack::compute_ground_track(trajectories[i],times,earth_model,ecef_positions,lla[i]);
+		}
+
+	}
+
+	void GroundTrack::compute_azimuth_elevation(const arma::mat & trajectory,
+		const arma::vec & times,
+		const GroundStation & station,
+		const EarthModel & earth_model,
+		arma::mat & azimuth_elevation){
+
+		unsigned int K = trajectory.n_cols;
+		azimuth_elevation.set_size(2,K);
+
+		arma::vec::fixed<3> station_ecef = GroundTrack::get_ecef_position(station.latitude,station.longitude,station.altitude,earth_model);
+
+		double sin_lat = std::sin(station.latitude);
+		double cos_lat = std::cos(station.latitude);
+		double sin_lon = std::sin(station.longitude);
+		double cos_lon = std::cos(station.longitude);
+
+		// Local east/north/up directions
+		double east[3] = {- sin_lon,cos_lon,0};
+		double north[3] = {- sin_lat * cos_lon,- sin_lat * sin_lon,cos_lat};
+		double up[3] = {cos_lat * cos_lon,cos_lat * sin_lon,sin_lat};
+
+		for (unsigned int k = 0; k < K; ++k){
+
+			double r_ecef[3];
+			GroundTrack::inertial_to_ecef(trajectory.colptr(k),times(k),earth_model,r_ecef);
+
+			double rho[3] = {r_ecef[0] - station_ecef(0),r_ecef[1] - station_ecef(1),r_ecef[2] - station_ecef(2)};
+			double rho_e = rho[0] * east[0] + rho[1] * east[1] + rho[2] * east[2];
+			double rho_n = rho[0] * north[0] + rho[1] * north[1] + rho[2] * north[2];
+			double rho_u = rho[0] * up[0] + rho[1] * up[1] + rho[2] * up[2];
+
+			azimuth_elevation(0,k) = std::atan2(rho_e,rho_n);
+			azimuth_elevation(1,k) = std::atan2(rho_u,std::sqrt(rho_e * rho_e + rho_n * rho_n));
+		}
+
+	}
+
+	void GroundTrack::compute_visibility(const std::vector<arma::mat> & trajectories,
+		const arma::vec & times,
+		const std::vector<GroundStation> & stations,
+		const EarthModel & earth_model,
+		const std::function<void(const std::vector<VisibilityWindow> &)> & callback,
+		unsigned int chunk_size){
+
+		chunk_size = std::max(1u,chunk_size);
+
+		for (unsigned int chunk_start = 0; chunk_start < trajectories.size(); chunk_start += chunk_size){
+
+			unsigned int chunk_end = std::min((unsigned int)(trajectories.size()),chunk_start + chunk_size);
+			std::vector<std::vector<VisibilityWindow> > windows_per_object(chunk_end - chunk_start);
+
+			#pragma omp parallel for schedule(dynamic)
+			for (unsigned int i = chunk_start; i < chunk_end; ++i){
+				GroundTrack::compute_object_visibility(trajectories[i],times,stations,earth_model,i,windows_per_object[i - chunk_start]);
+			}
+
+			std::vector<VisibilityWindow> windows;
+			for (unsigned int i = 0; i < windows_per_object.size(); ++i){
+				windows.insert(windows.end(),windows_per_object[i].begin(),windows_per_object[i].end());
+			}
+
+			callback(windows);
+		}
+
+	}
+
+	std::vector<VisibilityWindow> GroundTrack::compute_visibility(const std::vector<arma::mat> & trajectories,
+		const arma::vec & times,
+		const std::vector<GroundStation> & stations,
+		const EarthModel & earth_model){
+
+		std::vector<VisibilityWindow> all_windows;
+
+		GroundTrack::compute_visibility(trajectories,times,stations,earth_model,
+			[&all_windows](const std::vector<VisibilityWindow> & windows){
+				all_windows.insert(all_windows.end(),windows.begin(),windows.end());
+			});
+
+		return all_windows;
+
+	}
+
+	arma::vec::fixed<3> GroundTrack::get_ecef_position(double latitude,double longitude,double altitude,const EarthModel & earth_model){
+
+		double e2 = earth_model.flattening * (2 - earth_model.flattening);
+		double sin_lat = std::sin(latitude);
+		double N = earth_model.equatorial_radius / std::sqrt(1 - e2 * sin_lat * sin_lat);
+
+		arma::vec::fixed<3> r_ecef = {(N + altitude) * std::cos(latitude) * std::cos(longitude),
+			(N + altitude) * std::cos(latitude) * std::sin(longitude),
+			(N * (1 - e2) + altitude) * sin_lat};
+
+		return r_ecef;
+
+	}
+
+	inline void GroundTrack::inertial_to_ecef(const double * r,double t,const EarthModel & earth_model,double * r_ecef){
+
+		double theta = earth_model.theta_0 + earth_model.omega * t;
+		double cos_theta = std::cos(theta);
+		double sin_theta = std::sin(theta);
+
+		r_ecef[0] = cos_theta * r[0] + sin_theta * r[1];
+		r_ecef[1] = - sin_theta * r[0] + cos_theta * r[1];
+		r_ecef[2] = r[2];
+
+	}
+
+	inline void GroundTrack::ecef_to_lla(const double * r_ecef,const EarthModel & earth_model,double * lla){
+
+		double a = earth_model.equatorial_radius;
+		double e2 = earth_model.flattening * (2 - earth_model.flattening);
+		double p = std::sqrt(r_ecef[0] * r_ecef[0] + r_ecef[1] * r_ecef[1]);
+
+		// Fixed-point iterations on the geodetic latitude, which converge to machine precision in a few steps away from the center
+		double latitude = std::atan2(r_ecef[2],p * (1 - e2));
+		double altitude = 0;
+
+		for (unsigned int i = 0; i < 5; ++i){
+			double sin_lat = std::sin(latitude);
+			double N = a / std::sqrt(1 - e2 * sin_lat * sin_lat);
+			altitude = p * std::cos(latitude) + r_ecef[2] * sin_lat - a * std::sqrt(1 - e2 * sin_lat * sin_lat);
+			latitude = std::atan2(r_ecef[2],p * (1 - e2 * N / (N + altitude)));
+		}
+
+		double sin_lat = std::sin(latitude);
+		lla[0] = latitude;
+		lla[1] = std::atan2(r_ecef[1],r_ecef[0]);
+		lla[2] = p * std::cos(latitude) + r_ecef[2] * sin_lat - a * std::sqrt(1 - e2 * sin_lat * sin_lat);
+
+	}
+
+	inline double GroundTrack::get_sin_elevation(const double * r_ecef,const double * station_ecef,const double * up){
+
+		double rho[3] = {r_ecef[0] - station_ecef[0],r_ecef[1] - station_ecef[1],r_ecef[2] - station_ecef[2]};
+		return (rho[0] * up[0] + rho[1] * up[1] + rho[2] * up[2]) / std::sqrt(rho[0] * rho[0] + rho[1] * rho[1] + rho[2] * rho[2]);
+
+	}
+
+	inline void GroundTrack::interpolate_position(const double * state_0,const double * state_1,double t_0,double t_1,double t,double * r){
+
+		double h = t_1 - t_0;
+		double s = (t - t_0) / h;
+		double s2 = s * s;
+		double s3 = s2 * s;
+
+		double h00 = 2 * s3 - 3 * s2 + 1;
+		double h10 = s3 - 2 * s2 + s;
+		double h01 = - 2 * s3 + 3 * s2;
+		double h11 = s3 - s2;
+
+		for (int k = 0; k < 3; ++k){
+			r[k] = h00 * state_0[k] + h10 * h * state_0[k + 3] + h01 * state_1[k] + h11 * h * state_1[k + 3];
+		}
+
+	}
+
+	void GroundTrack::compute_object_visibility(const arma::mat & trajectory,
+		const arma::vec & times,
+		const std::vector<GroundStation> & stations,
+		const EarthModel & earth_model,
+		unsigned int object,
+		std::vector<VisibilityWindow> & windows){
+
+		unsigned int K = trajectory.n_cols;
+		if (K == 0){
+			return;
+		}
+
+		arma::mat ecef_positions(3,K);
+		for (unsigned int k = 0; k < K; ++k){
+			GroundTrack::inertial_to_ecef(trajectory.colptr(k),times(k),earth_model,ecef_positions.colptr(k));
+		}
+
+		for (unsigned int s = 0; s < stations.size(); ++s){
+
+			const GroundStation & station = stations[s];
+			arma::vec::fixed<3> station_ecef = GroundTrack::get_ecef_position(station.latitude,station.longitude,station.altitude,earth_model);
+			double up[3] = {std::cos(station.latitude) * std::cos(station.longitude),
+				std::cos(station.latitude) * std::sin(station.longitude),
+				std::sin(station.latitude)};
+			double sin_min_elevation = std::sin(station.min_elevation);
+
+			// Visibility function, positive when the object is above the mask
+			auto visibility_function = [&](unsigned int k,double t){
+				double r[3],r_ecef[3];
+				GroundTrack::interpolate_position(trajectory.colptr(k),trajectory.colptr(k + 1),times(k),times(k + 1),t,r);
+				GroundTrack::inertial_to_ecef(r,t,earth_model,r_ecef);
+				return GroundTrack::get_sin_elevation(r_ecef,station_ecef.memptr(),up) - sin_min_elevation;
+			};
+
+			// Refines the crossing bracketed by samples k and k + 1 with the Illinois method
+			auto refine_crossing = [&](unsigned int k,double g_0,double g_1){
+				double t_low = times(k);
+				double t_up = times(k + 1);
+				double t = t_up;
+				int side = 0;
+				for (unsigned int i = 0; i < 100; ++i){
+					t = (t_low * g_1 - t_up * g_0) / (g_1 - g_0);
+					double g = visibility_function(k,t);
+					if (g == 0 || t_up - t_low < 1e-10 * (times(k + 1) - times(k))){
+						break;
+					}
+					if ((g > 0) == (g_0 > 0)){
+						t_low = t;
+						g_0 = g;
+						if (side == -1){
+							g_1 /= 2;
+						}
+						side = -1;
+					}
+					else{
+						t_up = t;
+						g_1 = g;
+						if (side == 1){
+							g_0 /= 2;
+						}
+						side = 1;
+					}
+					if (std::abs(g) < 1e-14){
+						break;
+					}
+				}
+				return t;
+			};
+
+			double g_previous = GroundTrack::get_sin_elevation(ecef_positions.colptr(0),station_ecef.memptr(),up) - sin_min_elevation;
+			bool visible = g_previous >= 0;
+
+			VisibilityWindow window;
+			window.object = object;
+			window.station = s;
+			window.rise = times(0);
+			window.max_elevation = std::asin(std::max(-1.,std::min(1.,g_previous + sin_min_elevation)));
+
+			for (unsigned int k = 0; k + 1 < K; ++k){
+
+				double g = GroundTrack::get_sin_elevation(ecef_positions.colptr(k + 1),station_ecef.memptr(),up) - sin_min_elevation;
+
+				if (!visible && g >= 0){
+					window.rise = refine_crossing(k,g_previous,g);
+					window.max_elevation = std::asin(std::max(-1.,std::min(1.,g + sin_min_elevation)));
+					visible = true;
+				}
+				else if (visible && g < 0){
+					window.set = refine_crossing(k,g_previous,g);
+					windows.push_back(window);
+					visible = false;
+				}
+				else if (visible){
+					window.max_elevation = std::max(window.max_elevation,std::asin(std::max(-1.,std::min(1.,g + sin_min_elevation))));
+				}
+
+				g_previous = g;
+			}
+
+			if (visible){
+				window.set = times(K - 1);
+				windows.push_back(window);
+			}
+
+		}
+
+	}
+
+}
@@ -0,0 +1,228 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/IncrementalCatalog.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace OC{
+
+	CatalogPartition::CatalogPartition(unsigned int N,unsigned int parts){
+
+		this -> members.resize(parts);
+		this -> part_of.assign(N,0);
+		this -> position.resize(N);
+
+		this -> members[0].resize(N);
+		for (unsigned int i = 0; i < N; ++i){
+			this -> members[0][i] = i;
+			this -> position[i] = i;
+		}
+
+	}
+
+	void CatalogPartition::assign(unsigned int i,unsigned int part){
+
+		unsigned int current = this -> part_of[i];
+		if (current == part){
+			return;
+		}
+
+		// Swap-remove from the current part
+		std::vector<unsigned int> & current_members = this -> members[current];
+		unsigned int last = current_members.back();
+		current_members[this -> position[i]] = last;
+		this -> position[last] = this -> position[i];
+		current_members.pop_back();
+
+		this -> position[i] = this -> members[part].size();
+		this -> members[part].push_back(i);
+		this -> part_of[i] = part;
+
+	}
+
+	unsigned int CatalogPartition::get_part(unsigned int i) const{
+		return this -> part_of[i];
+	}
+
+	const std::vector<unsigned int> & CatalogPartition::get_members(unsigned int part) const{
+		return this -> members[part];
+	}
+
+	unsigned int CatalogPartition::get_parts() const{
+		return this -> members.size();
+	}
+
+	IncrementalCatalog::IncrementalCatalog(const arma::mat & cart_states,double mu,const std::vector<double> & shell_radii) : 
+	cart_catalog(cart_states,mu),
+	kep_catalog(cart_states.n_cols,mu),
+	perigee_shells(cart_states.n_cols,shell_radii.size() + 1),
+	apogee_shells(cart_states.n_cols,shell_radii.size() + 1),
+	regimes(cart_states.n_cols,3){
+
+		unsigned int N = cart_states.n_cols;
+
+		this -> mu = mu;
+		this -> shell_radii = shell_radii;
+
+		this -> n.resize(N);
+		this -> parameter.resize(N);
+		this -> energy.resize(N);
+		this -> perigee_radius.resize(N);
+		this -> apogee_radius.resize(N);
+
+		this -> is_dirty.assign(N,1);
+		this -> dirty.resize(N);
+		for (unsigned int i = 0; i < N; ++i){
+			this -> dirty[i] = i;
+		}
+
+		this -> refresh();
+
+	}
+
+	void IncrementalCatalog::update(unsigned int i,const double * state){
+
+		this -> cart_catalog.set_state(i,state);
+
+		if (!this -> is_dirty[i]){
+			this -> is_dirty[i] = 1;
+			this -> dirty.push_back(i);
+		}
+
+	}
+
+	unsigned int IncrementalCatalog::refresh(){
+
+		unsigned int D = this -> dirty.size();
+		if (D == 0){
+			return 0;
+		}
+
+		// Gather the dirty states so that they go through the regime-dispatched batch conversion together
+		arma::mat cart_states(6,D);
+		#pragma omp parallel for
+		for (unsigned int d = 0; d < D; ++d){
+			this -> cart_catalog.get_state(this -> dirty[d],cart_states.colptr(d));
+		}
+
+		arma::mat kep_states;
+		BatchConversions::cart_to_kep(cart_states,this -> mu,0,kep_states);
+
+		#pragma omp parallel for
+		for (unsigned int d = 0; d < D; ++d){
+
+			unsigned int i = this -> dirty[d];
+			const double * kep = kep_states.colptr(d);
+			this -> kep_catalog.set_state(i,kep);
+
+			double a = kep[0];
+			double e = kep[1];
+
+			this -> n[i] = std::sqrt(this -> mu / std::pow(std::abs(a),3));
+			this -> parameter[i] = a * (1 - e * e);
+			this -> energy[i] = - this -> mu / (2 * a);
+			this -> perigee_radius[i] = a * (1 - e);
+			this -> apogee_radius[i] = e < 1 ? a * (1 + e) : std::numeric_limits<double>::infinity();
+
+		}
+
+		// The partitions are moved serially, each move costing O(1)
+		for (unsigned int d = 0; d < D; ++d){
+
+			unsigned int i = this -> dirty[d];
+
+			this -> perigee_shells.assign(i,this -> get_shell(this -> perigee_radius[i]));
+			this -> apogee_shells.assign(i,this -> get_shell(this -> apogee_radius[i]));
+			this -> regimes.assign(i,BatchConversions::get_regime(kep_states(1,d)));
+
+			this -> is_dirty[i] = 0;
+
+		}
+
+		this -> dirty.clear();
+
+		return D;
+
+	}
+
+	unsigned int IncrementalCatalog::get_dirty_count() const{
+		return this -> dirty.size();
+	}
+
+	unsigned int IncrementalCatalog::get_size() const{
+		return this -> cart_catalog.get_size();
+	}
+
+	const CartCatalog & IncrementalCatalog::get_cart_catalog() const{
+		return this -> cart_catalog;
+	}
+
+	const KepCatalog & IncrementalCatalog::get_kep_catalog() const{
+		return this -> kep_catalog;
+	}
+
+	double IncrementalCatalog::get_a(unsigned int i) const{
+		return this -> kep_catalog.get(i,0);
+	}
+
+	double IncrementalCatalog::get_eccentricity(unsigned int i) const{
+		return this -> kep_catalog.get(i,1);
+	}
+
+	double IncrementalCatalog::get_n(unsigned int i) const{
+		return this -> n[i];
+	}
+
+	double IncrementalCatalog::get_parameter(unsigned int i) const{
+		return this -> parameter[i];
+	}
+
+	double IncrementalCatalog::get_energy(unsigned int i) const{
+		return this -> energy[i];
+	}
+
+	double IncrementalCatalog::get_perigee_radius(unsigned int i) const{
+		return this -> perigee_radius[i];
+	}
+
+	double IncrementalCatalog::get_apogee_radius(unsigned int i) const{
+		return this -> apogee_radius[i];
+	}
+
+	unsigned int IncrementalCatalog::get_shell(double radius) const{
+		return std::upper_bound(this -> shell_radii.begin(),this -> shell_radii.end(),radius) - this -> shell_radii.begin();
+	}
+
+	const CatalogPartition & IncrementalCatalog::get_perigee_shells() const{
+		return this -> perigee_shells;
+	}
+
+	const CatalogPartition & IncrementalCatalog::get_apogee_shells() const{
+		return this -> apogee_shells;
+	}
+
+	const CatalogPartition & IncrementalCatalog::get_regimes() const{
+		return this -> regimes;
+	}
+
+}
@@ -74,9 +74,13 @@ namespace OC{
 
 
 	CartState KepState::convert_to_cart(double dt) const{
+		return this -> convert_to_cart(dt,SolverPolicy::default_policy());
+	}
+
+	CartState KepState::convert_to_cart(double dt,const SolverPolicy & policy) const{
 
 		double M = this -> get_M0() + this -> get_n() * dt;
-		double f = State::f_from_M(M,this -> get_eccentricity());
+		double f = State::f_from_M(M,this -> get_eccentricity(),policy);
 		
 
 		double r = this -> get_radius(f);
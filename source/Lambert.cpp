@@ -0,0 +1,419 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/Lambert.hpp"
+
+namespace OC{
+
+	std::vector<LambertSolution> Lambert::solve(const arma::vec::fixed<3> & r1,
+		const arma::vec::fixed<3> & r2,
+		double tof,
+		double mu,
+		bool prograde,
+		unsigned int max_revolutions){
+
+		std::vector<LambertSolution> solutions;
+
+		unsigned int M_max = std::min(max_revolutions,Lambert::get_max_revolutions(r1,r2,tof,mu,prograde));
+
+		for (unsigned int M = 0; M <= M_max; ++M){
+			for (int branch = 0; branch < (M == 0 ? 1 : 2); ++branch){
+
+				LambertSolution solution;
+				solution.revolutions = M;
+				solution.low_path = (branch == 0);
+
+				if (Lambert::solve(r1,r2,tof,mu,M,solution.low_path,prograde,solution.departure,solution.arrival)){
+					solutions.push_back(solution);
+				}
+			}
+		}
+
+		return solutions;
+
+	}
+
+	bool Lambert::solve(const arma::vec::fixed<3> & r1,
+		const arma::vec::fixed<3> & r2,
+		double tof,
+		double mu,
+		unsigned int revolutions,
+		bool low_path,
+		bool prograde,
+		CartState & departure,
+		CartState & arrival){
+
+		arma::vec departure_state(6);
+		arma::vec arrival_state(6);
+		departure_state.subvec(0,2) = r1;
+		arrival_state.subvec(0,2) = r2;
+
+		double x = arma::datum::nan;
+
+		if (!Lambert::solve(r1.memptr(),r2.memptr(),tof,mu,revolutions,low_path,prograde,
+			departure_state.memptr() + 3,arrival_state.memptr() + 3,x)){
+			return false;
+		}
+
+		departure = CartState(departure_state,mu);
+		arrival = CartState(arrival_state,mu);
+
+		return true;
+
+	}
+
+	bool Lambert::solve(const double * r1,
+		const double * r2,
+		double tof,
+		double mu,
+		unsigned int revolutions,
+		bool low_path,
+		bool prograde,
+		double * v1,
+		double * v2,
+		double & x){
+
+		double lambda,T,r1_norm,r2_norm,c_norm,s;
+		double i_r1[3],i_r2[3],i_t1[3],i_t2[3];
+
+		if (!Lambert::get_geometry(r1,r2,tof,mu,prograde,lambda,T,i_r1,i_r2,i_t1,i_t2,r1_norm,r2_norm,c_norm,s)){
+			return false;
+		}
+
+		if (revolutions > Lambert::get_max_revolutions(lambda,T)){
+			return false;
+		}
+
+		bool warm_start = std::isfinite(x);
+		if (!warm_start){
+			x = Lambert::initial_guess(T,lambda,revolutions,low_path);
+		}
+
+		if (!Lambert::householder(x,T,lambda,revolutions)){
+			return false;
+		}
+
+		double y = Lambert::compute_y(x,lambda);
+
+		// Near T_min the two multi-revolution branches merge, and a warm start
+		// may converge onto the other one. The low path is the branch where dT/dx > 0
+		if (warm_start && revolutions > 0 && (Lambert::tof_derivative(x,y,T,lambda) > 0) != low_path){
+			return false;
+		}
+
+		// Velocity reconstruction
+		double gamma = std::sqrt(mu * s / 2);
+		double rho = (r1_norm - r2_norm) / c_norm;
+		double sigma = std::sqrt(1 - rho * rho);
+
+		double v_r1 = gamma * ((lambda * y - x) - rho * (lambda * y + x)) / r1_norm;
+		double v_r2 = - gamma * ((lambda * y - x) + rho * (lambda * y + x)) / r2_norm;
+		double v_t1 = gamma * sigma * (y + lambda * x) / r1_norm;
+		double v_t2 = gamma * sigma * (y + lambda * x) / r2_norm;
+
+		for (int k = 0; k < 3; ++k){
+			v1[k] = v_r1 * i_r1[k] + v_t1 * i_t1[k];
+			v2[k] = v_r2 * i_r2[k] + v_t2 * i_t2[k];
+		}
+
+		return true;
+
+	}
+
+	unsigned int Lambert::get_max_revolutions(const arma::vec::fixed<3> & r1,
+		const arma::vec::fixed<3> & r2,
+		double tof,
+		double mu,
+		bool prograde){
+
+		double lambda,T,r1_norm,r2_norm,c_norm,s;
+		double i_r1[3],i_r2[3],i_t1[3],i_t2[3];
+
+		if (!Lambert::get_geometry(r1.memptr(),r2.memptr(),tof,mu,prograde,lambda,T,i_r1,i_r2,i_t1,i_t2,r1_norm,r2_norm,c_norm,s)){
+			return 0;
+		}
+
+		return Lambert::get_max_revolutions(lambda,T);
+
+	}
+
+	bool Lambert::get_geometry(const double * r1,const double * r2,double tof,double mu,bool prograde,
+		double & lambda,double & T,double * i_r1,double * i_r2,double * i_t1,double * i_t2,
+		double & r1_norm,double & r2_norm,double & c_norm,double & s){
+
+		if (!(tof > 0)){
+			return false;
+		}
+
+		double c[3] = {r2[0] - r1[0],r2[1] - r1[1],r2[2] - r1[2]};
+		c_norm = std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+		r1_norm = std::sqrt(r1[0] * r1[0] + r1[1] * r1[1] + r1[2] * r1[2]);
+		r2_norm = std::sqrt(r2[0] * r2[0] + r2[1] * r2[1] + r2[2] * r2[2]);
+		s = (r1_norm + r2_norm + c_norm) / 2;
+
+		for (int k = 0; k < 3; ++k){
+			i_r1[k] = r1[k] / r1_norm;
+			i_r2[k] = r2[k] / r2_norm;
+		}
+
+		double i_h[3] = {i_r1[1] * i_r2[2] - i_r1[2] * i_r2[1],
+			i_r1[2] * i_r2[0] - i_r1[0] * i_r2[2],
+			i_r1[0] * i_r2[1] - i_r1[1] * i_r2[0]};
+		double h_norm = std::sqrt(i_h[0] * i_h[0] + i_h[1] * i_h[1] + i_h[2] * i_h[2]);
+
+		// The transfer plane is undefined for collinear positions
+		if (h_norm < 1e-12 || c_norm == 0){
+			return false;
+		}
+
+		for (int k = 0; k < 3; ++k){
+			i_h[k] /= h_norm;
+		}
+
+		lambda = std::sqrt(1 - std::min(1.,c_norm / s));
+
+		if (i_h[2] < 0){
+			lambda = - lambda;
+			for (int k = 0; k < 3; ++k){
+				i_h[k] = - i_h[k];
+			}
+		}
+
+		double direction = 1;
+		if (!prograde){
+			lambda = - lambda;
+			direction = -1;
+		}
+
+		i_t1[0] = direction * (i_h[1] * i_r1[2] - i_h[2] * i_r1[1]);
+		i_t1[1] = direction * (i_h[2] * i_r1[0] - i_h[0] * i_r1[2]);
+		i_t1[2] = direction * (i_h[0] * i_r1[1] - i_h[1] * i_r1[0]);
+
+		i_t2[0] = direction * (i_h[1] * i_r2[2] - i_h[2] * i_r2[1]);
+		i_t2[1] = direction * (i_h[2] * i_r2[0] - i_h[0] * i_r2[2]);
+		i_t2[2] = direction * (i_h[0] * i_r2[1] - i_h[1] * i_r2[0]);
+
+		// Non-dimensional time of flight
+		T = std::sqrt(2 * mu / std::pow(s,3)) * tof;
+
+		return true;
+
+	}
+
+	unsigned int Lambert::get_max_revolutions(double lambda,double T){
+
+		unsigned int M_max = (unsigned int)(std::floor(T / arma::datum::pi));
+		double T_00 = std::acos(lambda) + lambda * std::sqrt(1 - lambda * lambda);
+
+		// The minimum time of flight of the M_max revolutions solutions may exceed T
+		if (M_max > 0 && T < T_00 + M_max * arma::datum::pi){
+			double T_min;
+			if (Lambert::compute_T_min(lambda,M_max,T_min) && T < T_min){
+				--M_max;
+			}
+		}
+
+		return M_max;
+
+	}
+
+	double Lambert::compute_y(double x,double lambda){
+		return std::sqrt(1 - lambda * lambda * (1 - x * x));
+	}
+
+	double Lambert::compute_psi(double x,double y,double lambda){
+
+		if (x >= -1 && x < 1){
+			return std::acos(x * y + lambda * (1 - x * x));
+		}
+		else if (x > 1){
+			return std::asinh((y - x * lambda) * std::sqrt(x * x - 1));
+		}
+		else{
+			return 0;
+		}
+
+	}
+
+	double Lambert::hypergeometric_series(double z){
+
+		// Gauss hypergeometric function 2F1(3,1,5/2,z)
+		if (z >= 1){
+			return arma::datum::inf;
+		}
+
+		double result = 1;
+		double term = 1;
+
+		for (unsigned int i = 0; i < 1000; ++i){
+			term *= (3 + i) * (1 + i) / (2.5 + i) * z / (i + 1);
+			double previous_result = result;
+			result += term;
+			if (result == previous_result){
+				break;
+			}
+		}
+
+		return result;
+
+	}
+
+	double Lambert::tof_equation(double x,double y,double T0,double lambda,unsigned int M){
+
+		double T;
+
+		if (M == 0 && x > std::sqrt(0.6) && x < std::sqrt(1.4)){
+
+			// Battin's series close to the parabolic case, where the general expression loses accuracy
+			double eta = y - lambda * x;
+			double S_1 = (1 - lambda - x * eta) / 2;
+			double Q = 4. / 3. * Lambert::hypergeometric_series(S_1);
+			T = (std::pow(eta,3) * Q + 4 * lambda * eta) / 2;
+		}
+		else{
+			double psi = Lambert::compute_psi(x,y,lambda);
+			T = ((psi + M * arma::datum::pi) / std::sqrt(std::abs(1 - x * x)) - x + lambda * y) / (1 - x * x);
+		}
+
+		return T - T0;
+
+	}
+
+	double Lambert::tof_derivative(double x,double y,double T,double lambda){
+		return (3 * T * x - 2 + 2 * std::pow(lambda,3) * x / y) / (1 - x * x);
+	}
+
+	double Lambert::tof_second_derivative(double x,double y,double T,double dT,double lambda){
+		return (3 * T + 5 * x * dT + 2 * (1 - lambda * lambda) * std::pow(lambda,3) / std::pow(y,3)) / (1 - x * x);
+	}
+
+	double Lambert::tof_third_derivative(double x,double y,double dT,double ddT,double lambda){
+		return (7 * x * ddT + 8 * dT - 6 * (1 - lambda * lambda) * std::pow(lambda,5) * x / std::pow(y,5)) / (1 - x * x);
+	}
+
+	double Lambert::initial_guess(double T,double lambda,unsigned int M,bool low_path){
+
+		if (M == 0){
+
+			double T_0 = std::acos(lambda) + lambda * std::sqrt(1 - lambda * lambda);
+			double T_1 = 2 * (1 - std::pow(lambda,3)) / 3;
+
+			if (T >= T_0){
+				return std::pow(T_0 / T,2. / 3.) - 1;
+			}
+			else if (T < T_1){
+				return 5. / 2. * T_1 / T * (T_1 - T) / (1 - std::pow(lambda,5)) + 1;
+			}
+			else{
+				return std::pow(T_0 / T,std::log2(T_1 / T_0)) - 1;
+			}
+
+		}
+		else{
+
+			double left = std::pow((M * arma::datum::pi + arma::datum::pi) / (8 * T),2. / 3.);
+			double right = std::pow(8 * T / (M * arma::datum::pi),2. / 3.);
+
+			double x_left = (left - 1) / (left + 1);
+			double x_right = (right - 1) / (right + 1);
+
+			if (low_path){
+				return std::max(x_left,x_right);
+			}
+			else{
+				return std::min(x_left,x_right);
+			}
+
+		}
+
+	}
+
+	bool Lambert::householder(double & x,double T,double lambda,unsigned int M){
+
+		for (unsigned int i = 0; i < 50; ++i){
+
+			double y = Lambert::compute_y(x,lambda);
+			double f = Lambert::tof_equation(x,y,T,lambda,M);
+			double T_x = f + T;
+
+			double dT = Lambert::tof_derivative(x,y,T_x,lambda);
+			double ddT = Lambert::tof_second_derivative(x,y,T_x,dT,lambda);
+			double dddT = Lambert::tof_third_derivative(x,y,dT,ddT,lambda);
+
+			double x_new = x - f * ((dT * dT - f * ddT / 2) / (dT * (dT * dT - f * ddT) + dddT * f * f / 6));
+
+			if (!std::isfinite(x_new)){
+				return false;
+			}
+
+			double dx = std::abs(x_new - x);
+			x = x_new;
+
+			if (dx < 1e-13){
+				return true;
+			}
+
+		}
+
+		return false;
+
+	}
+
+	bool Lambert::compute_T_min(double lambda,unsigned int M,double & T_min){
+
+		if (lambda == 1){
+			T_min = Lambert::tof_equation(0,Lambert::compute_y(0,lambda),0,lambda,M);
+			return true;
+		}
+
+		// Halley iterations on dT/dx = 0, started from x > 0 to avoid problems at lambda = -1
+		double x = 0.1;
+
+		for (unsigned int i = 0; i < 50; ++i){
+
+			double y = Lambert::compute_y(x,lambda);
+			double T = Lambert::tof_equation(x,y,0,lambda,M);
+			double dT = Lambert::tof_derivative(x,y,T,lambda);
+			double ddT = Lambert::tof_second_derivative(x,y,T,dT,lambda);
+			double dddT = Lambert::tof_third_derivative(x,y,dT,ddT,lambda);
+
+			double x_new = x - 2 * dT * ddT / (2 * ddT * ddT - dT * dddT);
+
+			if (!std::isfinite(x_new)){
+				return false;
+			}
+
+			double dx = std::abs(x_new - x);
+			x = x_new;
+
+			if (dx < 1e-13){
+				T_min = Lambert::tof_equation(x,Lambert::compute_y(x,lambda),0,lambda,M);
+				return true;
+			}
+
+		}
+
+		return false;
+
+	}
+
+}
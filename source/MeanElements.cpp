@@ -0,0 +1,317 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/MeanElements.hpp"
+
+namespace OC{
+
+	const double MeanElements::critical_inclination_band = 1e-2;
+
+	KepState MeanElements::mean_to_osculating(const KepState & mean,double J2,double body_radius){
+
+		double elements[6] = {mean.get_a(),mean.get_eccentricity(),mean.get_inclination(),
+			mean.get_Omega(),mean.get_omega(),mean.get_M0()};
+
+		arma::vec osculating(6);
+		MeanElements::mean_to_osculating_kernel(elements,J2,body_radius,osculating.memptr());
+
+		return KepState(osculating,mean.get_mu());
+
+	}
+
+	KepState MeanElements::osculating_to_mean(const KepState & osculating,double J2,double body_radius,
+		double tolerance,unsigned int max_iterations){
+
+		double elements[6] = {osculating.get_a(),osculating.get_eccentricity(),osculating.get_inclination(),
+			osculating.get_Omega(),osculating.get_omega(),osculating.get_M0()};
+
+		arma::vec mean(6);
+		if (!MeanElements::osculating_to_mean_kernel(elements,J2,body_radius,mean.memptr(),tolerance,max_iterations)){
+			std::cout << "MeanElements::osculating_to_mean did not converge or is too close to the critical inclination\n";
+		}
+
+		return KepState(mean,osculating.get_mu());
+
+	}
+
+	void MeanElements::mean_to_osculating(const arma::mat & mean_states,double J2,double body_radius,arma::mat & osculating_states){
+
+		osculating_states.set_size(6,mean_states.n_cols);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < mean_states.n_cols; ++i){
+			MeanElements::mean_to_osculating_kernel(mean_states.colptr(i),J2,body_radius,osculating_states.colptr(i));
+		}
+
+	}
+
+	void MeanElements::osculating_to_mean(const arma::mat & osculating_states,double J2,double body_radius,arma::mat & mean_states,
+		double tolerance,unsigned int max_iterations){
+
+		mean_states.set_size(6,osculating_states.n_cols);
+		unsigned int failures = 0;
+
+		#pragma omp parallel for reduction(+:failures)
+		for (unsigned int i = 0; i < osculating_states.n_cols; ++i){
+			if (!MeanElements::osculating_to_mean_kernel(osculating_states.colptr(i),J2,body_radius,mean_states.colptr(i),tolerance,max_iterations)){
+				++failures;
+			}
+		}
+
+		if (failures > 0){
+			std::cout << "MeanElements::osculating_to_mean did not converge or is too close to the critical inclination for " << failures << " states\n";
+		}
+
+	}
+
+	void MeanElements::mean_to_osculating_kernel(const double * elements,double J2,double body_radius,double * mapped,double sign){
+
+		double a = elements[0];
+		double e = elements[1];
+		double i = elements[2];
+		double Omega = elements[3];
+		double omega = elements[4];
+		double M = elements[5];
+
+		if (e >= 1){
+			std::copy(elements,elements + 6,mapped);
+			return;
+		}
+
+		double f = State::f_from_M(M,e);
+
+		double gamma2 = sign * J2 / 2 * std::pow(body_radius / a,2);
+		double eta = std::sqrt(1 - e * e);
+		double eta2 = eta * eta;
+		double eta3 = eta2 * eta;
+		double gamma2p = gamma2 / (eta2 * eta2);
+		double a_r = (1 + e * std::cos(f)) / eta2;
+
+		double c = std::cos(i);
+		double c2 = c * c;
+		double c4 = c2 * c2;
+		double s2 = 1 - c2;
+		double critical = 1 - 5 * c2;
+
+		double cos_f = std::cos(f);
+		double sin_f = std::sin(f);
+		double cos_2w_f = std::cos(2 * omega + f);
+		double cos_2w_2f = std::cos(2 * omega + 2 * f);
+		double cos_2w_3f = std::cos(2 * omega + 3 * f);
+		double sin_2w = std::sin(2 * omega);
+		double sin_2w_f = std::sin(2 * omega + f);
+		double sin_2w_2f = std::sin(2 * omega + 2 * f);
+		double sin_2w_3f = std::sin(2 * omega + 3 * f);
+
+		// Equation of the center, f - M
+		double center = f - M + e * sin_f;
+		double polynomial = 3 * cos_f + 3 * e * cos_f * cos_f + e * e * cos_f * cos_f * cos_f;
+
+		double a_p = a + a * gamma2 * ((3 * c2 - 1) * (std::pow(a_r,3) - 1 / eta3) + 3 * s2 * std::pow(a_r,3) * cos_2w_2f);
+
+		double de1 = gamma2p / 8 * e * eta2 * (1 - 11 * c2 - 40 * c4 / critical) * std::cos(2 * omega);
+
+		double de = de1 + eta2 / 2 * (gamma2 * ((3 * c2 - 1) / std::pow(eta,6) * (e * eta + e / (1 + eta) + polynomial)
+			+ 3 * s2 / std::pow(eta,6) * (e + polynomial) * cos_2w_2f)
+			- gamma2p * s2 * (3 * cos_2w_f + cos_2w_3f));
+
+		// - e de1 / (eta^2 tan(i)), with sin^2(i) factored out of 1 - 11 c^2 - 40 c^4 / (1 - 5 c^2) = s^2 (1 - 15 c^2) / (1 - 5 c^2)
+		// so that the division by tan(i) cancels and the term vanishes on equatorial orbits instead of being 0/0
+		double di = - gamma2p / 8 * e * e * std::sqrt(s2) * c * (1 - 15 * c2) / critical * std::cos(2 * omega) 
+		+ gamma2p / 2 * c * std::sqrt(s2) * (3 * cos_2w_2f + 3 * e * cos_2w_f + e * cos_2w_3f);
+
+		double short_period = 3 * sin_2w_2f + 3 * e * sin_2w_f + e * sin_2w_3f;
+
+		double dOmega = - gamma2p / 8 * e * e * c * (11 + 80 * c2 / critical + 200 * c4 / (critical * critical)) * sin_2w 
+		- gamma2p / 2 * c * (6 * center - short_period);
+
+		// Correction of the sum M + omega + Omega
+		double M_omega_Omega = M + omega + Omega 
+		+ gamma2p / 8 * eta3 * (1 - 11 * c2 - 40 * c4 / critical) * sin_2w 
+		- gamma2p / 16 * (2 + e * e - 11 * (2 + 3 * e * e) * c2 - 40 * (2 + 5 * e * e) * c4 / critical 
+			- 400 * e * e * c4 * c2 / (critical * critical)) * sin_2w 
+		+ gamma2p / 4 * (- 6 * critical * center + (3 - 5 * c2) * short_period) 
+		+ dOmega;
+
+		double e_dM = gamma2p / 8 * e * eta3 * (1 - 11 * c2 - 40 * c4 / critical) * sin_2w 
+		- gamma2p / 4 * eta3 * (2 * (3 * c2 - 1) * (a_r * a_r * eta2 + a_r + 1) * sin_f 
+			+ 3 * s2 * ((- a_r * a_r * eta2 - a_r + 1) * sin_2w_f + (a_r * a_r * eta2 + a_r + 1. / 3) * sin_2w_3f));
+
+		// Lyddane recombination, regular in e and i
+		double d1 = (e + de) * std::sin(M) + e_dM * std::cos(M);
+		double d2 = (e + de) * std::cos(M) - e_dM * std::sin(M);
+		double M_p = std::atan2(d1,d2);
+		double e_p = std::sqrt(d1 * d1 + d2 * d2);
+
+		double sin_half_i = std::sin(i / 2);
+		double d3 = (sin_half_i + std::cos(i / 2) * di / 2) * std::sin(Omega) + sin_half_i * dOmega * std::cos(Omega);
+		double d4 = (sin_half_i + std::cos(i / 2) * di / 2) * std::cos(Omega) - sin_half_i * dOmega * std::sin(Omega);
+		double Omega_p = std::atan2(d3,d4);
+		double i_p = 2 * std::asin(std::min(1.,std::sqrt(d3 * d3 + d4 * d4)));
+
+		double omega_p = M_omega_Omega - M_p - Omega_p;
+
+		mapped[0] = a_p;
+		mapped[1] = e_p;
+		mapped[2] = i_p;
+		mapped[3] = Omega_p;
+		mapped[4] = omega_p;
+		mapped[5] = M_p;
+
+		for (unsigned int k = 3; k < 6; ++k){
+			mapped[k] = std::fmod(mapped[k],2 * arma::datum::pi);
+			if (mapped[k] < 0){
+				mapped[k] += 2 * arma::datum::pi;
+			}
+		}
+
+	}
+
+	bool MeanElements::osculating_to_mean_kernel(const double * osculating,double J2,double body_radius,double * mean,
+		double tolerance,unsigned int max_iterations){
+
+		if (osculating[1] >= 1){
+			std::copy(osculating,osculating + 6,mean);
+			return true;
+		}
+
+		// The long-period corrections diverge at the critical inclinations
+		auto is_critical = [](double i){
+			return std::abs(1 - 5 * std::pow(std::cos(i),2)) < MeanElements::critical_inclination_band;
+		};
+
+		if (is_critical(osculating[2])){
+			std::fill(mean,mean + 6,arma::datum::nan);
+			return false;
+		}
+
+		// The iteration is carried on (a, e cos M, e sin M, sin(i/2) cos Omega, sin(i/2) sin Omega, M + omega + Omega),
+		// which remain regular for near-circular and low-inclination orbits
+		auto to_nonsingular = [](const double * elements,double * z){
+			z[0] = elements[0];
+			z[1] = elements[1] * std::cos(elements[5]);
+			z[2] = elements[1] * std::sin(elements[5]);
+			z[3] = std::sin(elements[2] / 2) * std::cos(elements[3]);
+			z[4] = std::sin(elements[2] / 2) * std::sin(elements[3]);
+			z[5] = elements[3] + elements[4] + elements[5];
+		};
+
+		auto from_nonsingular = [](const double * z,double * elements){
+			elements[0] = z[0];
+			elements[1] = std::sqrt(z[1] * z[1] + z[2] * z[2]);
+			elements[2] = 2 * std::asin(std::min(1.,std::sqrt(z[3] * z[3] + z[4] * z[4])));
+			elements[3] = std::atan2(z[4],z[3]);
+			elements[5] = std::atan2(z[2],z[1]);
+			elements[4] = z[5] - elements[3] - elements[5];
+		};
+
+		double z_osculating[6];
+		to_nonsingular(osculating,z_osculating);
+
+		// Initial guess from the first-order inverse mapping
+		MeanElements::mean_to_osculating_kernel(osculating,J2,body_radius,mean,-1);
+
+		double z_mean[6];
+		double z_mapped[6];
+		double mapped[6];
+		to_nonsingular(mean,z_mean);
+
+		bool converged = false;
+
+		for (unsigned int k = 0; k < max_iterations && !converged; ++k){
+
+			MeanElements::mean_to_osculating_kernel(mean,J2,body_radius,mapped);
+			to_nonsingular(mapped,z_mapped);
+
+			double residual = 0;
+			for (unsigned int j = 0; j < 6; ++j){
+				double difference = z_osculating[j] - z_mapped[j];
+				if (j == 5){
+					difference = std::remainder(difference,2 * arma::datum::pi);
+				}
+				z_mean[j] += difference;
+
+				// NaN residuals are kept so that they fail the convergence test
+				double error = std::abs(j == 0 ? difference / z_osculating[0] : difference);
+				if (!(error <= residual)){
+					residual = error;
+				}
+			}
+
+			from_nonsingular(z_mean,mean);
+			converged = residual < tolerance;
+
+		}
+
+		for (unsigned int k = 0; k < 6; ++k){
+			converged = converged && std::isfinite(mean[k]);
+		}
+
+		if (mean[1] >= 1 || is_critical(mean[2])){
+			converged = false;
+		}
+
+		for (unsigned int k = 3; k < 6; ++k){
+			mean[k] = std::fmod(mean[k],2 * arma::datum::pi);
+			if (mean[k] < 0){
+				mean[k] += 2 * arma::datum::pi;
+			}
+		}
+
+		return converged;
+
+	}
+
+	void MeanElements::get_secular_rates(const KepState & mean,double J2,double body_radius,double * rates){
+
+		double a = mean.get_a();
+		double e = mean.get_eccentricity();
+		double c = std::cos(mean.get_inclination());
+		double eta = std::sqrt(1 - e * e);
+		double n = mean.get_n();
+
+		double k = 1.5 * J2 * std::pow(body_radius / (a * eta * eta),2) * n;
+
+		rates[0] = - k * c;
+		rates[1] = k / 2 * (5 * c * c - 1);
+		rates[2] = n + k / 2 * eta * (3 * c * c - 1);
+
+	}
+
+	KepState MeanElements::propagate_mean(const KepState & mean,double J2,double body_radius,double delta_T){
+
+		double rates[3];
+		MeanElements::get_secular_rates(mean,J2,body_radius,rates);
+
+		arma::vec state = mean.get_state();
+		for (unsigned int k = 0; k < 3; ++k){
+			state(3 + k) = std::fmod(state(3 + k) + rates[k] * delta_T,2 * arma::datum::pi);
+			if (state(3 + k) < 0){
+				state(3 + k) += 2 * arma::datum::pi;
+			}
+		}
+
+		return KepState(state,mean.get_mu());
+
+	}
+
+}
@@ -0,0 +1,130 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/Measurements.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace OC{
+
+	void Measurements::compute(const arma::mat & states,
+		const arma::mat & station_states,
+		arma::mat & measurements,
+		arma::mat & partials){
+
+		Measurements::check_shapes(states,station_states,"Measurements::compute");
+
+		unsigned int K = states.n_cols;
+		unsigned int station_stride = (station_states.n_cols == 1 ? 0 : 6);
+
+		measurements.set_size(4,K);
+		partials.set_size(6,4 * K);
+
+		const double * state = states.memptr();
+		const double * station_state = station_states.memptr();
+		double * measurement = measurements.memptr();
+		double * partial = partials.memptr();
+
+		#pragma omp parallel for
+		for (unsigned int k = 0; k < K; ++k){
+			Measurements::measurement_kernel(state + 6 * k,station_state + station_stride * k,measurement + 4 * k,partial + 24 * k);
+		}
+
+	}
+
+	arma::vec Measurements::compute(const CartState & state,
+		const arma::vec & station_state,
+		arma::mat & H){
+
+		Measurements::check_shapes(state.get_state(),station_state,"Measurements::compute");
+
+		arma::vec measurement(4);
+		arma::mat partials(6,4);
+
+		Measurements::measurement_kernel(state.get_state().memptr(),station_state.memptr(),measurement.memptr(),partials.memptr());
+		H = partials.t();
+
+		return measurement;
+
+	}
+
+	void Measurements::check_shapes(const arma::mat & states,const arma::mat & station_states,const char * caller){
+
+		if (states.n_rows != 6 || station_states.n_rows != 6){
+			throw std::invalid_argument(std::string(caller) + ": states must have 6 rows");
+		}
+
+		if (station_states.n_cols != 1 && station_states.n_cols != states.n_cols){
+			throw std::invalid_argument(std::string(caller) + ": expected 1 or " + std::to_string(states.n_cols) 
+				+ " station states, got " + std::to_string(station_states.n_cols));
+		}
+
+	}
+
+	inline void Measurements::measurement_kernel(const double * state,const double * station_state,double * measurement,double * partial){
+
+		double rho[3] = {state[0] - station_state[0],state[1] - station_state[1],state[2] - station_state[2]};
+		double rho_dot[3] = {state[3] - station_state[3],state[4] - station_state[4],state[5] - station_state[5]};
+
+		double rho_xy_squared = rho[0] * rho[0] + rho[1] * rho[1];
+		double rho_xy = std::sqrt(rho_xy_squared);
+		double range_squared = rho_xy_squared + rho[2] * rho[2];
+		double range = std::sqrt(range_squared);
+		double range_rate = (rho[0] * rho_dot[0] + rho[1] * rho_dot[1] + rho[2] * rho_dot[2]) / range;
+
+		measurement[RANGE] = range;
+		measurement[RANGE_RATE] = range_rate;
+		measurement[RIGHT_ASCENSION] = std::atan2(rho[1],rho[0]);
+		measurement[DECLINATION] = std::atan2(rho[2],rho_xy);
+
+		double * H_range = partial + 6 * RANGE;
+		double * H_range_rate = partial + 6 * RANGE_RATE;
+		double * H_right_ascension = partial + 6 * RIGHT_ASCENSION;
+		double * H_declination = partial + 6 * DECLINATION;
+
+		for (int k = 0; k < 3; ++k){
+
+			double u = rho[k] / range;
+
+			H_range[k] = u;
+			H_range[k + 3] = 0;
+
+			H_range_rate[k] = (rho_dot[k] - range_rate * u) / range;
+			H_range_rate[k + 3] = u;
+		}
+
+		H_right_ascension[0] = - rho[1] / rho_xy_squared;
+		H_right_ascension[1] = rho[0] / rho_xy_squared;
+		H_right_ascension[2] = 0;
+
+		H_declination[0] = - rho[0] * rho[2] / (range_squared * rho_xy);
+		H_declination[1] = - rho[1] * rho[2] / (range_squared * rho_xy);
+		H_declination[2] = rho_xy / range_squared;
+
+		for (int k = 3; k < 6; ++k){
+			H_right_ascension[k] = 0;
+			H_declination[k] = 0;
+		}
+
+	}
+
+}
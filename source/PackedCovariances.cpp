@@ -0,0 +1,88 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/PackedCovariances.hpp"
+
+namespace OC{
+
+	PackedCovariances::PackedCovariances(unsigned int N){
+		this -> set_size(N);
+	}
+
+	void PackedCovariances::set_size(unsigned int N){
+		this -> N = N;
+		this -> data.assign(21 * N,0);
+	}
+
+	unsigned int PackedCovariances::get_size() const{
+		return this -> N;
+	}
+
+	void PackedCovariances::set(unsigned int i,const arma::mat & P){
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row <= col; ++row){
+				this -> data[PackedCovariances::index(row,col) * this -> N + i] = P(row,col);
+			}
+		}
+	}
+
+	arma::mat PackedCovariances::get(unsigned int i) const{
+		arma::mat P(6,6);
+		this -> unpack(i,P.memptr());
+		return P;
+	}
+
+	double * PackedCovariances::component(unsigned int c){
+		return this -> data.data() + c * this -> N;
+	}
+
+	const double * PackedCovariances::component(unsigned int c) const{
+		return this -> data.data() + c * this -> N;
+	}
+
+	void PackedCovariances::unpack(unsigned int i,double * P) const{
+		unsigned int c = 0;
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row <= col; ++row, ++c){
+				P[row + 6 * col] = this -> data[c * this -> N + i];
+				P[col + 6 * row] = P[row + 6 * col];
+			}
+		}
+	}
+
+	void PackedCovariances::pack(unsigned int i,const double * P){
+		unsigned int c = 0;
+		for (unsigned int col = 0; col < 6; ++col){
+			for (unsigned int row = 0; row <= col; ++row, ++c){
+				this -> data[c * this -> N + i] = P[row + 6 * col];
+			}
+		}
+	}
+
+	unsigned int PackedCovariances::index(unsigned int row,unsigned int col){
+		if (row > col){
+			return row * (row + 1) / 2 + col;
+		}
+		return col * (col + 1) / 2 + row;
+	}
+
+}
@@ -0,0 +1,127 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/Porkchop.hpp"
+#include "OrbitConversions/PreparedKepState.hpp"
+#include "OrbitConversions/Lambert.hpp"
+
+namespace OC{
+
+	void Porkchop::compute(const KepState & departure_body,
+		const KepState & arrival_body,
+		const arma::vec & departure_times,
+		const arma::vec & arrival_times,
+		arma::mat & departure_dv,
+		arma::mat & arrival_dv,
+		unsigned int revolutions,
+		bool low_path,
+		bool prograde,
+		unsigned int block_size){
+
+		unsigned int N_departure = departure_times.n_rows;
+		unsigned int N_arrival = arrival_times.n_rows;
+		block_size = std::max(1u,block_size);
+
+		departure_dv.set_size(N_departure,N_arrival);
+		arrival_dv.set_size(N_departure,N_arrival);
+
+		// Body states are evaluated once per grid line
+		PreparedKepState prepared_departure_body(departure_body);
+		PreparedKepState prepared_arrival_body(arrival_body);
+		arma::mat departure_states(6,N_departure);
+		arma::mat arrival_states(6,N_arrival);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N_departure; ++i){
+			prepared_departure_body.get_position_velocity(departure_times(i),departure_states.colptr(i),departure_states.colptr(i) + 3);
+		}
+
+		#pragma omp parallel for
+		for (unsigned int j = 0; j < N_arrival; ++j){
+			prepared_arrival_body.get_position_velocity(arrival_times(j),arrival_states.colptr(j),arrival_states.colptr(j) + 3);
+		}
+
+		unsigned int N_blocks_departure = (N_departure + block_size - 1) / block_size;
+		unsigned int N_blocks_arrival = (N_arrival + block_size - 1) / block_size;
+		double mu = departure_body.get_mu();
+
+		#pragma omp parallel for schedule(dynamic)
+		for (unsigned int block = 0; block < N_blocks_departure * N_blocks_arrival; ++block){
+
+			unsigned int i_start = (block % N_blocks_departure) * block_size;
+			unsigned int j_start = (block / N_blocks_departure) * block_size;
+			unsigned int i_end = std::min(i_start + block_size,N_departure);
+			unsigned int j_end = std::min(j_start + block_size,N_arrival);
+
+			// x of the first cell of the previous column, and of the previous cell in the current column
+			double x_column = arma::datum::nan;
+
+			for (unsigned int j = j_start; j < j_end; ++j){
+
+				const double * arrival_state = arrival_states.colptr(j);
+				double x = x_column;
+
+				for (unsigned int i = i_start; i < i_end; ++i){
+
+					const double * departure_state = departure_states.colptr(i);
+					double tof = arrival_times(j) - departure_times(i);
+					double v1[3],v2[3];
+
+					double x_guess = x;
+					bool found = Lambert::solve(departure_state,arrival_state,tof,mu,revolutions,low_path,prograde,v1,v2,x_guess);
+
+					// A failed warm start is retried from the default initial guess
+					if (!found && std::isfinite(x)){
+						x_guess = arma::datum::nan;
+						found = Lambert::solve(departure_state,arrival_state,tof,mu,revolutions,low_path,prograde,v1,v2,x_guess);
+					}
+
+					if (found){
+
+						double dv_1 = std::sqrt(std::pow(v1[0] - departure_state[3],2) 
+							+ std::pow(v1[1] - departure_state[4],2) 
+							+ std::pow(v1[2] - departure_state[5],2));
+						double dv_2 = std::sqrt(std::pow(v2[0] - arrival_state[3],2) 
+							+ std::pow(v2[1] - arrival_state[4],2) 
+							+ std::pow(v2[2] - arrival_state[5],2));
+
+						departure_dv(i,j) = dv_1;
+						arrival_dv(i,j) = dv_2;
+						x = x_guess;
+					}
+					else{
+						departure_dv(i,j) = arma::datum::nan;
+						arrival_dv(i,j) = arma::datum::nan;
+						x = arma::datum::nan;
+					}
+
+					if (i == i_start){
+						x_column = x;
+					}
+
+				}
+			}
+		}
+
+	}
+
+}
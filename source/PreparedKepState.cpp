@@ -0,0 +1,195 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/PreparedKepState.hpp"
+
+namespace OC{
+
+	PreparedKepState::PreparedKepState() : PreparedKepState(KepState(arma::vec({1,0,0,0,0,0}),1)){
+
+	}
+
+	PreparedKepState::PreparedKepState(const KepState & kep) : PreparedKepState(kep.get_state().memptr(),kep.get_mu()){
+
+	}
+
+	PreparedKepState::PreparedKepState(const double * elements,double mu){
+
+		this -> a = elements[0];
+		this -> e = elements[1];
+		this -> n = std::sqrt(mu / std::pow(std::abs(this -> a),3));
+		this -> M0 = elements[5];
+		this -> mu = mu;
+		this -> elliptic = this -> e < 1;
+
+		this -> b_factor = std::sqrt(std::abs(1 - this -> e * this -> e));
+		this -> sqrt_mu_a = std::sqrt(this -> mu * std::abs(this -> a));
+		this -> p = this -> a * (1 - this -> e * this -> e);
+		this -> sqrt_mu_p = std::sqrt(this -> mu / this -> p);
+
+		double cos_Omega = std::cos(elements[3]);
+		double sin_Omega = std::sin(elements[3]);
+		double cos_omega = std::cos(elements[4]);
+		double sin_omega = std::sin(elements[4]);
+		double cos_i = std::cos(elements[2]);
+		double sin_i = std::sin(elements[2]);
+
+		// First two rows of M3(omega) * M1(i) * M3(Omega), consistent with KepState::convert_to_cart
+		this -> P[0] = cos_omega * cos_Omega - sin_omega * cos_i * sin_Omega;
+		this -> P[1] = cos_omega * sin_Omega + sin_omega * cos_i * cos_Omega;
+		this -> P[2] = sin_omega * sin_i;
+
+		this -> Q[0] = - sin_omega * cos_Omega - cos_omega * cos_i * sin_Omega;
+		this -> Q[1] = - sin_omega * sin_Omega + cos_omega * cos_i * cos_Omega;
+		this -> Q[2] = cos_omega * sin_i;
+
+	}
+
+	void PreparedKepState::get_position_velocity(double dt,double * pos,double * vel,const SolverPolicy & policy) const{
+		this -> get_position_velocity_from_anomaly(this -> get_anomaly(dt,policy),pos,vel);
+	}
+
+	void PreparedKepState::get_position_velocity(double dt,double anomaly_guess,double * pos,double * vel,const SolverPolicy & policy) const{
+
+		double M = this -> M0 + this -> n * dt;
+		double anomaly;
+
+		if (this -> elliptic){
+
+			// The guess is brought back to the revolution of the wrapped mean anomaly
+			M = std::remainder(M,2 * arma::datum::pi);
+			anomaly_guess = M + std::remainder(anomaly_guess - M,2 * arma::datum::pi);
+			anomaly = State::ecc_from_M_warm_start(M,this -> e,anomaly_guess,policy);
+		}
+		else{
+			anomaly = State::H_from_M_warm_start(M,this -> e,anomaly_guess,policy);
+		}
+
+		this -> get_position_velocity_from_anomaly(anomaly,pos,vel);
+
+	}
+
+	double PreparedKepState::get_anomaly(double dt,const SolverPolicy & policy) const{
+
+		double M = this -> M0 + this -> n * dt;
+
+		if (this -> elliptic){
+			return State::ecc_from_M(std::remainder(M,2 * arma::datum::pi),this -> e,policy);
+		}
+		else{
+			return State::H_from_M(M,this -> e,policy);
+		}
+
+	}
+
+	void PreparedKepState::get_position_velocity_from_anomaly(double anomaly,double * pos,double * vel) const{
+
+		double x,y,x_dot,y_dot;
+
+		if (this -> elliptic){
+			double cos_ecc = std::cos(anomaly);
+			double sin_ecc = std::sin(anomaly);
+			double r = this -> a * (1 - this -> e * cos_ecc);
+
+			x = this -> a * (cos_ecc - this -> e);
+			y = this -> a * this -> b_factor * sin_ecc;
+			x_dot = - this -> sqrt_mu_a * sin_ecc / r;
+			y_dot = this -> sqrt_mu_a * this -> b_factor * cos_ecc / r;
+		}
+		else{
+
+			// The true anomaly form avoids the cancellation in cosh(H) - e close to the parabola
+			double f = State::f_from_H(anomaly,this -> e);
+			double cos_f = std::cos(f);
+			double sin_f = std::sin(f);
+			double r = this -> p / (1 + this -> e * cos_f);
+
+			x = r * cos_f;
+			y = r * sin_f;
+			x_dot = - this -> sqrt_mu_p * sin_f;
+			y_dot = this -> sqrt_mu_p * (this -> e + cos_f);
+		}
+
+		for (int k = 0; k < 3; ++k){
+			pos[k] = x * this -> P[k] + y * this -> Q[k];
+			vel[k] = x_dot * this -> P[k] + y_dot * this -> Q[k];
+		}
+
+	}
+
+	void PreparedKepState::get_position(double dt,double * pos,const SolverPolicy & policy) const{
+
+		double M = this -> M0 + this -> n * dt;
+		double x,y;
+
+		if (this -> elliptic){
+			M = std::remainder(M,2 * arma::datum::pi);
+			double ecc = State::ecc_from_M(M,this -> e,policy);
+			x = this -> a * (std::cos(ecc) - this -> e);
+			y = this -> a * this -> b_factor * std::sin(ecc);
+		}
+		else{
+			double f = State::f_from_H(State::H_from_M(M,this -> e,policy),this -> e);
+			double r = this -> p / (1 + this -> e * std::cos(f));
+			x = r * std::cos(f);
+			y = r * std::sin(f);
+		}
+
+		for (int k = 0; k < 3; ++k){
+			pos[k] = x * this -> P[k] + y * this -> Q[k];
+		}
+
+	}
+
+	double PreparedKepState::get_time_scale() const{
+		return 2 * arma::datum::pi / this -> n;
+	}
+
+	double PreparedKepState::get_max_speed() const{
+		return std::sqrt(this -> mu * (1 + this -> e) / (this -> a * (1 - this -> e)));
+	}
+
+	double PreparedKepState::get_a() const{
+		return this -> a;
+	}
+
+	double PreparedKepState::get_eccentricity() const{
+		return this -> e;
+	}
+
+	double PreparedKepState::get_n() const{
+		return this -> n;
+	}
+
+	double PreparedKepState::get_M0() const{
+		return this -> M0;
+	}
+
+	double PreparedKepState::get_mu() const{
+		return this -> mu;
+	}
+
+	bool PreparedKepState::is_elliptic() const{
+		return this -> elliptic;
+	}
+
+}
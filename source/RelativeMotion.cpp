@@ -0,0 +1,160 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/RelativeMotion.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace OC{
+
+	arma::vec RelativeMotion::inertial_to_ric(const CartState & chief,const CartState & deputy){
+
+		arma::vec ric_state(6);
+		RelativeMotion::inertial_to_ric_kernel(chief.get_state().memptr(),deputy.get_state().memptr(),ric_state.memptr());
+		return ric_state;
+
+	}
+
+	CartState RelativeMotion::ric_to_inertial(const CartState & chief,const arma::vec & ric_state){
+
+		arma::vec deputy_state(6);
+		RelativeMotion::ric_to_inertial_kernel(chief.get_state().memptr(),ric_state.memptr(),deputy_state.memptr());
+		return CartState(deputy_state,chief.get_mu());
+
+	}
+
+	void RelativeMotion::inertial_to_ric(const arma::mat & chief_states,
+		const arma::mat & deputy_states,
+		arma::mat & ric_states){
+
+		RelativeMotion::check_shapes(chief_states,deputy_states,"RelativeMotion::inertial_to_ric");
+
+		unsigned int N = deputy_states.n_cols;
+		unsigned int chief_stride = (chief_states.n_cols == 1 ? 0 : 6);
+
+		ric_states.set_size(6,N);
+
+		const double * chief = chief_states.memptr();
+		const double * deputy = deputy_states.memptr();
+		double * ric = ric_states.memptr();
+
+		for (unsigned int i = 0; i < N; ++i){
+			RelativeMotion::inertial_to_ric_kernel(chief + chief_stride * i,deputy + 6 * i,ric + 6 * i);
+		}
+
+	}
+
+	void RelativeMotion::ric_to_inertial(const arma::mat & chief_states,
+		const arma::mat & ric_states,
+		arma::mat & deputy_states){
+
+		RelativeMotion::check_shapes(chief_states,ric_states,"RelativeMotion::ric_to_inertial");
+
+		unsigned int N = ric_states.n_cols;
+		unsigned int chief_stride = (chief_states.n_cols == 1 ? 0 : 6);
+
+		deputy_states.set_size(6,N);
+
+		const double * chief = chief_states.memptr();
+		const double * ric = ric_states.memptr();
+		double * deputy = deputy_states.memptr();
+
+		for (unsigned int i = 0; i < N; ++i){
+			RelativeMotion::ric_to_inertial_kernel(chief + chief_stride * i,ric + 6 * i,deputy + 6 * i);
+		}
+
+	}
+
+	void RelativeMotion::check_shapes(const arma::mat & chief_states,const arma::mat & states,const char * caller){
+
+		if (chief_states.n_rows != 6 || states.n_rows != 6){
+			throw std::invalid_argument(std::string(caller) + ": states must have 6 rows");
+		}
+
+		if (chief_states.n_cols != 1 && chief_states.n_cols != states.n_cols){
+			throw std::invalid_argument(std::string(caller) + ": expected 1 or " + std::to_string(states.n_cols) 
+				+ " chief states, got " + std::to_string(chief_states.n_cols));
+		}
+
+	}
+
+	inline void RelativeMotion::get_ric_frame(const double * chief,double * R,double * I,double * C,double & omega){
+
+		const double * r = chief;
+		const double * v = chief + 3;
+
+		double h[3] = {r[1] * v[2] - r[2] * v[1],
+			r[2] * v[0] - r[0] * v[2],
+			r[0] * v[1] - r[1] * v[0]};
+
+		double r_norm_squared = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+		double r_norm = std::sqrt(r_norm_squared);
+		double h_norm = std::sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+
+		for (int k = 0; k < 3; ++k){
+			R[k] = r[k] / r_norm;
+			C[k] = h[k] / h_norm;
+		}
+
+		I[0] = C[1] * R[2] - C[2] * R[1];
+		I[1] = C[2] * R[0] - C[0] * R[2];
+		I[2] = C[0] * R[1] - C[1] * R[0];
+
+		omega = h_norm / r_norm_squared;
+
+	}
+
+	inline void RelativeMotion::inertial_to_ric_kernel(const double * chief,const double * deputy,double * ric){
+
+		double R[3],I[3],C[3],omega;
+		RelativeMotion::get_ric_frame(chief,R,I,C,omega);
+
+		double dr[3] = {deputy[0] - chief[0],deputy[1] - chief[1],deputy[2] - chief[2]};
+		double dv[3] = {deputy[3] - chief[3],deputy[4] - chief[4],deputy[5] - chief[5]};
+
+		ric[0] = R[0] * dr[0] + R[1] * dr[1] + R[2] * dr[2];
+		ric[1] = I[0] * dr[0] + I[1] * dr[1] + I[2] * dr[2];
+		ric[2] = C[0] * dr[0] + C[1] * dr[1] + C[2] * dr[2];
+
+		// Transport theorem: the frame rotates at omega about C
+		ric[3] = R[0] * dv[0] + R[1] * dv[1] + R[2] * dv[2] + omega * ric[1];
+		ric[4] = I[0] * dv[0] + I[1] * dv[1] + I[2] * dv[2] - omega * ric[0];
+		ric[5] = C[0] * dv[0] + C[1] * dv[1] + C[2] * dv[2];
+
+	}
+
+	inline void RelativeMotion::ric_to_inertial_kernel(const double * chief,const double * ric,double * deputy){
+
+		double R[3],I[3],C[3],omega;
+		RelativeMotion::get_ric_frame(chief,R,I,C,omega);
+
+		double rho_dot_R = ric[3] - omega * ric[1];
+		double rho_dot_I = ric[4] + omega * ric[0];
+
+		for (int k = 0; k < 3; ++k){
+			deputy[k] = chief[k] + R[k] * ric[0] + I[k] * ric[1] + C[k] * ric[2];
+			deputy[k + 3] = chief[k + 3] + R[k] * rho_dot_R + I[k] * rho_dot_I + C[k] * ric[5];
+		}
+
+	}
+
+}
@@ -0,0 +1,396 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/SnapshotCodec.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+#include <cstring>
+
+namespace OC{
+
+	SnapshotCodec::SnapshotCodec(){
+		this -> mu = 1;
+		this -> t = 0;
+		this -> count = 0;
+		this -> has_reference = false;
+	}
+
+	const arma::mat & SnapshotCodec::get_states() const{
+		return this -> states;
+	}
+
+	double SnapshotCodec::get_time() const{
+		return this -> t;
+	}
+
+	long long SnapshotCodec::get_steps_per_turn(unsigned int k) const{
+
+		if (this -> settings.type == KEPLERIAN_SNAPSHOT && k > 2){
+			return static_cast<long long>(std::ceil(2 * arma::datum::pi / this -> settings.quantum[k]));
+		}
+		return 0;
+
+	}
+
+	long long SnapshotCodec::quantize(double value,long long steps,double scale){
+
+		long long quantized = std::llround(value / scale);
+
+		if (steps == 0){
+			return quantized;
+		}
+
+		quantized %= steps;
+		return quantized < 0 ? quantized + steps : quantized;
+
+	}
+
+	void SnapshotCodec::get_scales(long long * steps,double * scales) const{
+
+		for (unsigned int k = 0; k < 6; ++k){
+			steps[k] = this -> get_steps_per_turn(k);
+			scales[k] = steps[k] == 0 ? this -> settings.quantum[k] : 2 * arma::datum::pi / steps[k];
+		}
+
+	}
+
+	const long long * SnapshotCodec::predict(SnapshotPrediction prediction,double t,unsigned int N,std::vector<long long> & predicted) const{
+
+		if (prediction == INTRA_PREDICTION){
+			return nullptr;
+		}
+
+		if (prediction == PREVIOUS_PREDICTION){
+			return this -> quantized.data();
+		}
+
+		predicted.resize(6 * static_cast<size_t>(N));
+
+		double dt = t - this -> t;
+		arma::mat propagated;
+
+		if (this -> settings.type == CARTESIAN_SNAPSHOT){
+			arma::mat kep_states;
+			BatchConversions::cart_to_kep(this -> states,this -> mu,0,kep_states);
+			BatchConversions::kep_to_cart(kep_states,this -> mu,dt,propagated);
+		}
+		else{
+			propagated = this -> states;
+			#pragma omp parallel for
+			for (unsigned int i = 0; i < N; ++i){
+				propagated(5,i) += std::sqrt(this -> mu / std::pow(std::abs(propagated(0,i)),3)) * dt;
+			}
+		}
+
+		long long steps[6];
+		double scales[6];
+		this -> get_scales(steps,scales);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			for (unsigned int k = 0; k < 6; ++k){
+				predicted[k * static_cast<size_t>(N) + i] = SnapshotCodec::quantize(propagated(k,i),steps[k],scales[k]);
+			}
+		}
+
+		return predicted.data();
+
+	}
+
+	void SnapshotCodec::pack(const uint64_t * values,size_t n,std::vector<unsigned char> & bytes){
+
+		for (size_t first = 0; first < n; first += block_size){
+
+			size_t last = std::min(n,first + block_size);
+
+			uint64_t all_bits = 0;
+			for (size_t j = first; j < last; ++j){
+				all_bits |= values[j];
+			}
+
+			unsigned int width = 0;
+			while (width < 64 && (all_bits >> width) != 0){
+				++width;
+			}
+
+			bytes.push_back(static_cast<unsigned char>(width));
+			if (width == 0){
+				continue;
+			}
+
+			size_t offset = bytes.size();
+			bytes.resize(offset + ((last - first) * width + 7) / 8,0);
+			unsigned char * out = bytes.data() + offset;
+
+			size_t position = 0;
+			for (size_t j = first; j < last; ++j){
+				uint64_t value = values[j];
+				for (unsigned int written = 0; written < width; ){
+					unsigned int shift = position & 7;
+					unsigned int take = std::min(width - written,8 - shift);
+					out[position >> 3] |= static_cast<unsigned char>(((value >> written) & ((1u << take) - 1)) << shift);
+					written += take;
+					position += take;
+				}
+			}
+
+		}
+
+	}
+
+	size_t SnapshotCodec::unpack(const unsigned char * data,size_t size,size_t n,uint64_t * values){
+
+		// The block offsets are found from the widths alone, so that the blocks can then be unpacked in parallel
+		size_t blocks = (n + block_size - 1) / block_size;
+		std::vector<size_t> offsets(blocks);
+
+		size_t offset = 0;
+		for (size_t b = 0; b < blocks; ++b){
+
+			if (offset >= size || data[offset] > 64){
+				return 0;
+			}
+
+			size_t count = std::min(n - b * block_size,static_cast<size_t>(block_size));
+			offsets[b] = offset;
+			offset += 1 + (count * data[offset] + 7) / 8;
+
+		}
+
+		if (offset > size){
+			return 0;
+		}
+
+		#pragma omp parallel for
+		for (size_t b = 0; b < blocks; ++b){
+
+			size_t first = b * block_size;
+			size_t last = std::min(n,first + block_size);
+			unsigned int width = data[offsets[b]];
+
+			if (width == 0){
+				std::fill(values + first,values + last,0);
+				continue;
+			}
+
+			const unsigned char * in = data + offsets[b] + 1;
+			size_t block_bytes = ((last - first) * width + 7) / 8;
+			uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+
+			// Each value is read from the 8 bytes holding its first bit, plus one byte if it straddles them. 
+			// Up to 56 bits, no value straddles them, which leaves a branch-free loop away from the end of the block
+			size_t j = first;
+			size_t position = 0;
+			if (width <= 56){
+				size_t fast_last = block_bytes < 8 ? first : std::min(last,first + ((block_bytes - 8) * 8) / width + 1);
+				for (; j < fast_last; ++j){
+					uint64_t word;
+					std::memcpy(&word,in + (position >> 3),8);
+					values[j] = (word >> (position & 7)) & mask;
+					position += width;
+				}
+			}
+
+			for (; j < last; ++j){
+				size_t byte = position >> 3;
+				unsigned int shift = position & 7;
+				uint64_t word = 0;
+				std::memcpy(&word,in + byte,std::min<size_t>(8,block_bytes - byte));
+				uint64_t value = word >> shift;
+				if (shift + width > 64){
+					value |= static_cast<uint64_t>(in[byte + 8]) << (64 - shift);
+				}
+				values[j] = value & mask;
+				position += width;
+			}
+
+		}
+
+		return offset;
+
+	}
+
+	SnapshotEncoder::SnapshotEncoder(double mu,const SnapshotSettings & settings){
+		this -> mu = mu;
+		this -> settings = settings;
+	}
+
+	void SnapshotEncoder::encode(const arma::mat & states,double t,std::vector<unsigned char> & bytes){
+
+		unsigned int N = states.n_cols;
+		size_t n = 6 * static_cast<size_t>(N);
+
+		bool keyframe = !this -> has_reference 
+		|| N != this -> states.n_cols 
+		|| (this -> settings.keyframe_interval > 0 && this -> count % this -> settings.keyframe_interval == 0);
+		SnapshotPrediction prediction = keyframe ? INTRA_PREDICTION : this -> settings.prediction;
+
+		std::vector<long long> predicted;
+		const long long * reference = this -> predict(prediction,t,N,predicted);
+
+		long long steps[6];
+		double scales[6];
+		this -> get_scales(steps,scales);
+
+		std::vector<long long> quantized(n);
+		this -> residuals.resize(n);
+		uint64_t * residuals = this -> residuals.data();
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			for (unsigned int k = 0; k < 6; ++k){
+
+				size_t index = k * static_cast<size_t>(N) + i;
+				quantized[index] = SnapshotCodec::quantize(states(k,i),steps[k],scales[k]);
+				long long residual = reference == nullptr ? quantized[index] : quantized[index] - reference[index];
+
+				// Angle residuals are brought back to half a turn
+				if (steps[k] > 0){
+					residual = ((residual % steps[k]) + steps[k]) % steps[k];
+					if (residual > steps[k] / 2){
+						residual -= steps[k];
+					}
+				}
+
+				// Zigzag mapping, so that small negative residuals take few bits
+				residuals[index] = (static_cast<uint64_t>(residual) << 1) ^ static_cast<uint64_t>(residual >> 63);
+
+			}
+		}
+
+		size_t header_offset = bytes.size();
+		bytes.resize(header_offset + sizeof(Header));
+		SnapshotCodec::pack(residuals,n,bytes);
+
+		Header header;
+		header.magic = SnapshotCodec::magic;
+		header.type = this -> settings.type;
+		header.prediction = prediction;
+		header.reserved = 0;
+		header.N = N;
+		header.payload_size = static_cast<uint32_t>(bytes.size() - header_offset - sizeof(Header));
+		header.t = t;
+		header.mu = this -> mu;
+		std::copy(this -> settings.quantum,this -> settings.quantum + 6,header.quantum);
+		std::memcpy(bytes.data() + header_offset,&header,sizeof(Header));
+
+		// The reference of the next snapshot is what the decoder will reconstruct
+		this -> quantized.swap(quantized);
+		this -> states.set_size(6,N);
+		double * reconstructed = this -> states.memptr();
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			for (unsigned int k = 0; k < 6; ++k){
+				reconstructed[6 * static_cast<size_t>(i) + k] = this -> quantized[k * static_cast<size_t>(N) + i] * scales[k];
+			}
+		}
+
+		this -> t = t;
+		this -> has_reference = true;
+		++this -> count;
+
+	}
+
+	SnapshotDecoder::SnapshotDecoder(){
+
+	}
+
+	size_t SnapshotDecoder::decode(const unsigned char * data,size_t size){
+
+		if (size < sizeof(Header)){
+			return 0;
+		}
+
+		Header header;
+		std::memcpy(&header,data,sizeof(Header));
+
+		if (header.magic != SnapshotCodec::magic){
+			std::cout << "SnapshotDecoder::decode: corrupt stream\n";
+			return 0;
+		}
+
+		size_t snapshot_size = sizeof(Header) + header.payload_size;
+		if (size < snapshot_size){
+			return 0;
+		}
+
+		SnapshotPrediction prediction = static_cast<SnapshotPrediction>(header.prediction);
+		unsigned int N = header.N;
+		size_t n = 6 * static_cast<size_t>(N);
+
+		if (prediction != INTRA_PREDICTION && (!this -> has_reference || N != this -> states.n_cols)){
+			return snapshot_size;
+		}
+
+		this -> residuals.resize(n);
+		uint64_t * residuals = this -> residuals.data();
+		if (SnapshotCodec::unpack(data + sizeof(Header),header.payload_size,n,residuals) != header.payload_size){
+			std::cout << "SnapshotDecoder::decode: corrupt stream\n";
+			return 0;
+		}
+
+		this -> settings.type = static_cast<SnapshotType>(header.type);
+		std::copy(header.quantum,header.quantum + 6,this -> settings.quantum);
+		this -> mu = header.mu;
+
+		std::vector<long long> predicted;
+		const long long * reference = this -> predict(prediction,header.t,N,predicted);
+
+		long long steps[6];
+		double scales[6];
+		this -> get_scales(steps,scales);
+
+		// With PREVIOUS_PREDICTION, the reference is updated in place
+		this -> quantized.resize(n);
+		this -> states.set_size(6,N);
+		long long * quantized = this -> quantized.data();
+		double * reconstructed = this -> states.memptr();
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < N; ++i){
+			for (unsigned int k = 0; k < 6; ++k){
+
+				size_t index = k * static_cast<size_t>(N) + i;
+				long long value = static_cast<long long>(residuals[index] >> 1) ^ - static_cast<long long>(residuals[index] & 1);
+				if (reference != nullptr){
+					value += reference[index];
+				}
+
+				if (steps[k] > 0){
+					value = ((value % steps[k]) + steps[k]) % steps[k];
+				}
+
+				quantized[index] = value;
+				reconstructed[6 * static_cast<size_t>(i) + k] = value * scales[k];
+
+			}
+		}
+
+		this -> t = header.t;
+		this -> has_reference = true;
+		++this -> count;
+
+		return snapshot_size;
+
+	}
+
+}
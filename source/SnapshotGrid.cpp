@@ -0,0 +1,398 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/SnapshotGrid.hpp"
+#include <algorithm>
+
+namespace OC{
+
+	static const long long KEY_BITS = 21;
+	static const long long KEY_OFFSET = 1LL << (KEY_BITS - 1);
+	static const long long KEY_MASK = (1LL << KEY_BITS) - 1;
+
+	// Room left for incoming objects in each cell, on top of a quarter of the cell's count
+	static const unsigned int CELL_SLACK = 2;
+
+	SnapshotGrid::SnapshotGrid(const std::vector<KepState> & constellation,double cell_size,double t){
+
+		this -> cell_size = cell_size;
+		this -> orbits.resize(constellation.size());
+		
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < constellation.size(); ++i){
+			this -> orbits[i] = PreparedKepState(constellation[i]);
+		}
+
+		this -> positions = arma::zeros<arma::mat>(3,constellation.size());
+		this -> object_keys.resize(constellation.size());
+		this -> object_cells.resize(constellation.size());
+		this -> object_slots.resize(constellation.size());
+		this -> number_of_rebuilds = 0;
+
+		unsigned int capacity = 16;
+		while (capacity < 2 * constellation.size()){
+			capacity *= 2;
+		}
+		this -> cells.resize(capacity);
+		this -> occupied.resize(capacity);
+
+		this -> propagate_positions(t);
+
+		for (unsigned int i = 0; i < constellation.size(); ++i){
+			this -> object_keys[i] = this -> get_cell_key(this -> positions.colptr(i));
+		}
+		this -> rebuild();
+
+	}
+
+	unsigned int SnapshotGrid::propagate(double t){
+
+		this -> propagate_positions(t);
+
+		// Once a move fails, the remaining keys are only updated for the rebuild
+		unsigned int moved = 0;
+		bool incremental = true;
+		for (unsigned int i = 0; i < this -> orbits.size(); ++i){
+			CellKey key = this -> get_cell_key(this -> positions.colptr(i));
+			if (key != this -> object_keys[i]){
+				this -> object_keys[i] = key;
+				++moved;
+				if (incremental){
+					incremental = this -> move_object(i);
+				}
+			}
+		}
+
+		if (!incremental){
+			this -> rebuild();
+		}
+
+		return moved;
+
+	}
+
+	std::vector<unsigned int> SnapshotGrid::query_radius(const arma::vec::fixed<3> & point,double radius) const{
+
+		std::vector<unsigned int> indices;
+
+		long long ix_min = (long long)(std::floor((point(0) - radius) / this -> cell_size));
+		long long iy_min = (long long)(std::floor((point(1) - radius) / this -> cell_size));
+		long long iz_min = (long long)(std::floor((point(2) - radius) / this -> cell_size));
+		long long ix_max = (long long)(std::floor((point(0) + radius) / this -> cell_size));
+		long long iy_max = (long long)(std::floor((point(1) + radius) / this -> cell_size));
+		long long iz_max = (long long)(std::floor((point(2) + radius) / this -> cell_size));
+
+		double radius_squared = radius * radius;
+
+		for (long long ix = ix_min; ix <= ix_max; ++ix){
+			for (long long iy = iy_min; iy <= iy_max; ++iy){
+				for (long long iz = iz_min; iz <= iz_max; ++iz){
+
+					const Cell * cell = this -> find_cell(SnapshotGrid::pack_key(ix,iy,iz));
+					if (cell == nullptr){
+						continue;
+					}
+
+					const unsigned int * cell_members = this -> members.data() + cell -> offset;
+					for (unsigned int k = 0; k < cell -> count; ++k){
+						const double * pos = this -> positions.colptr(cell_members[k]);
+						double dx = pos[0] - point(0);
+						double dy = pos[1] - point(1);
+						double dz = pos[2] - point(2);
+						if (dx * dx + dy * dy + dz * dz <= radius_squared){
+							indices.push_back(cell_members[k]);
+						}
+					}
+				}
+			}
+		}
+
+		std::sort(indices.begin(),indices.end());
+		return indices;
+
+	}
+
+	std::vector<std::pair<unsigned int,unsigned int> > SnapshotGrid::query_pairs(double distance) const{
+
+		std::vector<std::pair<unsigned int,unsigned int> > pairs;
+
+		long long range = (long long)(std::ceil(distance / this -> cell_size));
+		double distance_squared = distance * distance;
+
+		for (unsigned int c = 0; c < this -> cells.size(); ++c){
+
+			if (!this -> occupied[c]){
+				continue;
+			}
+
+			const Cell & cell = this -> cells[c];
+			const unsigned int * cell_members = this -> members.data() + cell.offset;
+			long long ix,iy,iz;
+			SnapshotGrid::unpack_key(cell.key,ix,iy,iz);
+
+			// Only visit the neighbours that are lexicographically greater or equal, so that each pair of cells is visited once
+			for (long long dx = 0; dx <= range; ++dx){
+				for (long long dy = (dx == 0 ? 0 : - range); dy <= range; ++dy){
+					for (long long dz = (dx == 0 && dy == 0 ? 0 : - range); dz <= range; ++dz){
+
+						const Cell * other_cell = this -> find_cell(SnapshotGrid::pack_key(ix + dx,iy + dy,iz + dz));
+						if (other_cell == nullptr){
+							continue;
+						}
+						bool same_cell = (dx == 0 && dy == 0 && dz == 0);
+						const unsigned int * other_members = this -> members.data() + other_cell -> offset;
+
+						for (unsigned int k = 0; k < cell.count; ++k){
+							unsigned int i = cell_members[k];
+							const double * pos_i = this -> positions.colptr(i);
+
+							for (unsigned int l = (same_cell ? k + 1 : 0); l < other_cell -> count; ++l){
+								unsigned int j = other_members[l];
+								const double * pos_j = this -> positions.colptr(j);
+								double rx = pos_j[0] - pos_i[0];
+								double ry = pos_j[1] - pos_i[1];
+								double rz = pos_j[2] - pos_i[2];
+								if (rx * rx + ry * ry + rz * rz <= distance_squared){
+									pairs.push_back(std::make_pair(std::min(i,j),std::max(i,j)));
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+
+		std::sort(pairs.begin(),pairs.end());
+		return pairs;
+
+	}
+
+	const arma::mat & SnapshotGrid::get_positions() const{
+		return this -> positions;
+	}
+
+	double SnapshotGrid::get_time() const{
+		return this -> t;
+	}
+
+	double SnapshotGrid::get_cell_size() const{
+		return this -> cell_size;
+	}
+
+	unsigned int SnapshotGrid::get_number_of_objects() const{
+		return this -> orbits.size();
+	}
+
+	unsigned int SnapshotGrid::get_number_of_rebuilds() const{
+		return this -> number_of_rebuilds;
+	}
+
+	void SnapshotGrid::propagate_positions(double t){
+
+		this -> t = t;
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < this -> orbits.size(); ++i){
+			this -> orbits[i].get_position(t,this -> positions.colptr(i));
+		}
+
+	}
+
+	SnapshotGrid::CellKey SnapshotGrid::get_cell_key(const double * pos) const{
+		return SnapshotGrid::pack_key((long long)(std::floor(pos[0] / this -> cell_size)),
+			(long long)(std::floor(pos[1] / this -> cell_size)),
+			(long long)(std::floor(pos[2] / this -> cell_size)));
+	}
+
+	SnapshotGrid::CellKey SnapshotGrid::pack_key(long long ix,long long iy,long long iz){
+		return (((ix + KEY_OFFSET) & KEY_MASK) << (2 * KEY_BITS)) 
+		| (((iy + KEY_OFFSET) & KEY_MASK) << KEY_BITS) 
+		| ((iz + KEY_OFFSET) & KEY_MASK);
+	}
+
+	void SnapshotGrid::unpack_key(CellKey key,long long & ix,long long & iy,long long & iz){
+		ix = ((key >> (2 * KEY_BITS)) & KEY_MASK) - KEY_OFFSET;
+		iy = ((key >> KEY_BITS) & KEY_MASK) - KEY_OFFSET;
+		iz = (key & KEY_MASK) - KEY_OFFSET;
+	}
+
+	static unsigned long long hash_key(long long key){
+		unsigned long long h = (unsigned long long)(key);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		return h;
+	}
+
+	const SnapshotGrid::Cell * SnapshotGrid::find_cell(CellKey key) const{
+
+		unsigned long long mask = this -> cells.size() - 1;
+		for (unsigned long long slot = hash_key(key) & mask; this -> occupied[slot]; slot = (slot + 1) & mask){
+			if (this -> cells[slot].key == key){
+				return &this -> cells[slot];
+			}
+		}
+		return nullptr;
+
+	}
+
+	unsigned int SnapshotGrid::find_or_insert_cell(CellKey key){
+
+		unsigned long long mask = this -> cells.size() - 1;
+		unsigned long long slot = hash_key(key) & mask;
+		for ( ; this -> occupied[slot]; slot = (slot + 1) & mask){
+			if (this -> cells[slot].key == key){
+				return slot;
+			}
+		}
+
+		this -> occupied[slot] = true;
+		this -> cells[slot].key = key;
+		this -> cells[slot].count = 0;
+		return slot;
+
+	}
+
+	void SnapshotGrid::remove_cell(unsigned int slot){
+
+		// Backward shift deletion: the following cells of the probe sequence are moved up 
+		// unless that would place them before their home slot
+		unsigned long long mask = this -> cells.size() - 1;
+		unsigned long long hole = slot;
+		this -> occupied[hole] = false;
+
+		for (unsigned long long next = (hole + 1) & mask; this -> occupied[next]; next = (next + 1) & mask){
+
+			unsigned long long home = hash_key(this -> cells[next].key) & mask;
+			if (((next - home) & mask) < ((next - hole) & mask)){
+				continue;
+			}
+
+			this -> cells[hole] = this -> cells[next];
+			this -> occupied[hole] = true;
+			this -> occupied[next] = false;
+
+			const Cell & cell = this -> cells[hole];
+			for (unsigned int k = 0; k < cell.count; ++k){
+				this -> object_cells[this -> members[cell.offset + k]] = hole;
+			}
+
+			hole = next;
+
+		}
+
+	}
+
+	bool SnapshotGrid::move_object(unsigned int i){
+
+		// The destination cell must have room for i, otherwise the bins are left to a rebuild
+		const Cell * destination = this -> find_cell(this -> object_keys[i]);
+		bool new_cell = (destination == nullptr);
+		Cell & source = this -> cells[this -> object_cells[i]];
+
+		if (new_cell){
+			if (this -> free_ranges.empty() && source.count > 1 
+				&& this -> members_end + 2 * CELL_SLACK > this -> members.size()){
+				return false;
+			}
+		}
+		else if (destination -> count == destination -> capacity){
+			return false;
+		}
+
+		// Swap-remove from the previous cell, which is deleted once empty
+		unsigned int last = this -> members[source.offset + source.count - 1];
+		this -> members[this -> object_slots[i]] = last;
+		this -> object_slots[last] = this -> object_slots[i];
+		--source.count;
+
+		if (source.count == 0){
+			this -> free_ranges.push_back(std::make_pair(source.offset,source.capacity));
+			this -> remove_cell(this -> object_cells[i]);
+		}
+
+		// Append to the new one. Its slot is looked up again since the deletion may have shifted it
+		unsigned int c = this -> find_or_insert_cell(this -> object_keys[i]);
+		Cell & cell = this -> cells[c];
+
+		if (new_cell){
+			if (this -> free_ranges.empty()){
+				cell.offset = this -> members_end;
+				cell.capacity = 2 * CELL_SLACK;
+				this -> members_end += 2 * CELL_SLACK;
+			}
+			else{
+				cell.offset = this -> free_ranges.back().first;
+				cell.capacity = this -> free_ranges.back().second;
+				this -> free_ranges.pop_back();
+			}
+		}
+
+		this -> object_slots[i] = cell.offset + cell.count;
+		this -> members[cell.offset + cell.count] = i;
+		++cell.count;
+		this -> object_cells[i] = c;
+
+		return true;
+
+	}
+
+	void SnapshotGrid::rebuild(){
+
+		std::fill(this -> occupied.begin(),this -> occupied.end(),false);
+		this -> free_ranges.clear();
+
+		// Counting pass
+		for (unsigned int i = 0; i < this -> orbits.size(); ++i){
+			unsigned int c = this -> find_or_insert_cell(this -> object_keys[i]);
+			this -> object_cells[i] = c;
+			++this -> cells[c].count;
+		}
+
+		// Exclusive prefix sum of the capacities, each cell getting some slack for the incremental moves
+		unsigned int offset = 0;
+		for (unsigned int c = 0; c < this -> cells.size(); ++c){
+			if (this -> occupied[c]){
+				this -> cells[c].offset = offset;
+				this -> cells[c].capacity = this -> cells[c].count + this -> cells[c].count / 4 + CELL_SLACK;
+				offset += this -> cells[c].capacity;
+				this -> cells[c].count = 0;
+			}
+		}
+
+		// Room for the cells created by the incremental moves
+		this -> members_end = offset;
+		this -> members.resize(offset + this -> orbits.size() / 2 + 2 * CELL_SLACK);
+
+		// Scatter pass. Members of a cell end up in increasing index order
+		for (unsigned int i = 0; i < this -> orbits.size(); ++i){
+			Cell & cell = this -> cells[this -> object_cells[i]];
+			this -> object_slots[i] = cell.offset + cell.count;
+			this -> members[cell.offset + cell.count] = i;
+			++cell.count;
+		}
+
+		++this -> number_of_rebuilds;
+
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/SolverPolicy.hpp"
+
+namespace OC{
+
+	SolverPolicy SolverPolicy::fast_policy(){
+
+		SolverPolicy policy;
+		policy.tolerance = 1e-8;
+		policy.step_tolerance = 1e-8;
+		policy.zero_tolerance = 1e-10;
+		policy.max_iterations = 50;
+		policy.max_step = 1;
+		policy.failure_mode = IGNORE_FAILURE;
+		return policy;
+
+	}
+
+	SolverPolicy SolverPolicy::default_policy(){
+
+		SolverPolicy policy;
+		policy.tolerance = 1e-13;
+		policy.step_tolerance = 1e-12;
+		policy.zero_tolerance = 1e-10;
+		policy.max_iterations = 1000;
+		policy.max_step = 0.1;
+		policy.failure_mode = WARN_ON_FAILURE;
+		return policy;
+
+	}
+
+	SolverPolicy SolverPolicy::precise_policy(){
+
+		SolverPolicy policy;
+		policy.tolerance = 1e-16;
+		policy.step_tolerance = 1e-14;
+		policy.zero_tolerance = 0;
+		policy.max_iterations = 1000;
+		policy.max_step = 0.1;
+		policy.failure_mode = WARN_ON_FAILURE;
+		return policy;
+
+	}
+
+}
@@ -111,26 +111,48 @@ namespace OC{
 
 
 	double State::f_from_M(const double & M,const double & e){
+		return State::f_from_M(M,e,SolverPolicy::default_policy());
+	}
+
+	double State::f_from_M(const double & M,const double & e,const SolverPolicy & policy){
 		if (e < 1){
-			return State::f_from_ecc(State::ecc_from_M(M,e),e);
+			return State::f_from_ecc(State::ecc_from_M(M,e,policy),e);
 		}
 		else{
-			return State::f_from_H(State::H_from_M(M,e),e) ;
+			return State::f_from_H(State::H_from_M(M,e,policy),e) ;
 		}
 	}
 
 	double State::ecc_from_M(const double & M,const double & e,const bool & pedantic){
 
-		double ecc = M;
+		return State::ecc_from_M_warm_start(M,e,M,SolverPolicy::default_policy(),pedantic);
+
+	}
+
+	double State::ecc_from_M(const double & M,const double & e,const SolverPolicy & policy,const bool & pedantic){
+
+		return State::ecc_from_M_warm_start(M,e,M,policy,pedantic);
+
+	}
+
+	double State::ecc_from_M_warm_start(const double & M,const double & e,const double & ecc_0,const bool & pedantic){
+
+		return State::ecc_from_M_warm_start(M,e,ecc_0,SolverPolicy::default_policy(),pedantic);
+
+	}
+
+	double State::ecc_from_M_warm_start(const double & M,const double & e,const double & ecc_0,const SolverPolicy & policy,const bool & pedantic){
+
+		double ecc = ecc_0;
 
 		if (pedantic){
 			std::cout << "Initial guess: " << ecc << " from M : " << M <<  " , e: " << e << std::endl;
 
 		}
 
-		for (unsigned int i = 0; i < 1000; ++i){
+		for (unsigned int i = 0; i < policy.max_iterations; ++i){
 
-			double max_decc = 0.1;
+			double max_decc = policy.max_step;
 
 			double decc = (State::M_from_ecc(ecc,e) - M)/(1 - e * std::cos(ecc));
 			
@@ -151,12 +173,17 @@ namespace OC{
 				std::cout << "decc : " << decc<<  " , ecc : " <<  ecc << " , Residual : " <<  error << std::endl;
 			}
 
-			if (error < 1e-13 || std::abs(decc) < 1e-12 || std::abs(ecc) < 1e-10){
+			if (error < policy.tolerance || std::abs(decc) < policy.step_tolerance || std::abs(ecc) < policy.zero_tolerance){
 				break;
 			}
 
-			if (i == 999){
-				std::cout << "State::ecc_from_M did not converge\n";
+			if (i + 1 == policy.max_iterations){
+				if (policy.failure_mode == WARN_ON_FAILURE){
+					std::cout << "State::ecc_from_M did not converge\n";
+				}
+				else if (policy.failure_mode == NAN_ON_FAILURE){
+					return std::nan("");
+				}
 			}
 			
 		}
@@ -168,16 +195,34 @@ namespace OC{
 
 	double State::H_from_M(const  double & M,const  double & e,const bool & pedantic){
 
-		double H = std::atan(M);
+		return State::H_from_M_warm_start(M,e,std::atan(M),SolverPolicy::default_policy(),pedantic);
+
+	}
+
+	double State::H_from_M(const double & M,const double & e,const SolverPolicy & policy,const bool & pedantic){
+
+		return State::H_from_M_warm_start(M,e,std::atan(M),policy,pedantic);
+
+	}
+
+	double State::H_from_M_warm_start(const double & M,const double & e,const double & H_0,const bool & pedantic){
+
+		return State::H_from_M_warm_start(M,e,H_0,SolverPolicy::default_policy(),pedantic);
+
+	}
+
+	double State::H_from_M_warm_start(const double & M,const double & e,const double & H_0,const SolverPolicy & policy,const bool & pedantic){
+
+		double H = H_0;
 		
 		double damp = 1;
 		if (pedantic){
 			std::cout << "Initial guess: " << H << " from M : " << M <<  " , e: " << e << std::endl;
 		}
 
-		for (unsigned int i = 0; i < 1000; ++i){
+		for (unsigned int i = 0; i < policy.max_iterations; ++i){
 
-			double max_dH = 0.1;
+			double max_dH = policy.max_step;
 
 			double dH = (State::M_from_H(H,e) - M)/(e * std::cosh(H) - 1);
 
@@ -200,12 +245,17 @@ namespace OC{
 			}
 
 
-			if (error < 1e-13 || std::abs(dH) < 1e-12){
+			if (error < policy.tolerance || std::abs(dH) < policy.step_tolerance){
 				break;
 			}
 
-			if (i == 999){
-				std::cout << "State::H_from_M did not converge\n";
+			if (i + 1 == policy.max_iterations){
+				if (policy.failure_mode == WARN_ON_FAILURE){
+					std::cout << "State::H_from_M did not converge\n";
+				}
+				else if (policy.failure_mode == NAN_ON_FAILURE){
+					return std::nan("");
+				}
 			}
 
 			
@@ -237,5 +287,47 @@ namespace OC{
 		}
 	}
 
+	double State::stumpff_S(const double & z){
+
+		if (std::abs(z) < 1){
+			double term = 1. / 6;
+			double S = term;
+			for (unsigned int k = 1; k < 9; ++k){
+				term *= - z / ((2 * k + 2) * (2 * k + 3));
+				S += term;
+			}
+			return S;
+		}
+		else if (z > 0){
+			double sqrt_z = std::sqrt(z);
+			return (sqrt_z - std::sin(sqrt_z)) / (z * sqrt_z);
+		}
+		else{
+			double sqrt_z = std::sqrt(- z);
+			return (std::sinh(sqrt_z) - sqrt_z) / (- z * sqrt_z);
+		}
+
+	}
+
+	double State::stumpff_C(const double & z){
+
+		if (std::abs(z) < 1){
+			double term = 1. / 2;
+			double C = term;
+			for (unsigned int k = 1; k < 9; ++k){
+				term *= - z / ((2 * k + 1) * (2 * k + 2));
+				C += term;
+			}
+			return C;
+		}
+		else if (z > 0){
+			return (1 - std::cos(std::sqrt(z))) / z;
+		}
+		else{
+			return (std::cosh(std::sqrt(- z)) - 1) / (- z);
+		}
+
+	}
+
 
 }
@@ -0,0 +1,267 @@
+// MIT License
+
+// Copyright (c) 2018 Benjamin Bercovici
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "OrbitConversions/StateCatalog.hpp"
+#include "OrbitConversions/BatchConversions.hpp"
+#include "OrbitConversions/PreparedKepState.hpp"
+
+namespace OC{
+
+	arma::vec KepStateHandle::get_state() const{
+		arma::vec state(6);
+		for (unsigned int k = 0; k < 6; ++k){
+			state(k) = this -> base[k * this -> stride];
+		}
+		return state;
+	}
+
+	CartState KepStateHandle::convert_to_cart(double delta_T) const{
+		return KepState(this -> get_state(),this -> mu).convert_to_cart(delta_T);
+	}
+
+	double CartStateHandle::get_momentum() const{
+		return arma::norm(arma::cross(this -> get_position_vector(),this -> get_velocity_vector()));
+	}
+
+	double CartStateHandle::get_eccentricity() const{
+		return CartState(this -> get_state(),this -> mu).get_eccentricity();
+	}
+
+	arma::vec::fixed<3> CartStateHandle::get_position_vector() const{
+		arma::vec::fixed<3> position;
+		for (unsigned int k = 0; k < 3; ++k){
+			position(k) = this -> get(k);
+		}
+		return position;
+	}
+
+	arma::vec::fixed<3> CartStateHandle::get_velocity_vector() const{
+		arma::vec::fixed<3> velocity;
+		for (unsigned int k = 0; k < 3; ++k){
+			velocity(k) = this -> get(k + 3);
+		}
+		return velocity;
+	}
+
+	arma::vec CartStateHandle::get_state() const{
+		arma::vec state(6);
+		for (unsigned int k = 0; k < 6; ++k){
+			state(k) = this -> get(k);
+		}
+		return state;
+	}
+
+	KepState CartStateHandle::convert_to_kep(double delta_T) const{
+		return CartState(this -> get_state(),this -> mu).convert_to_kep(delta_T);
+	}
+
+	StateCatalog::StateCatalog(unsigned int N,double mu,CatalogLayout layout){
+		this -> mu = mu;
+		this -> allocate(N,layout);
+	}
+
+	StateCatalog::StateCatalog(const double * states,unsigned int N,double mu,CatalogLayout source_layout,CatalogLayout layout){
+		this -> mu = mu;
+		this -> allocate(N,layout);
+		this -> load(states,source_layout);
+	}
+
+	void StateCatalog::allocate(unsigned int N,CatalogLayout layout){
+
+		this -> N = N;
+		this -> layout = layout;
+		this -> object_stride = layout == AOS ? 6 : 1;
+		this -> component_stride = layout == AOS ? 1 : N;
+
+		// Left uninitialized: the catalogs are always filled right after allocation
+		this -> data.reset(new double[6 * static_cast<size_t>(N)]);
+
+	}
+
+	void StateCatalog::load(const double * states,CatalogLayout source_layout){
+
+		long long N = this -> N;
+
+		if (source_layout == this -> layout){
+			#pragma omp parallel for
+			for (long long j = 0; j < 6 * N; ++j){
+				this -> data[j] = states[j];
+			}
+			return;
+		}
+
+		unsigned int source_object_stride = source_layout == AOS ? 6 : 1;
+		unsigned int source_component_stride = source_layout == AOS ? 1 : this -> N;
+
+		#pragma omp parallel for
+		for (long long i = 0; i < N; ++i){
+			for (unsigned int k = 0; k < 6; ++k){
+				this -> set(i,k,states[i * source_object_stride + k * source_component_stride]);
+			}
+		}
+
+	}
+
+	unsigned int StateCatalog::get_size() const{
+		return this -> N;
+	}
+
+	double StateCatalog::get_mu() const{
+		return this -> mu;
+	}
+
+	CatalogLayout StateCatalog::get_layout() const{
+		return this -> layout;
+	}
+
+	unsigned int StateCatalog::get_object_stride() const{
+		return this -> object_stride;
+	}
+
+	unsigned int StateCatalog::get_component_stride() const{
+		return this -> component_stride;
+	}
+
+	double * StateCatalog::get_data(){
+		return this -> data.get();
+	}
+
+	const double * StateCatalog::get_data() const{
+		return this -> data.get();
+	}
+
+	void StateCatalog::get_state(unsigned int i,double * state) const{
+		for (unsigned int k = 0; k < 6; ++k){
+			state[k] = this -> get(i,k);
+		}
+	}
+
+	void StateCatalog::set_state(unsigned int i,const double * state){
+		for (unsigned int k = 0; k < 6; ++k){
+			this -> set(i,k,state[k]);
+		}
+	}
+
+	arma::mat StateCatalog::get_states() const{
+
+		arma::mat states(6,this -> N);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < this -> N; ++i){
+			this -> get_state(i,states.colptr(i));
+		}
+
+		return states;
+
+	}
+
+	void StateCatalog::set_layout(CatalogLayout layout){
+
+		if (layout == this -> layout){
+			return;
+		}
+
+		std::unique_ptr<double[]> old_data(std::move(this -> data));
+		CatalogLayout old_layout = this -> layout;
+
+		this -> allocate(this -> N,layout);
+		this -> load(old_data.get(),old_layout);
+
+	}
+
+	KepCatalog::KepCatalog(unsigned int N,double mu,CatalogLayout layout) : StateCatalog(N,mu,layout){
+
+	}
+
+	KepCatalog::KepCatalog(const arma::mat & states,double mu,CatalogLayout layout) : StateCatalog(states.memptr(),states.n_cols,mu,AOS,layout){
+
+	}
+
+	KepCatalog::KepCatalog(const double * states,unsigned int N,double mu,CatalogLayout source_layout,CatalogLayout layout) : StateCatalog(states,N,mu,source_layout,layout){
+
+	}
+
+	KepCatalog::KepCatalog(const std::vector<KepState> & states,CatalogLayout layout) : StateCatalog(states.size(),states.empty() ? 1 : states.front().get_mu(),layout){
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < states.size(); ++i){
+			this -> set_state(i,states[i].get_state().memptr());
+		}
+
+	}
+
+	CartCatalog KepCatalog::convert_to_cart(double delta_T) const{
+
+		CartCatalog cart_catalog(this -> N,this -> mu,this -> layout);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < this -> N; ++i){
+			double kep[6];
+			double cart[6];
+			this -> get_state(i,kep);
+			PreparedKepState(kep,this -> mu).get_position_velocity(delta_T,cart,cart + 3);
+			cart_catalog.set_state(i,cart);
+		}
+
+		return cart_catalog;
+
+	}
+
+	CartCatalog::CartCatalog(unsigned int N,double mu,CatalogLayout layout) : StateCatalog(N,mu,layout){
+
+	}
+
+	CartCatalog::CartCatalog(const arma::mat & states,double mu,CatalogLayout layout) : StateCatalog(states.memptr(),states.n_cols,mu,AOS,layout){
+
+	}
+
+	CartCatalog::CartCatalog(const double * states,unsigned int N,double mu,CatalogLayout source_layout,CatalogLayout layout) : StateCatalog(states,N,mu,source_layout,layout){
+
+	}
+
+	CartCatalog::CartCatalog(const std::vector<CartState> & states,CatalogLayout layout) : StateCatalog(states.size(),states.empty() ? 1 : states.front().get_mu(),layout){
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < states.size(); ++i){
+			this -> set_state(i,states[i].get_state().memptr());
+		}
+
+	}
+
+	KepCatalog CartCatalog::convert_to_kep(double delta_T) const{
+
+		KepCatalog kep_catalog(this -> N,this -> mu,this -> layout);
+
+		#pragma omp parallel for
+		for (unsigned int i = 0; i < this -> N; ++i){
+			double cart[6];
+			double kep[6];
+			this -> get_state(i,cart);
+			BatchConversions::cart_to_kep_kernel(cart,this -> mu,delta_T,kep);
+			kep_catalog.set_state(i,kep);
+		}
+
+		return kep_catalog;
+
+	}
+
+}